@@ -0,0 +1,73 @@
+/*
+ * Heap allocation tracker. Only built with -D ALLOC_ENABLED=1, which also
+ * needs the linker to wrap malloc, calloc and realloc (see the env
+ * d1_mini_lite_alloc in platformio.ini) so every allocation from our code and
+ * the Arduino core (String!) is counted. ALLOC_SCOPE("name") at the top of a
+ * block attributes the allocations until the block is left to that name;
+ * ALLOC_EXEMPT("name") does the same for code that is allowed to allocate,
+ * such as the fetches with their TLS buffers. Alloc_Loop at the end of loop()
+ * keeps the allocations per iteration, Alloc_Report writes them all to the
+ * log together with the heap stats of umm_malloc.
+ *
+ * Once Alloc_Steady has been called every allocation outside an exempt scope
+ * is a failure; it is logged, and with -D ALLOC_STRICT=1 the device stops so
+ * a test run cannot miss it. The native_alloc env wraps malloc on the host as
+ * well, with operator new of lib/Native/New.cpp going through it, and
+ * test/test_alloc runs every screen and fetch in the steady state.
+ */
+#ifndef ALLOC_H
+#define ALLOC_H
+
+#include <Arduino.h>
+
+#ifndef ALLOC_ENABLED
+#define ALLOC_ENABLED              0
+#endif
+
+#ifndef ALLOC_STRICT
+#define ALLOC_STRICT               0     // Stop at the first allocation in the steady state
+#endif
+
+#define ALLOC_REPORT_SEC           60    // Interval time (sec) between two reports
+#define ALLOC_SETTLE_SEC           120   // From the start until the steady state; every screen has been shown
+
+#if ALLOC_ENABLED
+
+struct Alloc_Site {
+  const char *name;
+  Alloc_Site *next;                      // Sites seen so far, linked on their first allocation
+  bool        exempt;                    // May allocate in the steady state
+  uint32_t    count;
+  uint32_t    bytes;
+  uint32_t    steady;                    // Allocations in the steady state
+};
+
+class Alloc_Scope {
+  public:
+    Alloc_Scope(Alloc_Site &site);
+    ~Alloc_Scope();
+  private:
+    Alloc_Site *outer;
+};
+
+void     Alloc_Loop();
+void     Alloc_Steady();
+void     Alloc_Report();
+uint32_t Alloc_Failures();               // Allocations in the steady state outside an exempt scope
+uint32_t Alloc_Bytes();                  // Allocated since the start, freed or not
+
+#define ALLOC_SCOPE(name)          static Alloc_Site _alloc_site = { name, NULL, false, 0, 0, 0 }; \
+                                   Alloc_Scope _alloc_scope(_alloc_site)
+#define ALLOC_EXEMPT(name)         static Alloc_Site _alloc_site = { name, NULL, true, 0, 0, 0 }; \
+                                   Alloc_Scope _alloc_scope(_alloc_site)
+
+#else
+
+#define ALLOC_SCOPE(name)          do {} while (0)
+#define ALLOC_EXEMPT(name)         do {} while (0)
+
+inline void Alloc_Loop() {}
+
+#endif
+
+#endif
@@ -0,0 +1,45 @@
+/*
+ * Benchmarks of the drawing, run at the start when built with
+ * -D BENCH_ENABLED=1. Bench_Run times the Waveshare drawing primitives
+ * (GUI_Paint.cpp, LCD_Driver.cpp) and counts their bus traffic with
+ * LCDStats.h. Bench_Screen times the TFT_eSPI calls the firmware makes, the
+ * cases are in main.cpp; their bytes and calls are the estimate of
+ * ScreenStats.h, with -D SCREEN_STATS_ENABLED=1 only.
+ *
+ * The bytes and commands (calls for the TFT_eSPI cases) are the same on the
+ * device and the host; their baseline is checked in with the cases, and a
+ * case that needs any more of either fails. When a change needs fewer, copy
+ * the new counts from the log into the table. Times differ per device: the
+ * first run is saved as their baseline in LittleFS, later runs fail a case
+ * that needs more than BENCH_TOLERANCE percent time. Remove BENCH_FILE and
+ * BENCH_SCREEN_FILE to take a new one. The native_bench env runs the cases in
+ * test/test_bench, without a time baseline. With -D LCD_TRACE_ENABLED=1 every primitive runs once more with
+ * the bus traced, see LCDTrace.h; with -D LCD_TRACE_FILES=1 as well the
+ * trace of each goes to /trace/<number of the primitive>.bin.
+ */
+#ifndef BENCH_H
+#define BENCH_H
+
+#include <stdint.h>
+
+#ifndef BENCH_ENABLED
+#define BENCH_ENABLED              0
+#endif
+
+#define BENCH_RUNS                 3     // Runs per primitive, the fastest counts
+#define BENCH_TOLERANCE            10    // Percent slower than the baseline we accept
+#define BENCH_CASES_MAX            24
+#define BENCH_FILE                 "/bench.bin"
+#define BENCH_SCREEN_FILE          "/bench_screen.bin"
+
+struct Bench_Case {
+  const char *name;
+  void      (*run)(void);
+  uint32_t    bytes;                     // Baseline, 0 when not known yet
+  uint32_t    commands;
+};
+
+int Bench_Run();                                             // Returns the number of primitives that failed
+int Bench_Screen(const Bench_Case *cases, uint8_t count);    // After tft.init, returns the cases that failed
+
+#endif
@@ -0,0 +1,37 @@
+/*
+ * Boot timeline. setup() marks the end of each phase; the time of every mark
+ * goes to RTC memory right away, so it survives a reset, even one halfway
+ * through the start. The last BOOT_HISTORY timelines are kept there. Once
+ * setup() is done and the first screen with data is shown, a table with the
+ * duration of every phase of this start and the ones before is logged.
+ *
+ * RTC memory keeps its contents over a reset but not over a power cycle; after
+ * power on the history starts empty. The native env keeps it in data/.rtc, so
+ * runs of the program follow each other as resets: the first run on a fresh
+ * data/ is a cold start, the next one a warm start from the snapshots and the
+ * WiFi cache the first one saved.
+ */
+#ifndef BOOT_H
+#define BOOT_H
+
+#include <stdint.h>
+
+#define BOOT_HISTORY               4     // Timelines kept, this one included
+#define BOOT_RTC_OFFSET            0     // First 4 byte block of RTC user memory we use
+#define BOOT_MAGIC                 0x524D4254 // "RMBT"
+
+// Phases of setup(), in the order they end
+#define BOOT_SERIAL                0     // Serial port and settle delay
+#define BOOT_TFT                   1     // tft.init
+#define BOOT_SCREEN                2     // Warm start screen or splash
+#define BOOT_WIFI                  3     // Fast connect or WiFiManager, until associated
+#define BOOT_SENSOR                4     // MH-Z19B range
+#define BOOT_SPLASH_WAIT           5     // Time to read the splash, cold start only
+#define BOOT_TASKS                 6     // Scheduler and web server; end of setup()
+#define BOOT_FIRST_FRAME           7     // First screen with data; reported since the start
+#define BOOT_PHASES                8
+
+void Boot_Begin();
+void Boot_Mark(uint8_t phase);
+
+#endif
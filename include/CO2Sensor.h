@@ -0,0 +1,29 @@
+/*
+ * Non blocking reading of the Winsen MH-Z19B CO2 sensor. A read is split in
+ * two phases: CO2_Request sends the 0x86 "read CO2" command and returns at
+ * once, a later CO2_Poll collects and checks the 9 byte reply. In between the
+ * loop is free to do other work while the reply trickles in at 9600 baud.
+ * A request made while the reply to the one before is still on its way
+ * sends nothing; that reply is the answer.
+ * Result codes are the MHZ19_RESULT codes of the MHZ19 library.
+ */
+#ifndef CO2SENSOR_H
+#define CO2SENSOR_H
+
+#include <Arduino.h>
+
+#define CO2_FRAME_LENGTH           9     // Command and reply length
+#define CO2_CMD_READ               0x86  // Read CO2 concentration
+#define CO2_RESPONSE_TIMEOUT       500   // (ms) before we give up on a reply
+
+// Extra result codes next to MHZ19_RESULT
+#define CO2_IDLE                   -1    // No request outstanding
+#define CO2_PENDING                -2    // Waiting for (the rest of) the reply
+
+void CO2_Begin(Stream *port);
+void CO2_Request();
+int  CO2_Poll();
+int  CO2_Value();                        // ppm of the last good reply
+int  CO2_Temperature();                  // Degrees Celsius of the last good reply
+
+#endif
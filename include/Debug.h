@@ -0,0 +1,26 @@
+/*****************************************************************************
+* | File        :   Debug.h
+* | Author      :   Waveshare team
+* | Function    :   debug with printf
+* | Info        :
+*   Image scanning
+*      Please use progressive scanning to generate images or fonts
+*----------------
+* | This version:   V1.0
+* | Date        :   2018-01-11
+* | Info        :   Off by default, the firmware logs with Log.h
+*
+******************************************************************************/
+#ifndef __DEBUG_H
+#define __DEBUG_H
+
+#include <stdio.h>
+
+#define DEV_DEBUG 0
+#if DEV_DEBUG
+  #define Debug(__info,...) printf("Debug : " __info,##__VA_ARGS__)
+#else
+  #define Debug(__info,...)
+#endif
+
+#endif
@@ -0,0 +1,44 @@
+/*
+ * Timing of the https fetches. Every fetch gets a record with the time spent
+ * in each phase, the body bytes, connect retries and the HTTP status. The
+ * last FETCH_RECORDS records are kept in a ring, and every record is written
+ * to the log when the fetch ends.
+ *
+ * BearSSL does the TCP connect and the TLS handshake in one call, so those are
+ * one phase. On the first fetch from a host it also holds the MFLN probe.
+ */
+#ifndef FETCH_H
+#define FETCH_H
+
+#include <stdint.h>
+
+#define FETCH_RECORDS              8     // Recent fetches kept
+
+// Phases, in the order they happen
+#define FETCH_DNS                  0     // Resolving the host name
+#define FETCH_CONNECT              1     // TCP connect and TLS handshake, with retries
+#define FETCH_TTFB                 2     // Request sent until the first byte of the response
+#define FETCH_BODY                 3     // Headers and body
+#define FETCH_PHASES               4
+
+struct Fetch_Record {
+  const char    *host;                   // NULL while the record is unused
+  unsigned long  start;                  // millis() when the fetch started
+  unsigned long  total;                  // ms
+  unsigned long  phase[FETCH_PHASES];    // ms per phase
+  unsigned long  bytes;                  // Body bytes as received
+  int16_t        status;                 // HTTP status, 0 if there was no response
+  uint8_t        phases;                 // Phases completed
+  uint8_t        retries;                // Connect attempts that failed
+  bool           ok;                     // New data, or not modified
+};
+
+void Fetch_Start(const char *host);
+void Fetch_Phase(uint8_t phase);
+void Fetch_Retries(uint8_t retries);
+void Fetch_End(int status, unsigned long bytes, bool ok);
+const Fetch_Record *Fetch_Get(uint8_t age); // 0 is the newest, NULL if there is none
+const Fetch_Record *Fetch_Last(const char *host);
+const char *Fetch_Phase_Name(uint8_t phase);
+
+#endif
@@ -0,0 +1,47 @@
+/*
+ * Golden image checks of the screens, run at the start when built with
+ * -D GOLDEN_ENABLED=1. Every case draws a screen with fixed data; the hash of
+ * its drawing calls (see ScreenStats.h) is compared with the one checked in
+ * with the case in main.cpp. A case with another hash, or without one, fails
+ * and logs the hash it got. Each case stays on the screen for GOLDEN_SHOW_MS,
+ * to compare by eye with the photos of the screens.
+ *
+ * The hash covers the calls, not the pixels read back from the panel: a
+ * change that draws the same in another way fails as well. Check the screens
+ * by eye and copy the new hashes from the log into the table. On the device
+ * this is a smoke check only.
+ *
+ * The native env checks the pixels instead: test/test_golden draws every
+ * case on the emulated panel and compares it with the PPM image of the case
+ * checked in next to the test, within a tolerance. See test/test_golden and
+ * the native_golden env.
+ */
+#ifndef GOLDEN_H
+#define GOLDEN_H
+
+#include <stdint.h>
+#include "ScreenStats.h"
+
+#ifndef GOLDEN_ENABLED
+#define GOLDEN_ENABLED             0
+#endif
+
+#if GOLDEN_ENABLED && !SCREEN_STATS_ENABLED
+#error "GOLDEN_ENABLED needs SCREEN_STATS_ENABLED for the hash of the drawing calls"
+#endif
+
+#define GOLDEN_SHOW_MS             1500  // Time each case stays on the screen
+
+struct Golden_Case {
+  const char *name;
+  void      (*draw)(int arg);
+  int         arg;
+  uint32_t    hash;                      // Expected hash of the drawing calls, 0 when not known yet
+};
+
+extern const Golden_Case golden_cases[]; // In main.cpp, with the screens they draw
+extern const uint8_t     golden_case_count;
+
+int Golden_Run(const Golden_Case *cases, uint8_t count); // Returns the number of cases that failed
+
+#endif
@@ -0,0 +1,44 @@
+/* *****************************************************************************
+
+   Copyright (C) 2022 P.A.G.M. Zengers
+
+   Streaming gzip (RFC 1952) / deflate (RFC 1951) decompressor. Input is pulled
+   byte by byte, output is pushed byte by byte, so the uncompressed data never
+   has to be in memory as a whole. Only the sliding window is allocated.
+
+   This program is free software: you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation, either version 3 of the License, or
+   (at your option) any later version.
+
+ * ****************************************************************************/
+
+#ifndef INFLATE_H
+#define INFLATE_H
+
+#include <stdint.h>
+
+// Deflate allows back references up to 32k. A smaller window_size only works
+// when the stream does not reach back further; a reference beyond the window
+// is reported as INFLATE_ERR_WINDOW. With the full window that cannot happen.
+// The full window does not fit next to TLS on a D1 mini lite, the small one
+// does; a caller that gets INFLATE_ERR_WINDOW with it asks for plain data
+#define INFLATE_WINDOW_SIZE        32768 // Must be a power of two
+#define INFLATE_SMALL_WINDOW       8192
+
+// Result codes
+#define INFLATE_OK                 0
+#define INFLATE_ERR_HEADER         -1    // Not a gzip stream we understand
+#define INFLATE_ERR_DATA           -2    // Invalid deflate data
+#define INFLATE_ERR_INPUT          -3    // Input ended before the stream did
+#define INFLATE_ERR_WINDOW         -4    // Back reference beyond our window
+#define INFLATE_ERR_MEMORY         -5    // Could not allocate the window
+#define INFLATE_ERR_CRC            -6    // Trailer CRC or size mismatch
+
+typedef int  (*Inflate_ReadFn)(void);    // Next input byte, or -1 at the end
+typedef void (*Inflate_WriteFn)(char c); // Receives every decompressed byte
+
+int Gzip_Inflate(Inflate_ReadFn read_byte, Inflate_WriteFn write_byte,
+                 uint32_t window_size = INFLATE_WINDOW_SIZE);
+
+#endif
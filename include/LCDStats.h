@@ -0,0 +1,21 @@
+/*
+ * Counters of what the Waveshare driver (LCD_Driver.cpp) sends to the display:
+ * bytes over SPI, commands and address windows. Reset them, draw, and read
+ * them back to see what a drawing call costs on the bus.
+ */
+#ifndef LCDSTATS_H
+#define LCDSTATS_H
+
+#include <stdint.h>
+
+struct LCD_Stats {
+  uint32_t bytes;                        // Commands and data
+  uint32_t commands;
+  uint32_t windows;                      // LCD_SetCursor calls
+};
+
+extern LCD_Stats lcd_stats;
+
+void LCD_Stats_Reset();
+
+#endif
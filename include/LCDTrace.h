@@ -0,0 +1,67 @@
+/*
+ * Trace of what the Waveshare driver (LCD_Driver.cpp) sends to the display.
+ * When built with -D LCD_TRACE_ENABLED=1 every command, data byte and data
+ * word is decoded as it is written, as long as the trace is started. Nothing
+ * is dropped: Paint_Clear alone writes 57600 words.
+ *
+ * LCD_Trace_Report logs where bus time is lost: address windows set to what
+ * they already were, windows of a single pixel, pixels equal to the one
+ * before (a fill could have done those) and gaps in which the bus was idle.
+ * It also logs the commands sent, with how often and the data bytes after
+ * them, most bytes first.
+ *
+ * With a path LCD_Trace_Start also writes every entry with its time (CPU
+ * cycles) to that file in LittleFS, LCD_TRACE_ENTRIES at a time; the time of
+ * the writes is left out of the trace. tools/lcd_trace.py decodes the file.
+ * A trace of Paint_Clear is 460 KB, more than the flash of the device holds;
+ * the files are for the native env, where LittleFS is a directory of the
+ * host (see the native_trace env).
+ */
+#ifndef LCDTRACE_H
+#define LCDTRACE_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+#ifndef LCD_TRACE_ENABLED
+#define LCD_TRACE_ENABLED          0
+#endif
+
+#ifndef LCD_TRACE_FILES
+#define LCD_TRACE_FILES            0     // Bench writes a file per primitive to LCD_TRACE_DIR
+#endif
+
+#define LCD_TRACE_ENTRIES          512   // Written to the file at a time, 8 bytes each
+#define LCD_TRACE_OPCODES          24    // Different commands counted
+#define LCD_TRACE_GAP_US           20    // Longer without a write is an idle gap
+#define LCD_TRACE_DIR              "/trace"
+
+#define LCD_TRACE_COMMAND          0     // Kinds of entries
+#define LCD_TRACE_BYTE             1
+#define LCD_TRACE_WORD             2
+
+#if LCD_TRACE_ENABLED
+
+struct LCD_Trace_Entry {                 // As in the file, little endian
+  uint32_t cycles;                       // ESP.getCycleCount, without the time spent writing the file
+  uint16_t value;
+  uint8_t  kind;
+  uint8_t  unused;
+};
+
+extern bool lcd_trace_on;
+
+void LCD_Trace_Add(uint8_t kind, uint16_t value);
+void LCD_Trace_Start(const char *path = NULL); // Clear the counts and start tracing, to path as well
+void LCD_Trace_Stop();
+void LCD_Trace_Report(const char *name);
+
+#define LCD_TRACE(kind, value)     do { if (lcd_trace_on) LCD_Trace_Add(kind, value); } while (0)
+
+#else
+
+#define LCD_TRACE(kind, value)     do {} while (0)
+
+#endif
+
+#endif
@@ -0,0 +1,66 @@
+/*
+ * Logging to the serial port without ever blocking the caller. A log call only
+ * stores the level, the format string (in flash) and up to LOG_ARGS integer or
+ * pointer arguments in a ring buffer; formatting and sending happens later in
+ * Log_Drain, which only hands the UART as much as fits in its transmit FIFO.
+ * When the ring is full messages are counted as dropped instead of waiting.
+ *
+ * Because formatting is deferred, %s arguments must stay valid until the
+ * message is sent (flash strings, globals), and floats are not supported.
+ * Messages below LOG_LEVEL are removed at compile time.
+ */
+#ifndef LOG_H
+#define LOG_H
+
+#include <Arduino.h>
+
+#define LOG_LEVEL_NONE             0
+#define LOG_LEVEL_ERROR            1
+#define LOG_LEVEL_WARN             2
+#define LOG_LEVEL_INFO             3
+#define LOG_LEVEL_DEBUG            4
+
+#ifndef LOG_LEVEL
+#define LOG_LEVEL                  LOG_LEVEL_INFO
+#endif
+
+#define LOG_ENTRIES                32    // Messages waiting to be sent
+#define LOG_ARGS                   6     // Max arguments per message
+#define LOG_LINE_LENGTH            128   // Max length of one formatted line
+
+void Log_Push(uint8_t level, const char *format, const uintptr_t *args, uint8_t count);
+void Log_Drain();
+void Log_Flush();
+unsigned long Log_Dropped();
+
+template<typename... Args>
+inline void Log_Write(uint8_t level, const char *format, Args... args) {
+  const uintptr_t values[] = { 0, (uintptr_t)args... };
+  Log_Push(level, format, values + 1, sizeof...(args));
+}
+
+#if LOG_LEVEL >= LOG_LEVEL_ERROR
+#define LOG_ERROR(format, ...)     Log_Write(LOG_LEVEL_ERROR, PSTR(format), ##__VA_ARGS__)
+#else
+#define LOG_ERROR(format, ...)     do {} while (0)
+#endif
+
+#if LOG_LEVEL >= LOG_LEVEL_WARN
+#define LOG_WARN(format, ...)      Log_Write(LOG_LEVEL_WARN, PSTR(format), ##__VA_ARGS__)
+#else
+#define LOG_WARN(format, ...)      do {} while (0)
+#endif
+
+#if LOG_LEVEL >= LOG_LEVEL_INFO
+#define LOG_INFO(format, ...)      Log_Write(LOG_LEVEL_INFO, PSTR(format), ##__VA_ARGS__)
+#else
+#define LOG_INFO(format, ...)      do {} while (0)
+#endif
+
+#if LOG_LEVEL >= LOG_LEVEL_DEBUG
+#define LOG_DEBUG(format, ...)     Log_Write(LOG_LEVEL_DEBUG, PSTR(format), ##__VA_ARGS__)
+#else
+#define LOG_DEBUG(format, ...)     do {} while (0)
+#endif
+
+#endif
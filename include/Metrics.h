@@ -0,0 +1,29 @@
+/*
+ * Prometheus text format (version 0.0.4) over ESP8266WebServer. Lines are
+ * formatted into one fixed buffer that is sent as an HTTP chunk whenever it
+ * fills up, so a scrape never builds the whole page in a String. Call
+ * Metrics_Start, then Metrics_Header once per metric followed by its values,
+ * and end with Metrics_End. Metrics_Line writes any other text the same way,
+ * with another content type when given to Metrics_Start.
+ */
+#ifndef METRICS_H
+#define METRICS_H
+
+#include <Arduino.h>
+#include <ESP8266WebServer.h>
+
+#define METRICS_PORT               80
+#define METRICS_CHUNK_SIZE         512   // Bytes sent per chunk, a line is at most one less
+
+#define METRIC_GAUGE               "gauge"
+#define METRIC_COUNTER             "counter"
+
+void Metrics_Start(ESP8266WebServer &server, const char *type = "text/plain; version=0.0.4");
+void Metrics_Header(const char *name, const char *type, const char *help);
+void Metrics_Value(const char *name, const char *labels, long value);
+void Metrics_Unsigned(const char *name, const char *labels, unsigned long value);
+void Metrics_Micros(const char *name, const char *labels, uint64_t us); // Written as seconds
+void Metrics_Line(const char *format, ...);
+void Metrics_End();
+
+#endif
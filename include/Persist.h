@@ -0,0 +1,18 @@
+/*
+ * Keeps small blocks of data in LittleFS so they survive a power cycle. Each
+ * file has a header with a magic number, the size and a checksum; a file that
+ * does not match (other firmware, half written) is not loaded. A block is
+ * written to a temporary file first and then renamed over the old one.
+ */
+#ifndef PERSIST_H
+#define PERSIST_H
+
+#include <stdint.h>
+
+#define PERSIST_MAGIC              0x524D5331 // "RMS1"
+
+bool Persist_Begin();
+bool Persist_Save(const char *path, const void *data, uint16_t size);
+bool Persist_Load(const char *path, void *data, uint16_t size);
+
+#endif
@@ -0,0 +1,61 @@
+/*
+ * Scoped profiling timers. PROFILE("name") at the top of a block measures the
+ * CPU cycles (ESP.getCycleCount) until the block is left, also through an
+ * early return. Every site has its own static record with the call count,
+ * min, max, total and a histogram with one bucket per power of two cycles, so
+ * nothing is allocated. Profile_Report writes them all to the log.
+ *
+ * Only built with -D PROFILE_ENABLED=1, otherwise PROFILE() is nothing at all.
+ * The cycle counter wraps after 53 s at 80 MHz, longer blocks are not timed
+ * correctly.
+ */
+#ifndef PROFILE_H
+#define PROFILE_H
+
+#include <Arduino.h>
+
+#ifndef PROFILE_ENABLED
+#define PROFILE_ENABLED            0
+#endif
+
+#define PROFILE_BUCKETS            32    // Bucket i counts calls of 2^i up to 2^(i+1) cycles
+#define PROFILE_REPORT_SEC         60    // Interval time (sec) between two reports
+
+#if PROFILE_ENABLED
+
+struct Profile_Site {
+  const char   *name;
+  Profile_Site *next;                    // Sites seen so far, linked on their first call
+  uint32_t      count;
+  uint32_t      min;                     // Cycles
+  uint32_t      max;
+  uint64_t      total;
+  uint16_t      histogram[PROFILE_BUCKETS];
+};
+
+void Profile_Add(Profile_Site &site, uint32_t cycles);
+void Profile_Report();
+
+class Profile_Timer {
+  public:
+    explicit Profile_Timer(Profile_Site &site) : site(site), start(ESP.getCycleCount()) {}
+    ~Profile_Timer() { Profile_Add(site, ESP.getCycleCount() - start); }
+  private:
+    Profile_Site &site;
+    uint32_t      start;
+};
+
+#define PROFILE_JOIN2(a, b)        a##b
+#define PROFILE_JOIN(a, b)         PROFILE_JOIN2(a, b)
+#define PROFILE(name)                                                      \
+  static Profile_Site PROFILE_JOIN(profile_site_, __LINE__) = { name };    \
+  Profile_Timer PROFILE_JOIN(profile_timer_, __LINE__)(PROFILE_JOIN(profile_site_, __LINE__))
+
+#else
+
+#define PROFILE(name)              do {} while (0)
+inline void Profile_Report() {}
+
+#endif
+
+#endif
@@ -0,0 +1,55 @@
+/*
+ * Rain intensity per Buienradar radar value, in 1/1000 mm/hour.
+ * Buienradar uses a logarithmic scale: mm/hour = 10^((value - 109) / 32)
+ * (example: 77 = 0.1 mm/hour). Generated once, so we need no float math
+ * at runtime. Values are rounded, with a minimum of 1 so that even the lowest
+ * radar values still show as a one pixel bar, like the float version did.
+ */
+#ifndef RAINTABLE_H
+#define RAINTABLE_H
+
+#ifdef ESP8266
+  #include <pgmspace.h>
+#else
+  #include <avr/pgmspace.h>
+#endif
+
+#define RAIN_TABLE_SIZE            256
+#define RAIN_MILLI                 1000  // Table unit is 1/1000 mm/hour
+
+const uint32_t rain_table[RAIN_TABLE_SIZE] PROGMEM={
+          1,         1,         1,         1,         1,         1,         1,         1,   //   0..  7
+          1,         1,         1,         1,         1,         1,         1,         1,   //   8.. 15
+          1,         1,         1,         2,         2,         2,         2,         2,   //  16.. 23
+          2,         2,         3,         3,         3,         3,         3,         4,   //  24.. 31
+          4,         4,         5,         5,         5,         6,         6,         6,   //  32.. 39
+          7,         7,         8,         9,         9,        10,        11,        12,   //  40.. 47
+         12,        13,        14,        15,        17,        18,        19,        21,   //  48.. 55
+         22,        24,        25,        27,        29,        32,        34,        37,   //  56.. 63
+         39,        42,        45,        49,        52,        56,        60,        65,   //  64.. 71
+         70,        75,        81,        87,        93,       100,       107,       115,   //  72.. 79
+        124,       133,       143,       154,       165,       178,       191,       205,   //  80.. 87
+        221,       237,       255,       274,       294,       316,       340,       365,   //  88.. 95
+        392,       422,       453,       487,       523,       562,       604,       649,   //  96..103
+        698,       750,       806,       866,       931,      1000,      1075,      1155,   // 104..111
+       1241,      1334,      1433,      1540,      1655,      1778,      1911,      2054,   // 112..119
+       2207,      2371,      2548,      2738,      2943,      3162,      3398,      3652,   // 120..127
+       3924,      4217,      4532,      4870,      5233,      5623,      6043,      6494,   // 128..135
+       6978,      7499,      8058,      8660,      9306,     10000,     10746,     11548,   // 136..143
+      12409,     13335,     14330,     15399,     16548,     17783,     19110,     20535,   // 144..151
+      22067,     23714,     25483,     27384,     29427,     31623,     33982,     36517,   // 152..159
+      39242,     42170,     45316,     48697,     52330,     56234,     60430,     64938,   // 160..167
+      69783,     74989,     80584,     86596,     93057,    100000,    107461,    115478,   // 168..175
+     124094,    133352,    143301,    153993,    165482,    177828,    191095,    205353,   // 176..183
+     220673,    237137,    254830,    273842,    294273,    316228,    339821,    365174,   // 184..191
+     392419,    421697,    453158,    486968,    523299,    562341,    604296,    649382,   // 192..199
+     697831,    749894,    805842,    865964,    930572,   1000000,   1074608,   1154782,   // 200..207
+    1240938,   1333521,   1433013,   1539927,   1654817,   1778279,   1910953,   2053525,   // 208..215
+    2206734,   2371374,   2548297,   2738420,   2942727,   3162278,   3398208,   3651741,   // 216..223
+    3924190,   4216965,   4531584,   4869675,   5232991,   5623413,   6042964,   6493816,   // 224..231
+    6978306,   7498942,   8058422,   8659643,   9305720,  10000000,  10746078,  11547820,   // 232..239
+   12409378,  13335214,  14330126,  15399265,  16548171,  17782794,  19109530,  20535250,   // 240..247
+   22067341,  23713737,  25482967,  27384196,  29427272,  31622777,  33982083,  36517413,   // 248..255
+};
+
+#endif
@@ -0,0 +1,170 @@
+/*
+ * Record and replay of the HTTPS responses. The fetches talk to an
+ * Https_Client, which is a plain WiFiClientSecure unless built with
+ * -D REPLAY_MODE=REPLAY_RECORD or REPLAY_PLAY; then it is a Replay_Client
+ * with the same methods.
+ *
+ * Recording passes everything on to the server and copies every byte read,
+ * status line and headers included, into LittleFS. Responses with status 200
+ * are kept, the last REPLAY_FILES per host, with the time they were received
+ * and how long the server took. Replaying does not touch the network: connect
+ * opens the next recording of the host, and the bytes come back after
+ * REPLAY_LATENCY_MS at REPLAY_BANDWIDTH bytes per second, so the parser and
+ * screens can be measured on real payloads without network variance.
+ *
+ * A replay can also stand in for a misbehaving server. With REPLAY_CHUNKED
+ * the body is sent with chunked transfer encoding, and every connect may
+ * inject a fault, with the percent chance of its knob: a refused connection
+ * (the retry gets through), a 304 instead of the recording, or a body cut off
+ * halfway as by a connection reset. The faults follow from REPLAY_SEED, so a
+ * run can be repeated.
+ *
+ * MFLN goes as with BearSSL: the probe says REPLAY_MFLN, and a connect with
+ * a receive buffer under REPLAY_FULL_BUFFER asks for it. When the server
+ * does not take it then, by REPLAY_MFLN 0 or the REPLAY_FAULT_MFLN chance
+ * that it dropped MFLN since the probe, the connect fails with
+ * BR_ERR_TOO_LARGE as the last SSL error, as on the device when the
+ * records do not fit. This is a client that makes up the failures, not a
+ * server; the stand-in server of the native env (lib/Native) is the other
+ * way to test against them. After each fetch Replay_Check compares the outcome
+ * with what the fault should lead to and logs the totals.
+ *
+ * data/replay has a recording of each host, made by tools/make_recordings.py;
+ * uploadfs puts them on the device, and the native_replay env plays them on
+ * the host.
+ */
+#ifndef REPLAY_H
+#define REPLAY_H
+
+#include <Arduino.h>
+#include <ESP8266WiFi.h>
+#include <WiFiClientSecure.h>
+#include <LittleFS.h>
+
+#define REPLAY_OFF                 0     // Modes
+#define REPLAY_RECORD              1
+#define REPLAY_PLAY                2
+
+#ifndef REPLAY_MODE
+#define REPLAY_MODE                REPLAY_OFF
+#endif
+
+#define REPLAY_DIR                 "/replay/"
+#define REPLAY_FILES               4     // Recordings kept per host
+#define REPLAY_HOSTS               4     // Hosts we keep track of
+#define REPLAY_MAGIC               0x524D5250 // "RMRP"
+
+#ifndef REPLAY_LATENCY_MS
+#define REPLAY_LATENCY_MS          150   // From the request until the first byte
+#endif
+
+#ifndef REPLAY_BANDWIDTH
+#define REPLAY_BANDWIDTH           20000 // Bytes per second, 0 is as fast as we read
+#endif
+
+#ifndef REPLAY_CHUNKED
+#define REPLAY_CHUNKED             0     // Send the body in chunks of REPLAY_CHUNK_SIZE
+#endif
+#define REPLAY_CHUNK_SIZE          500
+
+#ifndef REPLAY_FAULT_REFUSE                // Percent chance per connect of each fault
+#define REPLAY_FAULT_REFUSE        0
+#endif
+#ifndef REPLAY_FAULT_304
+#define REPLAY_FAULT_304           0
+#endif
+#ifndef REPLAY_FAULT_TRUNCATE
+#define REPLAY_FAULT_TRUNCATE      0
+#endif
+#ifndef REPLAY_FAULT_MFLN
+#define REPLAY_FAULT_MFLN          0
+#endif
+#ifndef REPLAY_SEED
+#define REPLAY_SEED                1
+#endif
+
+#ifndef REPLAY_MFLN
+#define REPLAY_MFLN                1     // The server accepts MFLN when probed
+#endif
+#define REPLAY_FULL_BUFFER         16384 // Receive buffer that takes any TLS record
+#define REPLAY_SSL_TOO_LARGE       6     // BR_ERR_TOO_LARGE, a record did not fit the buffer
+
+#define REPLAY_FAULT_NONE          0     // Faults
+#define REPLAY_FAULT_REFUSED       1
+#define REPLAY_FAULT_NOT_MODIFIED  2
+#define REPLAY_FAULT_TRUNCATED     3
+#define REPLAY_FAULT_MFLN_DROPPED  4
+
+#if REPLAY_MODE != REPLAY_OFF
+
+struct Replay_Header {
+  uint32_t magic;
+  uint32_t size;                         // Bytes of the response that follow
+  uint32_t received;                     // millis() at the end of the response
+  uint32_t ttfb;                         // ms from the request until the first byte
+  uint32_t duration;                     // ms from the request until the last byte
+};
+
+class Replay_Client : public Stream {
+  public:
+    // As WiFiClientSecure
+    void    setInsecure();
+    void    setBufferSizes(int recv, int xmit);
+    bool    probeMaxFragmentLength(const char *host, uint16_t port, uint16_t length);
+    bool    getMFLNStatus();
+    int     getLastSSLError();
+    int     connect(const char *host, uint16_t port);
+    uint8_t connected();
+    void    stop();
+    int     available() override;
+    int     read() override;
+    int     peek() override;
+    size_t  write(uint8_t c) override;
+    size_t  write(const uint8_t *buffer, size_t size) override;
+    using   Print::write;
+
+  private:
+    int     Slot(const char *host);      // Next recording of the host
+    void    Path(char *path, uint8_t slot, bool temporary);
+    void    Queue(const char *format, ...);
+    int     Next();
+
+    WiFiClientSecure client;             // Recording
+    File             file;
+    Replay_Header    header;
+    const char      *host = NULL;
+    uint8_t          slot = 0;
+    uint32_t         requested = 0;      // millis() the request was sent
+    uint32_t         position = 0;       // Bytes of the response read
+    bool             open = false;
+
+    uint32_t         body_start = 0;     // Replaying; bytes of the status line and headers
+    bool             in_body = false;
+    bool             chunking = false;   // We add the chunked encoding
+    bool             done = false;       // All sent
+    uint32_t         end = 0;            // Bytes of the recording we send
+    uint32_t         chunk_left = 0;
+    uint32_t         length_at = 0;      // Where the Content-Length header is
+    uint32_t         length_size = 0;    // and its bytes, left out with our chunks
+    int              rx_buffer = REPLAY_FULL_BUFFER;
+    bool             mfln = false;       // Negotiated on this connection
+    int              ssl_error = 0;
+    uint32_t         sent = 0;           // Bytes sent, headers and chunks included
+    char             pending[64];        // Made up bytes that go first
+    uint8_t          pending_length = 0;
+    uint8_t          pending_next = 0;
+    int              lookahead = -1;     // Byte taken by peek
+    bool             have_lookahead = false;
+};
+
+typedef Replay_Client Https_Client;
+
+void Replay_Check(const char *host, bool ok);
+
+#else
+
+typedef WiFiClientSecure Https_Client;
+
+#endif
+
+#endif
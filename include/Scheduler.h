@@ -0,0 +1,27 @@
+/*
+ * Small cooperative task scheduler. Tasks run from loop() when their deadline
+ * has passed, highest priority (lowest number) first. The scheduler does not
+ * read a clock itself: every call gets the time from the caller, so all
+ * deadlines follow the same clock, virtual or not (see Sim.h). Deadlines are
+ * compared as the signed difference with now, so they keep working when
+ * millis() wraps around after 49.7 days. With only a handful of tasks a plain table
+ * that is scanned on every call is cheaper than a heap or timer wheel.
+ */
+#ifndef SCHEDULER_H
+#define SCHEDULER_H
+
+#include <stdint.h>
+
+#define TASK_MAX                   8     // Tasks that can be scheduled at the same time
+#define TASK_ONCE                  0     // Period of a one shot task
+#define TASK_NONE                  -1    // Returned when no task could be added
+
+typedef void (*Task_Function)(void);
+
+int      Task_Add(Task_Function function, uint32_t delay_ms, uint32_t period_ms, uint8_t priority, uint32_t now);
+void     Task_Remove(int id);
+void     Task_Delay(int id, uint32_t delay_ms, uint32_t now);
+bool     Task_Run(uint32_t now);
+uint32_t Task_Next(uint32_t now);
+
+#endif
@@ -0,0 +1,33 @@
+/*
+ * A screen as seen by the render loop. enter is called when the screen comes
+ * up, update every frame with the ms since the previous frame; it returns true
+ * when the screen needs to be drawn from scratch (e.g. new data). draw is
+ * called every frame, with dirty set when everything must be drawn; otherwise
+ * it only draws what changed.
+ *
+ * The budgets are what a draw may cost; builds with SCREEN_STATS_ENABLED check
+ * every draw against them, see ScreenStats.h, and test/test_budget runs the
+ * screens against them on the host. They are about one and a half times the
+ * cost at the time they were set, so a change that adds half shows up.
+ */
+#ifndef SCREEN_H
+#define SCREEN_H
+
+#include <stdint.h>
+
+#define FRAME_RATE                 10    // Frames per second of the render loop
+#define FRAME_INTERVAL_MS          (1000 / FRAME_RATE)
+#define FRAME_BUDGET_US            20000 // Drawing time per frame we aim for; the rest is for sensor and network
+
+struct Screen {
+  const char *name;
+  void (*enter)(void);
+  bool (*update)(uint32_t dt);
+  void (*draw)(bool dirty);
+  uint32_t budget_full;                  // Estimated SPI bytes of a draw from scratch
+  uint32_t budget_update;                // and of a draw of what changed only
+  uint16_t budget_overdraw;              // Pixels written per unique pixel, in 1/100
+  uint16_t budget_heap;                  // Bytes of heap a draw may take
+};
+
+#endif
@@ -0,0 +1,101 @@
+/*
+ * What drawing a screen costs, measured on the device. When built with
+ * -D SCREEN_STATS_ENABLED=1 the tft object is a TFT_Counted, which counts the
+ * pixels of every drawing call before passing it on to TFT_eSPI, marks them in
+ * a bitmap of the screen to find the unique pixels, and samples the free heap.
+ * TFT_eSPI does not count SPI traffic itself; the bytes are estimated as two
+ * per pixel plus the 11 bytes that set the address window of each call.
+ * Text and lines count the area they cover.
+ *
+ * ScreenStats_Begin and ScreenStats_End go around a draw; End logs the cost
+ * and checks it against the budgets of the screen (see Screen.h). The heap a
+ * draw takes is the dip in free heap at the drawing calls; with
+ * -D ALLOC_ENABLED=1 (see Alloc.h) it is at least the bytes allocated during
+ * the draw. That is the only measure on the host, where the free heap of the
+ * stand-in never changes; test/test_budget runs there with both.
+ *
+ * Every call is also hashed with its position, size and colours (and the
+ * pixels of an image), so two draws with the same hash show the same; see
+ * Golden.h. The bitmap of written pixels takes 7200 bytes of RAM.
+ *
+ * With -D SCREEN_HEATMAP_ENABLED=1 as well the writes are counted per tile of
+ * 8x8 pixels, not per pixel: a tile reads as the average of its 64 pixels, so
+ * one pixel written often in a tile written once shows as a warm tile. The
+ * last full draw of each screen is kept as an overdraw heatmap, another 7300
+ * bytes: ScreenStats_Heatmap writes them as text with a summary,
+ * ScreenStats_Heatmap_SVG one of them as an image. On the host the emulated
+ * panel counts the writes of every pixel as it gets them; test/test_heatmap
+ * (the native_heatmap env) saves a heatmap per screen at that resolution.
+ */
+#ifndef SCREENSTATS_H
+#define SCREENSTATS_H
+
+#include <Arduino.h>
+#include <TFT_eSPI.h>
+#include "Screen.h"
+
+#ifndef SCREEN_STATS_ENABLED
+#define SCREEN_STATS_ENABLED       0
+#endif
+
+#ifndef SCREEN_HEATMAP_ENABLED
+#define SCREEN_HEATMAP_ENABLED     0
+#endif
+
+#if SCREEN_HEATMAP_ENABLED && !SCREEN_STATS_ENABLED
+#error "SCREEN_HEATMAP_ENABLED needs SCREEN_STATS_ENABLED for the writes per tile"
+#endif
+
+#define SCREEN_STATS_WIDTH         240
+#define SCREEN_STATS_HEIGHT        240
+#define SCREEN_STATS_WINDOW_BYTES  11    // CASET, RASET, RAMWR and their 8 data bytes
+#define SCREEN_STATS_TILE          8     // Heatmap resolution in pixels
+#define SCREEN_STATS_TILES_X       (SCREEN_STATS_WIDTH / SCREEN_STATS_TILE)
+#define SCREEN_STATS_TILES_Y       (SCREEN_STATS_HEIGHT / SCREEN_STATS_TILE)
+#define SCREEN_STATS_SCREENS       3     // Screens we keep a heatmap for
+#define SCREEN_STATS_HOT           200   // Tiles written more often than this (1/100 per pixel) are hot
+
+struct Screen_Stats {
+  uint32_t calls;                        // Drawing calls that reached the display
+  uint32_t pixels;                       // Pixels written, overdraw included
+  uint32_t unique;                       // Different pixels written
+  uint32_t bytes;                        // Estimated SPI bytes
+  uint32_t heap_start;                   // Free heap before the draw
+  uint32_t heap_min;                     // Lowest free heap during the draw
+  uint32_t allocated;                    // Bytes allocated during the draw, with ALLOC_ENABLED only
+  uint32_t hash;                         // FNV-1a of the calls and their arguments
+};
+
+#if SCREEN_STATS_ENABLED
+
+class TFT_Counted : public TFT_eSPI {
+  public:
+    void    drawPixel(int32_t x, int32_t y, uint32_t color) override;
+    void    drawChar(int32_t x, int32_t y, uint16_t c, uint32_t color, uint32_t bg, uint8_t size) override;
+    int16_t drawChar(uint16_t uniCode, int32_t x, int32_t y, uint8_t font) override;
+    void    drawLine(int32_t xs, int32_t ys, int32_t xe, int32_t ye, uint32_t color) override;
+    void    drawFastVLine(int32_t x, int32_t y, int32_t h, uint32_t color) override;
+    void    drawFastHLine(int32_t x, int32_t y, int32_t w, uint32_t color) override;
+    void    fillRect(int32_t x, int32_t y, int32_t w, int32_t h, uint32_t color) override;
+    using   TFT_eSPI::drawChar;
+    using   TFT_eSPI::pushImage;
+    void    pushImage(int32_t x, int32_t y, int32_t w, int32_t h, const uint16_t *data);
+};
+
+typedef TFT_Counted TFT_Screen;
+
+void ScreenStats_Begin();
+const Screen_Stats &ScreenStats_Get();                 // Of the draw so far
+bool ScreenStats_End(const Screen &screen, bool full); // False when over budget
+#if SCREEN_HEATMAP_ENABLED
+void ScreenStats_Heatmap();                            // Into the response, see Metrics.h
+void ScreenStats_Heatmap_SVG(const char *name);
+#endif
+
+#else
+
+typedef TFT_eSPI TFT_Screen;
+
+#endif
+
+#endif
@@ -0,0 +1,77 @@
+/*
+ * Simulation of a whole day on the device. Built with -D SIM_ENABLED=1 the
+ * firmware runs on a virtual clock: main.cpp reads the time with Sim_Millis,
+ * a delay only moves the clock on, and when no task is due the clock jumps to
+ * the next deadline instead of waiting. Together with a replayed network (see
+ * Replay.h) and a scripted CO2 level the device runs a day in minutes.
+ *
+ * Every frame that drew something is logged with its virtual time, screen,
+ * hash and bytes (see ScreenStats.h); capture the serial output to keep the
+ * frame sequence. Sim_Task notes every run of a periodic task, and
+ * Sim_Report logs per task the runs and the shortest and longest interval,
+ * which shows cadence and drift, every virtual hour.
+ *
+ * The native_sim env runs the same on the host, a virtual day in a few
+ * minutes; redirect the output to keep the frame sequence. SIM_CLOCK_START
+ * sets the virtual millis() at the start, -D SIM_CLOCK_START=0xFFE488C0 starts
+ * half an hour before the wrap around. The time of day always starts at
+ * SIM_START_HOUR.
+ *
+ * On the host -D SIM_FRAMES=1 also saves every frame that drew something as
+ * it is on the emulated panel, a PPM image named after the virtual ms and
+ * the screen in SIM_FRAMES_DIR of LittleFS (data/frames); see the
+ * native_sim_frames env. That is 170 KB a frame, mind the disk. Only in the
+ * native env, the device has no panel to read back.
+ */
+#ifndef SIM_H
+#define SIM_H
+
+#include <stdint.h>
+#include "ScreenStats.h"
+#include "Replay.h"
+
+#ifndef SIM_ENABLED
+#define SIM_ENABLED                0
+#endif
+
+#if SIM_ENABLED && !SCREEN_STATS_ENABLED
+#error "SIM_ENABLED needs SCREEN_STATS_ENABLED for the frame log"
+#endif
+
+#if SIM_ENABLED && REPLAY_MODE != REPLAY_PLAY
+#error "SIM_ENABLED needs REPLAY_MODE=REPLAY_PLAY for the network"
+#endif
+
+#define SIM_START_HOUR             6     // Virtual time of day at the start
+#ifndef SIM_CLOCK_START
+#define SIM_CLOCK_START            0     // Virtual millis() at the start
+#endif
+#define SIM_REPORT_SEC             3600  // Virtual interval time (sec) between two reports
+#ifndef SIM_FRAMES
+#define SIM_FRAMES                 0     // Save every frame drawn, native env only
+#endif
+#define SIM_FRAMES_DIR             "/frames"
+
+#define SIM_TASK_RENDER            0     // Tasks we keep the cadence of
+#define SIM_TASK_WEATHER           1
+#define SIM_TASK_RAIN              2
+#define SIM_TASK_CO2               3
+#define SIM_TASKS                  4
+
+#if SIM_ENABLED
+
+uint32_t Sim_Millis();
+void     Sim_Delay(uint32_t ms);
+void     Sim_Idle(uint32_t wait);        // Nothing to do for wait ms
+int      Sim_CO2();                      // ppm at the virtual time of day
+void     Sim_Task(uint8_t task);
+void     Sim_Frame(const char *screen, uint32_t hash, uint32_t bytes);
+void     Sim_Report();
+
+#else
+
+inline void Sim_Task(uint8_t task) {}
+
+#endif
+
+#endif
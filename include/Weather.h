@@ -0,0 +1,60 @@
+/*
+ * Parsed weather and rain info. The parser fills a spare snapshot and only
+ * when that is complete it becomes the one shown on screen, so a failed fetch
+ * never leaves half updated data behind. Numbers are kept as numbers and only
+ * formatted when drawn.
+ */
+#ifndef WEATHER_H
+#define WEATHER_H
+
+#include <stdint.h>
+
+#define RAIN_READINGS              24    // Rain forecasts shown, every 5 minutes
+#define WEATHER_DESCRIPTION_LENGTH 64    // "Zwaar bewolkt", longer ones are cut off
+#define WEATHER_WINDDIR_LENGTH     4     // "ZZW"
+
+// Weather symbols we have a picture for, see WeatherSymbols.h
+enum WeatherIcon : uint8_t {
+  ICON_NONE = 0,
+  ICON_ZONNIG,                           // a
+  ICON_HALFBEWOLKT,                      // j
+  ICON_BEWOLKT,                          // b, d, f
+  ICON_ZWAARBEWOLKT,                     // c
+  ICON_WOLKENNACHT,                      // cc
+  ICON_BLIKSEM,                          // g, s
+  ICON_SNEEUW,                           // t, u, v
+  ICON_BUIEN,                            // m
+  ICON_MIST,                             // n
+  ICON_REGEN,                            // q
+  ICON_HAGEL                             // w
+};
+
+struct WeatherSnapshot {
+  bool        valid;                     // False until the first good fetch
+  bool        stale;                     // Saved before the restart, not fetched since
+  uint16_t    timestamp;                 // Time of the measurement, minutes after midnight
+  uint16_t    sunrise;                   // Minutes after midnight
+  uint16_t    sunset;
+  int16_t     temperature;               // 1/10 degree Celsius
+  int16_t     airpressure;               // 1/10 hPa
+  int16_t     windspeed;                 // Whole units, as shown
+  int16_t     sunpower;                  // Watt/m2
+  int16_t     rainFallLast24Hour;        // 1/10 mm
+  int16_t     rainFallLastHour;          // 1/10 mm
+  uint8_t     humidity;                  // Percent
+  uint8_t     precipitation;             // Percent chance of rain
+  WeatherIcon icon;
+  char        winddirection[WEATHER_WINDDIR_LENGTH];
+  char        description[WEATHER_DESCRIPTION_LENGTH];
+};
+
+struct RainSnapshot {
+  bool        valid;                     // False until the first good fetch
+  bool        stale;                     // Saved before the restart, not fetched since
+  uint8_t     readings;                  // Lines received, at most RAIN_READINGS
+  uint32_t    max;                       // Highest forecast in 1/1000 mm/hour
+  uint32_t    rain[RAIN_READINGS];       // Forecast in 1/1000 mm/hour
+  uint16_t    time[RAIN_READINGS];       // Time of each forecast, minutes after midnight
+};
+
+#endif
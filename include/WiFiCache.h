@@ -0,0 +1,30 @@
+/*
+ * Fast reconnect to the last access point. After a normal connect the BSSID,
+ * channel and the addresses DHCP gave us are saved; at the next start we ask
+ * for that access point directly, on its channel, with those addresses as
+ * static configuration. That skips the scan and the DHCP exchange. When it
+ * does not connect within the timeout the caller falls back to WiFiManager.
+ *
+ * The SSID and password are not in the file: they come from the station
+ * config the SDK keeps, so the password is never written to LittleFS. The
+ * saved addresses are a lease nobody renews. After WIFI_CACHE_MAX_STARTS fast
+ * connects the next start takes the normal way, with DHCP, and saves afresh.
+ * WiFi_Renew, every WIFI_RENEW_MS, does the same for a device that runs
+ * long on the saved addresses.
+ */
+#ifndef WIFICACHE_H
+#define WIFICACHE_H
+
+#include <stdint.h>
+
+#define WIFI_CACHE_FILE            "/wifi.bin"
+#define WIFI_FAST_TIMEOUT_MS       4000  // Give up on the fast connect after this
+#define WIFI_CACHE_MAX_STARTS      20    // Fast connects on the saved addresses before DHCP again
+#define WIFI_RENEW_MS              (12 * 3600000UL) // Running on the saved addresses until DHCP again
+#define WIFI_RENEW_WAIT_MS         10000 // For DHCP to give an address before it is saved
+
+bool WiFi_Fast_Connect(uint32_t timeout_ms);
+void WiFi_Remember();
+bool WiFi_Renew();                       // True when it wants to run again after WIFI_RENEW_WAIT_MS
+
+#endif
@@ -0,0 +1,223 @@
+/* *****************************************************************************
+
+   Copyright (C) 2022 P.A.G.M. Zengers
+
+   The Arduino core for the host, see Arduino.h and Native.h
+
+   This program is free software: you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation, either version 3 of the License, or
+   (at your option) any later version.
+
+ * ****************************************************************************/
+
+#include <Arduino.h>
+#include <time.h>
+#include "Native.h"
+
+HardwareSerial Serial;
+EspClass       ESP;
+Native_WiFi    native_wifi;
+
+static uint32_t native_offset = 0;      // ms delay() moved the clock on
+static uint8_t  native_pins[17];
+static uint32_t native_random = 1;
+
+static uint64_t Native_Real_Micros() {
+  static struct timespec start = { 0, 0 };
+  struct timespec now;
+  clock_gettime(CLOCK_MONOTONIC, &now);
+  if (start.tv_sec == 0 && start.tv_nsec == 0) start = now;
+  return (uint64_t)(now.tv_sec - start.tv_sec) * 1000000 + (now.tv_nsec - start.tv_nsec) / 1000;
+}
+
+uint32_t Native_Real_Millis() {
+  return Native_Real_Micros() / 1000;
+}
+
+void Native_Clock_Set(uint32_t ms) {
+  native_offset = ms - Native_Real_Millis();
+}
+
+unsigned long millis() {
+  return (uint32_t)(Native_Real_Millis() + native_offset);
+}
+
+unsigned long micros() {
+  return (uint32_t)(Native_Real_Micros() + native_offset * 1000ULL);
+}
+
+void delay(unsigned long ms) {
+  native_offset += ms;
+}
+
+void delayMicroseconds(unsigned int us) {
+  uint64_t end = Native_Real_Micros() + us;
+  while (Native_Real_Micros() < end) {}
+}
+
+void yield() {
+}
+
+void pinMode(uint8_t pin, uint8_t mode) {
+}
+
+void digitalWrite(uint8_t pin, uint8_t value) {
+  if (pin < sizeof(native_pins)) native_pins[pin] = value ? HIGH : LOW;
+}
+
+int digitalRead(uint8_t pin) {
+  return Native_Pin(pin);
+}
+
+uint8_t Native_Pin(uint8_t pin) {
+  return pin < sizeof(native_pins) ? native_pins[pin] : LOW;
+}
+
+void analogWrite(uint8_t pin, int value) {
+  digitalWrite(pin, value > 0);
+}
+
+int analogRead(uint8_t pin) {
+  return 512;
+}
+
+long map(long x, long in_min, long in_max, long out_min, long out_max) {
+  return (x - in_min) * (out_max - out_min) / (in_max - in_min) + out_min;
+}
+
+long random(long howbig) {
+  if (howbig <= 0) return 0;
+  native_random = native_random * 1103515245 + 12345;
+  return (native_random >> 8) % howbig;
+}
+
+long random(long howsmall, long howbig) {
+  return howsmall >= howbig ? howsmall : howsmall + random(howbig - howsmall);
+}
+
+void randomSeed(unsigned long seed) {
+  native_random = seed;
+}
+
+char *dtostrf(double number, signed char width, unsigned char precision, char *buffer) {
+  sprintf(buffer, "%*.*f", width, precision, number);
+  return buffer;
+}
+
+/* *****************************************************************************
+   Stream, as the ESP8266 core: waits for each byte until the timeout
+ * ****************************************************************************/
+
+int Stream::timedRead() {
+  unsigned long start = millis();
+  do {
+    int c = read();
+    if (c >= 0) return c;
+    yield();
+  } while ((uint32_t)(millis() - start) < stream_timeout);
+  return -1;
+}
+
+size_t Stream::readBytes(char *buffer, size_t length) {
+  size_t count = 0;
+  while (count < length) {
+    int c = timedRead();
+    if (c < 0) break;
+    buffer[count++] = c;
+  }
+  return count;
+}
+
+size_t Stream::readBytesUntil(char terminator, char *buffer, size_t length) {
+  size_t count = 0;
+  while (count < length) {
+    int c = timedRead();
+    if (c < 0 || c == terminator) break;
+    buffer[count++] = c;
+  }
+  return count;
+}
+
+String Stream::readString() {
+  String text;
+  int c;
+  while ((c = timedRead()) >= 0) text += (char)c;
+  return text;
+}
+
+String Stream::readStringUntil(char terminator) {
+  String text;
+  int c;
+  while ((c = timedRead()) >= 0 && c != terminator) text += (char)c;
+  return text;
+}
+
+size_t HardwareSerial::write(const uint8_t *buffer, size_t size) {
+  return fwrite(buffer, 1, size, stdout);
+}
+
+void HardwareSerial::flush() {
+  fflush(stdout);
+}
+
+/* *****************************************************************************
+   ESP. The RTC memory survives a restart in NATIVE_RTC_FILE, as on the
+   device it survives a reset; remove the file for a power cycle
+ * ****************************************************************************/
+
+#define NATIVE_RTC_SIZE            512   // User RTC memory, in blocks of 4 bytes
+
+static uint8_t  native_rtc[NATIVE_RTC_SIZE];
+static bool     native_rtc_loaded = false;
+static rst_info native_reset_info;
+
+static void Native_RTC_Load() {
+  if (native_rtc_loaded) return;
+  native_rtc_loaded = true;
+  char path[256];
+  FILE *file = fopen(Native_Path(NATIVE_RTC_FILE, path, sizeof(path)), "rb");
+  native_reset_info.reason = file ? REASON_EXT_SYS_RST : REASON_DEFAULT_RST;
+  if (!file) return;
+  if (fread(native_rtc, 1, sizeof(native_rtc), file) != sizeof(native_rtc)) memset(native_rtc, 0, sizeof(native_rtc));
+  fclose(file);
+}
+
+bool EspClass::rtcUserMemoryRead(uint32_t offset, uint32_t *data, size_t size) {
+  if (offset * 4 + size > NATIVE_RTC_SIZE || (size & 3)) return false;
+  Native_RTC_Load();
+  memcpy(data, native_rtc + offset * 4, size);
+  return true;
+}
+
+bool EspClass::rtcUserMemoryWrite(uint32_t offset, uint32_t *data, size_t size) {
+  if (offset * 4 + size > NATIVE_RTC_SIZE || (size & 3)) return false;
+  Native_RTC_Load();
+  memcpy(native_rtc + offset * 4, data, size);
+  char path[256];
+  FILE *file = fopen(Native_Path(NATIVE_RTC_FILE, path, sizeof(path)), "wb");
+  if (!file) return false;
+  bool ok = fwrite(native_rtc, 1, sizeof(native_rtc), file) == sizeof(native_rtc);
+  fclose(file);
+  return ok;
+}
+
+rst_info *EspClass::getResetInfoPtr() {
+  Native_RTC_Load();
+  return &native_reset_info;
+}
+
+String EspClass::getResetReason() {
+  return getResetInfoPtr()->reason == REASON_DEFAULT_RST ? "Power On" : "External System";
+}
+
+void EspClass::getHeapStats(uint32_t *free, uint16_t *max, uint8_t *fragmentation) {
+  if (free) *free = getFreeHeap();
+  if (max) *max = getMaxFreeBlockSize();
+  if (fragmentation) *fragmentation = getHeapFragmentation();
+}
+
+void EspClass::restart() {
+  Serial.flush();
+  exit(0);
+}
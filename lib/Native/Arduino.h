@@ -0,0 +1,318 @@
+/*
+ * The part of the Arduino core of the ESP8266 the firmware uses, for the
+ * host: String, Print and Stream, Serial on stdout, the pins, the clock and
+ * ESP. See Native.h for the clock and the heap figures.
+ */
+#ifndef ARDUINO_H
+#define ARDUINO_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdlib.h>
+#include <stdarg.h>
+#include <string.h>
+#include <strings.h>
+#include <stdio.h>
+#include <ctype.h>
+#include <math.h>
+#include <string>
+#include <algorithm>
+#include "pgmspace.h"
+
+#define F(s)                       (reinterpret_cast<const __FlashStringHelper *>(PSTR(s)))
+#define ICACHE_RAM_ATTR
+#define IRAM_ATTR
+
+#define HIGH                       1
+#define LOW                        0
+#define INPUT                      0
+#define OUTPUT                     1
+#define INPUT_PULLUP               2
+
+#define DEC                        10
+#define HEX                        16
+#define OCT                        8
+#define BIN                        2
+
+static const uint8_t D0 = 16, D1 = 5, D2 = 4, D3 = 0, D4 = 2, D5 = 14, D6 = 12, D7 = 13, D8 = 15;
+
+typedef uint8_t byte;
+typedef bool    boolean;
+
+using std::min;
+using std::max;
+
+#define constrain(amt, low, high)  ((amt) < (low) ? (low) : ((amt) > (high) ? (high) : (amt)))
+#define noInterrupts()
+#define interrupts()
+
+class String {
+  public:
+    String() {}
+    String(const char *text) : s(text ? text : "") {}
+    String(const __FlashStringHelper *text) : s(text ? (const char *)text : "") {}
+    String(const std::string &text) : s(text) {}
+    explicit String(char c) : s(1, c) {}
+    explicit String(unsigned char value, unsigned char base = 10) { Number(value, base); }
+    explicit String(int value, unsigned char base = 10) { Number(value, base); }
+    explicit String(unsigned int value, unsigned char base = 10) { Number(value, base); }
+    explicit String(long value, unsigned char base = 10) { Number(value, base); }
+    explicit String(unsigned long value, unsigned char base = 10) { Number(value, base); }
+    explicit String(float value, unsigned char decimals = 2) { Float(value, decimals); }
+    explicit String(double value, unsigned char decimals = 2) { Float(value, decimals); }
+
+    unsigned int length() const               { return s.size(); }
+    bool         isEmpty() const              { return s.empty(); }
+    const char  *c_str() const                { return s.c_str(); }
+    bool         reserve(unsigned int size)   { s.reserve(size); return true; }
+    char         charAt(unsigned int i) const { return i < s.size() ? s[i] : 0; }
+    char         operator[](unsigned int i) const { return charAt(i); }
+    void         setCharAt(unsigned int i, char c) { if (i < s.size()) s[i] = c; }
+
+    String &operator=(const char *text)       { s = text ? text : ""; return *this; }
+    String &operator+=(const String &other)   { s += other.s; return *this; }
+    String &operator+=(const char *text)      { if (text) s += text; return *this; }
+    String &operator+=(char c)                { s += c; return *this; }
+    String &operator+=(int value)             { return *this += String(value); }
+    String &operator+=(unsigned long value)   { return *this += String(value); }
+    bool    concat(const String &other)       { s += other.s; return true; }
+    bool    concat(const char *text)          { if (text) s += text; return true; }
+    bool    concat(char c)                    { s += c; return true; }
+
+    bool operator==(const String &other) const { return s == other.s; }
+    bool operator==(const char *text) const    { return s == (text ? text : ""); }
+    bool operator!=(const String &other) const { return s != other.s; }
+    bool operator!=(const char *text) const    { return !(*this == text); }
+    bool operator<(const String &other) const  { return s < other.s; }
+    int  compareTo(const String &other) const  { return s.compare(other.s); }
+    bool equals(const String &other) const     { return s == other.s; }
+    bool equals(const char *text) const        { return *this == text; }
+    bool equalsIgnoreCase(const String &other) const { return strcasecmp(s.c_str(), other.s.c_str()) == 0; }
+    bool startsWith(const String &prefix) const { return s.compare(0, prefix.s.size(), prefix.s) == 0; }
+    bool endsWith(const String &suffix) const {
+      return s.size() >= suffix.s.size() && s.compare(s.size() - suffix.s.size(), suffix.s.size(), suffix.s) == 0;
+    }
+
+    int indexOf(char c, unsigned int from = 0) const { return Found(s.find(c, from)); }
+    int indexOf(const String &text, unsigned int from = 0) const { return Found(s.find(text.s, from)); }
+    int lastIndexOf(char c) const { return Found(s.rfind(c)); }
+    int lastIndexOf(char c, unsigned int from) const { return Found(s.rfind(c, from)); }
+    int lastIndexOf(const String &text) const { return Found(s.rfind(text.s)); }
+
+    String substring(unsigned int left) const { return substring(left, s.size()); }
+    String substring(unsigned int left, unsigned int right) const {
+      if (left > right) std::swap(left, right);
+      if (left >= s.size()) return String();
+      if (right > s.size()) right = s.size();
+      return String(s.substr(left, right - left));
+    }
+
+    void toCharArray(char *buffer, unsigned int size, unsigned int index = 0) const { getBytes((unsigned char *)buffer, size, index); }
+    void getBytes(unsigned char *buffer, unsigned int size, unsigned int index = 0) const {
+      if (size == 0 || buffer == NULL) return;
+      if (index >= s.size()) {
+        buffer[0] = 0;
+        return;
+      }
+      unsigned int n = std::min(size - 1, (unsigned int)s.size() - index);
+      memcpy(buffer, s.c_str() + index, n);
+      buffer[n] = 0;
+    }
+
+    long   toInt() const   { return atol(s.c_str()); }
+    float  toFloat() const { return atof(s.c_str()); }
+    double toDouble() const { return atof(s.c_str()); }
+    void   toLowerCase()   { for (char &c : s) c = tolower(c); }
+    void   toUpperCase()   { for (char &c : s) c = toupper(c); }
+    void   remove(unsigned int index) { if (index < s.size()) s.erase(index); }
+    void   remove(unsigned int index, unsigned int count) { if (index < s.size()) s.erase(index, count); }
+    void   replace(const String &find, const String &with) {
+      if (find.s.empty()) return;
+      for (size_t at = s.find(find.s); at != std::string::npos; at = s.find(find.s, at + with.s.size())) s.replace(at, find.s.size(), with.s);
+    }
+    void trim() {
+      size_t first = 0, last = s.size();
+      while (first < last && isspace((unsigned char)s[first])) first++;
+      while (last > first && isspace((unsigned char)s[last - 1])) last--;
+      s = s.substr(first, last - first);
+    }
+
+  private:
+    static int Found(size_t at) { return at == std::string::npos ? -1 : (int)at; }
+    void Number(long value, unsigned char base) {
+      if (base == 10) { s = std::to_string(value); return; }
+      Number((unsigned long)value, base);
+    }
+    void Number(unsigned long value, unsigned char base) {
+      char digits[33], *p = digits + sizeof(digits) - 1;
+      *p = 0;
+      do {
+        *--p = "0123456789abcdef"[value % base];
+        value /= base;
+      } while (value > 0);
+      s = p;
+    }
+    void Number(int value, unsigned char base)          { Number((long)value, base); }
+    void Number(unsigned int value, unsigned char base) { Number((unsigned long)value, base); }
+    void Number(unsigned char value, unsigned char base) { Number((unsigned long)value, base); }
+    void Float(double value, unsigned char decimals) {
+      char text[40];
+      snprintf(text, sizeof(text), "%.*f", decimals, value);
+      s = text;
+    }
+
+    std::string s;
+};
+
+inline String operator+(const String &a, const String &b) { String r(a); r += b; return r; }
+inline String operator+(const String &a, const char *b)   { String r(a); r += b; return r; }
+inline String operator+(const char *a, const String &b)   { String r(a); r += b; return r; }
+inline String operator+(const String &a, char b)          { String r(a); r += b; return r; }
+inline String operator+(const String &a, int b)           { String r(a); r += b; return r; }
+inline String operator+(const String &a, unsigned long b) { String r(a); r += b; return r; }
+
+class Print {
+  public:
+    virtual ~Print() {}
+    virtual size_t write(uint8_t c) = 0;
+    virtual size_t write(const uint8_t *buffer, size_t size) {
+      size_t n = 0;
+      while (size--) n += write(*buffer++);
+      return n;
+    }
+    size_t write(const char *text) { return text ? write((const uint8_t *)text, strlen(text)) : 0; }
+    size_t write(const char *buffer, size_t size) { return write((const uint8_t *)buffer, size); }
+    virtual int availableForWrite() { return 0; }
+    virtual void flush() {}
+
+    size_t print(const __FlashStringHelper *text) { return write((const char *)text); }
+    size_t print(const String &text)              { return write((const uint8_t *)text.c_str(), text.length()); }
+    size_t print(const char *text)                { return write(text); }
+    size_t print(char c)                          { return write((uint8_t)c); }
+    size_t print(unsigned char value, int base = DEC) { return print((unsigned long)value, base); }
+    size_t print(int value, int base = DEC)       { return print((long)value, base); }
+    size_t print(unsigned int value, int base = DEC) { return print((unsigned long)value, base); }
+    size_t print(long value, int base = DEC)      { return print(base == DEC ? String(value) : String((unsigned long)value, base)); }
+    size_t print(unsigned long value, int base = DEC) { return print(String(value, base)); }
+    size_t print(double value, int decimals = 2)  { return print(String(value, decimals)); }
+
+    size_t println()                              { return write("\r\n"); }
+    template <typename T> size_t println(const T &value) { size_t n = print(value); return n + println(); }
+    template <typename T> size_t println(const T &value, int format) { size_t n = print(value, format); return n + println(); }
+
+    size_t printf(const char *format, ...) __attribute__((format(printf, 2, 3))) {
+      char text[256];
+      va_list args;
+      va_start(args, format);
+      int length = vsnprintf(text, sizeof(text), format, args);
+      va_end(args);
+      return length > 0 ? write((const uint8_t *)text, std::min(length, (int)sizeof(text) - 1)) : 0;
+    }
+    size_t printf_P(const char *format, ...) {
+      char text[256];
+      va_list args;
+      va_start(args, format);
+      int length = vsnprintf(text, sizeof(text), format, args);
+      va_end(args);
+      return length > 0 ? write((const uint8_t *)text, std::min(length, (int)sizeof(text) - 1)) : 0;
+    }
+};
+
+class Stream : public Print {
+  public:
+    virtual int available() = 0;
+    virtual int read() = 0;
+    virtual int peek() = 0;
+
+    void          setTimeout(unsigned long timeout) { stream_timeout = timeout; }
+    unsigned long getTimeout() const                { return stream_timeout; }
+
+    size_t readBytes(char *buffer, size_t length);
+    size_t readBytes(uint8_t *buffer, size_t length) { return readBytes((char *)buffer, length); }
+    size_t readBytesUntil(char terminator, char *buffer, size_t length);
+    String readString();
+    String readStringUntil(char terminator);
+
+  protected:
+    int timedRead();                     // -1 after the timeout
+    unsigned long stream_timeout = 1000;
+};
+
+class HardwareSerial : public Stream {
+  public:
+    void   begin(unsigned long baud) {}
+    void   end() {}
+    void   swap() {}
+    void   setDebugOutput(bool on) {}
+    int    available() override { return 0; }
+    int    read() override      { return -1; }
+    int    peek() override      { return -1; }
+    size_t write(uint8_t c) override { return write(&c, 1); }
+    size_t write(const uint8_t *buffer, size_t size) override;
+    using  Print::write;
+    int    availableForWrite() override { return 128; } // The UART FIFO
+    void   flush() override;
+};
+
+extern HardwareSerial Serial;
+
+unsigned long millis();
+unsigned long micros();
+void          delay(unsigned long ms);
+void          delayMicroseconds(unsigned int us);
+void          yield();
+
+void pinMode(uint8_t pin, uint8_t mode);
+void digitalWrite(uint8_t pin, uint8_t value);
+int  digitalRead(uint8_t pin);
+void analogWrite(uint8_t pin, int value);
+int  analogRead(uint8_t pin);
+
+long map(long x, long in_min, long in_max, long out_min, long out_max);
+long random(long howbig);
+long random(long howsmall, long howbig);
+void randomSeed(unsigned long seed);
+char *dtostrf(double number, signed char width, unsigned char precision, char *buffer);
+
+#define panic()                    abort()
+
+enum rst_reason {
+  REASON_DEFAULT_RST = 0,                // Power on
+  REASON_WDT_RST = 1,
+  REASON_EXCEPTION_RST = 2,
+  REASON_SOFT_WDT_RST = 3,
+  REASON_SOFT_RESTART = 4,
+  REASON_DEEP_SLEEP_AWAKE = 5,
+  REASON_EXT_SYS_RST = 6                 // Reset button
+};
+
+struct rst_info {
+  uint32_t reason;
+  uint32_t exccause, epc1, epc2, epc3, excvaddr, depc;
+};
+
+class EspClass {
+  public:
+    uint32_t getFreeHeap()          { return heap_free; }
+    uint32_t getMaxFreeBlockSize()  { return heap_max_block; }
+    uint8_t  getHeapFragmentation() { return heap_free ? 100 - heap_max_block * 100 / heap_free : 0; }
+    void     getHeapStats(uint32_t *free = NULL, uint16_t *max = NULL, uint8_t *fragmentation = NULL);
+    uint32_t getFreeContStack()     { return 3000; }
+    uint32_t getCycleCount()        { return micros() * getCpuFreqMHz(); }
+    uint8_t  getCpuFreqMHz()        { return 80; }
+    uint32_t getChipId()            { return 0x00C0FFEE; }
+    String   getResetReason();
+    rst_info *getResetInfoPtr();
+    bool     rtcUserMemoryRead(uint32_t offset, uint32_t *data, size_t size);
+    bool     rtcUserMemoryWrite(uint32_t offset, uint32_t *data, size_t size);
+    void     reset()                 { restart(); }
+    void     restart();              // Ends the program
+    void     deepSleep(uint64_t us)  { restart(); }
+
+    uint32_t heap_free      = 46000;     // Made up, about that of the device with WiFi up
+    uint32_t heap_max_block = 42000;
+};
+
+extern EspClass ESP;
+
+#endif
@@ -0,0 +1,16 @@
+/*
+ * DNSServer for the host; only WiFiManager uses it, for its portal
+ */
+#ifndef NATIVE_DNSSERVER_H
+#define NATIVE_DNSSERVER_H
+
+#include <ESP8266WiFi.h>
+
+class DNSServer {
+  public:
+    bool start(uint16_t port, const String &domain, IPAddress ip) { return true; }
+    void processNextRequest() {}
+    void stop() {}
+};
+
+#endif
@@ -0,0 +1,72 @@
+/*
+ * ESP8266WebServer for the host. Nothing listens; Native_Get calls the
+ * handler of a path the way a request would and returns what it sent, so
+ * the tests can scrape /metrics.
+ */
+#ifndef NATIVE_ESP8266WEBSERVER_H
+#define NATIVE_ESP8266WEBSERVER_H
+
+#include <ESP8266WiFi.h>
+#include <functional>
+#include <map>
+
+#define HTTP_ANY                   0
+#define HTTP_GET                   1
+#define HTTP_POST                  3
+#define CONTENT_LENGTH_UNKNOWN     ((size_t)-1)
+
+class ESP8266WebServer {
+  public:
+    typedef std::function<void()> THandlerFunction;
+
+    ESP8266WebServer(int port = 80) {}
+    void   begin() {}
+    void   handleClient() {}
+    void   on(const char *uri, THandlerFunction handler) { handlers[uri] = handler; }
+    void   on(const char *uri, int method, THandlerFunction handler) { handlers[uri] = handler; }
+    void   onNotFound(THandlerFunction handler) { not_found = handler; }
+
+    String uri() { return current_uri; }
+    String arg(const char *name) { return args.count(name) ? String(args[name].c_str()) : String(); }
+    bool   hasArg(const char *name) { return args.count(name) > 0; }
+    void   sendHeader(const char *name, const String &value) {}
+    void   setContentLength(size_t length) {}
+    void   send(int code, const char *type, const String &content) { status = code; sendContent(content); }
+    void   send(int code, const char *type, const char *content) { send(code, type, String(content)); }
+    void   send_P(int code, const char *type, const char *content) { send(code, type, String(content)); }
+    void   sendContent(const String &content) { body += content.c_str(); }
+    void   sendContent(const char *content, size_t size) { body.append(content, size); }
+    void   sendContent_P(const char *content) { body += content; }
+    void   sendContent_P(const char *content, size_t size) { body.append(content, size); }
+
+    String Native_Get(const char *path, int *code = NULL) {
+      std::string target = path;
+      size_t query = target.find('?');
+      current_uri = String(target.substr(0, query).c_str());
+      args.clear();
+      for (size_t start = query; start != std::string::npos;) { // ?name=value&...
+        size_t      next   = target.find('&', start + 1);
+        std::string pair   = target.substr(start + 1, next == std::string::npos ? std::string::npos : next - start - 1);
+        size_t      equals = pair.find('=');
+        if (!pair.empty()) args[pair.substr(0, equals)] = equals == std::string::npos ? "" : pair.substr(equals + 1);
+        start = next;
+      }
+      body.clear();
+      status = 404;
+      auto handler = handlers.find(current_uri.c_str());
+      if (handler != handlers.end()) handler->second();
+      else if (not_found)            not_found();
+      if (code) *code = status;
+      return String(body.c_str());
+    }
+
+  private:
+    std::map<std::string, THandlerFunction> handlers;
+    std::map<std::string, std::string>      args;
+    THandlerFunction not_found;
+    String           current_uri;
+    std::string      body;
+    int              status = 0;
+};
+
+#endif
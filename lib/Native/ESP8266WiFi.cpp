@@ -0,0 +1,104 @@
+/* *****************************************************************************
+
+   Copyright (C) 2022 P.A.G.M. Zengers
+
+   WiFi of the native env, see ESP8266WiFi.h
+
+   This program is free software: you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation, either version 3 of the License, or
+   (at your option) any later version.
+
+ * ****************************************************************************/
+
+#include <ESP8266WiFi.h>
+#include <user_interface.h>
+#include "Native.h"
+
+ESP8266WiFiClass WiFi;
+
+static void Native_DHCP(IPAddress *addresses) {
+  addresses[0] = IPAddress(192, 168, 1, 50);
+  addresses[1] = IPAddress(192, 168, 1, 1);
+  addresses[2] = IPAddress(255, 255, 255, 0);
+  addresses[3] = IPAddress(192, 168, 1, 1);
+  addresses[4] = IPAddress();
+}
+
+bool wifi_station_get_config_default(struct station_config *config) {
+  memset(config, 0, sizeof(*config));
+  char path[256];
+  FILE *file = fopen(Native_Path(NATIVE_SDK_FILE, path, sizeof(path)), "rb");
+  if (!file) return true; // Never connected, nothing set
+  if (fread(config, 1, sizeof(*config), file) != sizeof(*config)) memset(config, 0, sizeof(*config));
+  fclose(file);
+  return true;
+}
+
+bool wifi_station_set_config(struct station_config *config) {
+  char path[256];
+  FILE *file = fopen(Native_Path(NATIVE_SDK_FILE, path, sizeof(path)), "wb");
+  if (!file) return false;
+  bool ok = fwrite(config, 1, sizeof(*config), file) == sizeof(*config);
+  fclose(file);
+  return ok;
+}
+
+String IPAddress::toString() const {
+  char text[16];
+  snprintf(text, sizeof(text), "%u.%u.%u.%u", (*this)[0], (*this)[1], (*this)[2], (*this)[3]);
+  return String(text);
+}
+
+bool ESP8266WiFiClass::config(IPAddress ip, IPAddress gateway, IPAddress subnet, IPAddress dns1, IPAddress dns2) {
+  if (!ip.isSet()) { // DHCP client
+    if (connecting) Native_DHCP(addresses);
+    else            addresses[0] = IPAddress();
+    return true;
+  }
+  addresses[0] = ip;
+  addresses[1] = gateway;
+  addresses[2] = subnet;
+  addresses[3] = dns1;
+  addresses[4] = dns2;
+  return true;
+}
+
+int ESP8266WiFiClass::begin(const char *ssid, const char *psk, int32_t channel, const uint8_t *bssid, bool connect) {
+/* *****************************************************************************
+   ESP8266WiFiClass::begin
+
+   Start to connect. Only the access point of native_wifi is there; it takes
+   native_wifi.fast_ms with its BSSID and channel, otherwise connect_ms. While
+   persistent the SSID and password go to the station config of the SDK
+ * *****************************************************************************/
+  this->ssid     = ssid ? ssid : "";
+  this->password = psk ? psk : "";
+  connecting = connect && this->ssid == native_wifi.ssid;
+  started    = millis();
+  takes      = (bssid && channel > 0 && memcmp(bssid, this->bssid, sizeof(this->bssid)) == 0) ? native_wifi.fast_ms : native_wifi.connect_ms;
+  if (!addresses[0].isSet()) Native_DHCP(addresses);
+  if (saves) {
+    station_config config = {};
+    strncpy((char *)config.ssid, this->ssid.c_str(), sizeof(config.ssid));
+    strncpy((char *)config.password, this->password.c_str(), sizeof(config.password));
+    wifi_station_set_config(&config);
+  }
+  return status();
+}
+
+bool ESP8266WiFiClass::disconnect(bool wifioff) {
+  connecting = false;
+  return true;
+}
+
+int ESP8266WiFiClass::status() {
+  if (!connecting) return WL_DISCONNECTED;
+  return (uint32_t)(millis() - started) >= takes ? WL_CONNECTED : WL_DISCONNECTED;
+}
+
+int ESP8266WiFiClass::hostByName(const char *host, IPAddress &ip) {
+  if (status() != WL_CONNECTED) return 0;
+  ip = IPAddress(192, 0, 2, 1); // Documentation range, nothing is sent there
+  return 1;
+}
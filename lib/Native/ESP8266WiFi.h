@@ -0,0 +1,87 @@
+/*
+ * ESP8266WiFi for the host. There is no radio: begin() is connected after
+ * the made up times of native_wifi (see Native.h), at once for a known
+ * BSSID and channel. config() without an address starts DHCP, which answers
+ * at once. Names resolve to a fixed address, the stand-in server
+ * of WiFiClientSecure.h does not need one.
+ */
+#ifndef NATIVE_ESP8266WIFI_H
+#define NATIVE_ESP8266WIFI_H
+
+#include <Arduino.h>
+
+#define WL_IDLE_STATUS             0
+#define WL_NO_SSID_AVAIL           1
+#define WL_CONNECTED               3
+#define WL_CONNECT_FAILED          4
+#define WL_DISCONNECTED            6
+
+#define WIFI_OFF                   0
+#define WIFI_STA                   1
+#define WIFI_AP                    2
+#define WIFI_AP_STA                3
+
+class IPAddress {
+  public:
+    IPAddress() {}
+    IPAddress(uint32_t address) : address(address) {}
+    IPAddress(uint8_t a, uint8_t b, uint8_t c, uint8_t d) : address(a | b << 8 | c << 16 | (uint32_t)d << 24) {}
+    operator uint32_t() const { return address; }
+    uint8_t operator[](int index) const { return address >> (8 * index); }
+    bool    isSet() const { return address != 0; }
+    String  toString() const;
+
+  private:
+    uint32_t address = 0;                // First octet in the low byte, as on the device
+};
+
+class WiFiClient : public Stream {
+  public:
+    virtual int     connect(const char *host, uint16_t port) { return 0; }
+    virtual int     connect(IPAddress ip, uint16_t port) { return 0; }
+    virtual uint8_t connected() { return 0; }
+    virtual void    stop() {}
+    int     available() override { return 0; }
+    int     read() override { return -1; }
+    int     peek() override { return -1; }
+    size_t  write(uint8_t c) override { return write(&c, 1); }
+    size_t  write(const uint8_t *buffer, size_t size) override { return 0; }
+    using   Print::write;
+    void    setNoDelay(bool nodelay) {}
+};
+
+class ESP8266WiFiClass {
+  public:
+    bool      persistent(bool persistent) { saves = persistent; return true; }
+    bool      mode(int mode) { return true; }
+    bool      setAutoConnect(bool autoConnect) { return true; }
+    bool      config(IPAddress ip, IPAddress gateway, IPAddress subnet, IPAddress dns1 = IPAddress(), IPAddress dns2 = IPAddress());
+    int       begin(const char *ssid, const char *psk = NULL, int32_t channel = 0, const uint8_t *bssid = NULL, bool connect = true);
+    bool      disconnect(bool wifioff = false);
+    int       status();
+    bool      hostname(const char *name) { device_name = name; return true; }
+    String    hostname() { return device_name; }
+    String    SSID() { return status() == WL_CONNECTED ? String(ssid.c_str()) : String(); }
+    String    psk() { return status() == WL_CONNECTED ? String(password.c_str()) : String(); }
+    uint8_t  *BSSID() { return bssid; }
+    int32_t   channel() { return 6; }
+    int32_t   RSSI() { return -60; }
+    IPAddress localIP() { return status() == WL_CONNECTED ? addresses[0] : IPAddress(); }
+    IPAddress gatewayIP() { return addresses[1]; }
+    IPAddress subnetMask() { return addresses[2]; }
+    IPAddress dnsIP(uint8_t n = 0) { return addresses[3 + (n & 1)]; }
+    IPAddress softAPIP() { return IPAddress(192, 168, 4, 1); }
+    int       hostByName(const char *host, IPAddress &ip);
+
+  private:
+    std::string device_name = "esp8266", ssid, password;
+    uint8_t     bssid[6] = { 0x02, 0x4E, 0x41, 0x54, 0x49, 0x56 };
+    IPAddress   addresses[5];            // ip, gateway, subnet, dns1, dns2
+    bool        connecting = false;
+    bool        saves = true;            // begin() writes the station config of the SDK
+    uint32_t    started = 0, takes = 0;  // millis() of begin(), ms until connected
+};
+
+extern ESP8266WiFiClass WiFi;
+
+#endif
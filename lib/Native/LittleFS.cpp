@@ -0,0 +1,94 @@
+/* *****************************************************************************
+
+   Copyright (C) 2022 P.A.G.M. Zengers
+
+   LittleFS of the native env, see LittleFS.h
+
+   This program is free software: you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation, either version 3 of the License, or
+   (at your option) any later version.
+
+ * ****************************************************************************/
+
+#include <LittleFS.h>
+#include <sys/stat.h>
+#include "Native.h"
+
+FS LittleFS;
+
+const char *Native_Path(const char *path, char *buffer, size_t size) {
+  const char *root = getenv("NATIVE_FS");
+  snprintf(buffer, size, "%s%s%s", root && *root ? root : NATIVE_FS_DEFAULT, *path == '/' ? "" : "/", path);
+  return buffer;
+}
+
+int File::available() {
+  return file ? size() - position() : 0;
+}
+
+int File::read() {
+  return file ? fgetc(file.get()) : -1;
+}
+
+int File::peek() {
+  if (!file) return -1;
+  int c = fgetc(file.get());
+  if (c >= 0) ungetc(c, file.get());
+  return c;
+}
+
+size_t File::size() const {
+  struct stat info;
+  if (!file) return 0;
+  fflush(file.get());
+  return fstat(fileno(file.get()), &info) == 0 ? info.st_size : 0;
+}
+
+bool FS::begin() {
+  char root[256];
+  Native_Path("", root, sizeof(root));
+  ::mkdir(root, 0777);
+  struct stat info;
+  return stat(root, &info) == 0 && S_ISDIR(info.st_mode);
+}
+
+bool FS::mkdir(const char *path) {
+  char full[256];
+  return ::mkdir(Native_Path(path, full, sizeof(full)), 0777) == 0;
+}
+
+File FS::open(const char *path, const char *mode) {
+/* *****************************************************************************
+   FS::open
+
+   Open as fopen does, in binary. Writing makes the directories of the path
+ * *****************************************************************************/
+  char full[256], binary[4];
+  Native_Path(path, full, sizeof(full));
+  if (mode[0] != 'r') {
+    for (char *slash = strchr(full + 1, '/'); slash; slash = strchr(slash + 1, '/')) {
+      *slash = '\0';
+      ::mkdir(full, 0777);
+      *slash = '/';
+    }
+  }
+  snprintf(binary, sizeof(binary), "%c%sb", mode[0], mode[1] == '+' ? "+" : "");
+  return File(fopen(full, binary));
+}
+
+bool FS::exists(const char *path) {
+  char full[256];
+  struct stat info;
+  return stat(Native_Path(path, full, sizeof(full)), &info) == 0;
+}
+
+bool FS::remove(const char *path) {
+  char full[256];
+  return ::remove(Native_Path(path, full, sizeof(full))) == 0;
+}
+
+bool FS::rename(const char *from, const char *to) {
+  char full_from[256], full_to[256];
+  return ::rename(Native_Path(from, full_from, sizeof(full_from)), Native_Path(to, full_to, sizeof(full_to))) == 0;
+}
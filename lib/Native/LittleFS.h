@@ -0,0 +1,56 @@
+/*
+ * LittleFS for the host: a directory, NATIVE_FS or data by default, see
+ * Native.h. Directories are made on the way when a file is written.
+ * format() leaves the directory as it is; it holds the recordings.
+ */
+#ifndef NATIVE_LITTLEFS_H
+#define NATIVE_LITTLEFS_H
+
+#include <Arduino.h>
+#include <memory>
+
+enum SeekMode {
+  SeekSet = 0,
+  SeekCur = 1,
+  SeekEnd = 2
+};
+
+class File : public Stream {
+  public:
+    File() {}
+    File(FILE *file) { if (file) this->file.reset(file, fclose); }
+    operator bool() const { return file != nullptr; }
+
+    int    available() override;
+    int    read() override;
+    int    peek() override;
+    size_t read(uint8_t *buffer, size_t size) { return file ? fread(buffer, 1, size, file.get()) : 0; }
+    size_t write(uint8_t c) override { return write(&c, 1); }
+    size_t write(const uint8_t *buffer, size_t size) override { return file ? fwrite(buffer, 1, size, file.get()) : 0; }
+    using  Print::write;
+    void   flush() override { if (file) fflush(file.get()); }
+    bool   seek(uint32_t position, SeekMode mode = SeekSet) { return file && fseek(file.get(), position, mode) == 0; }
+    size_t position() const { return file ? ftell(file.get()) : 0; }
+    size_t size() const;
+    void   close() { file.reset(); }
+
+  private:
+    std::shared_ptr<FILE> file;          // Copies share it, as on the device
+};
+
+class FS {
+  public:
+    bool begin();
+    void end() {}
+    bool format() { return true; }
+    File open(const char *path, const char *mode);
+    File open(const String &path, const char *mode) { return open(path.c_str(), mode); }
+    bool exists(const char *path);
+    bool remove(const char *path);
+    bool rename(const char *from, const char *to);
+    bool mkdir(const char *path);
+};
+
+extern FS LittleFS;
+
+#endif
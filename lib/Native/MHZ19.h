@@ -0,0 +1,80 @@
+/*
+ * The MHZ19 library (crisap94/MHZ19) for the host: the same results and
+ * ranges, over the emulated sensor of SoftwareSerial.h. Each call sends its
+ * command and waits for the reply, as the library does.
+ */
+#ifndef NATIVE_MHZ19_H
+#define NATIVE_MHZ19_H
+
+#include <Arduino.h>
+
+#define MHZ19_TIMEOUT              500   // ms for a reply
+
+enum MHZ19_RESULT {
+  MHZ19_RESULT_NULL = 0,
+  MHZ19_RESULT_OK,
+  MHZ19_RESULT_ERR_TIMEOUT,
+  MHZ19_RESULT_ERR_SYNTAX,
+  MHZ19_RESULT_ERR_CRC,
+  MHZ19_RESULT_ERR_FILTER,
+  MHZ19_RESULT_FAILED
+};
+
+enum MHZ19_RANGE {
+  MHZ19_RANGE_1000,
+  MHZ19_RANGE_2000,
+  MHZ19_RANGE_3000,
+  MHZ19_RANGE_5000
+};
+
+class MHZ19 {
+  public:
+    MHZ19(Stream *port) : port(port) {}
+
+    MHZ19_RESULT retrieveData() {
+      MHZ19_RESULT result = Command(0x86, 0, 0);
+      if (result == MHZ19_RESULT_OK) {
+        co2 = reply[2] * 256 + reply[3];
+        temperature = reply[4] - 40;
+      }
+      return result;
+    }
+    MHZ19_RESULT setRange(MHZ19_RANGE range) {
+      static const uint16_t ppm[] = { 1000, 2000, 3000, 5000 };
+      return Command(0x99, ppm[range] >> 8, ppm[range] & 0xFF);
+    }
+    int getCO2() { return co2; }
+    int getTemperature() { return temperature; }
+
+  private:
+    static uint8_t Checksum(const uint8_t *frame) {
+      uint8_t sum = 0;
+      for (int i = 1; i < 8; i++) sum += frame[i];
+      return 0xFF - sum + 1;
+    }
+
+    MHZ19_RESULT Command(uint8_t command, uint8_t high, uint8_t low) {
+      uint8_t frame[9] = { 0xFF, 0x01, command, 0, 0, 0, high, low, 0 };
+      frame[8] = Checksum(frame);
+      while (port->available()) port->read();
+      port->write(frame, sizeof(frame));
+
+      unsigned long start = millis();
+      uint8_t received = 0;
+      while (received < sizeof(reply)) {
+        if ((uint32_t)(millis() - start) > MHZ19_TIMEOUT) return MHZ19_RESULT_ERR_TIMEOUT;
+        int c = port->read();
+        if (c < 0 || (received == 0 && c != 0xFF)) continue;
+        reply[received++] = c;
+      }
+      if (reply[1] != command)          return MHZ19_RESULT_ERR_SYNTAX;
+      if (reply[8] != Checksum(reply))  return MHZ19_RESULT_ERR_CRC;
+      return MHZ19_RESULT_OK;
+    }
+
+    Stream  *port;
+    uint8_t  reply[9];
+    int      co2 = 0, temperature = 0;
+};
+
+#endif
@@ -0,0 +1,36 @@
+/* *****************************************************************************
+
+   Copyright (C) 2022 P.A.G.M. Zengers
+
+   Runs the firmware on the host, see Native.h
+
+   This program is free software: you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation, either version 3 of the License, or
+   (at your option) any later version.
+
+ * ****************************************************************************/
+
+#include <Arduino.h>
+#include "Native.h"
+
+#ifndef PIO_UNIT_TESTING // The tests have their own main() and call setup() when they need it
+
+void setup();
+void loop();
+
+int main(int argc, char **argv) {
+/* *****************************************************************************
+   main
+
+   setup(), then loop() until the seconds of the first argument have passed
+   on the clock of millis(); without one it runs until stopped
+ * *****************************************************************************/
+  uint32_t seconds = argc > 1 ? strtoul(argv[1], NULL, 10) : 0;
+  setup();
+  while (seconds == 0 || millis() < seconds * 1000UL) loop();
+  Serial.flush();
+  return 0;
+}
+
+#endif
@@ -0,0 +1,102 @@
+/*
+ * Controls of the native env, the firmware built for the host with the
+ * stand-ins of this library in place of the Arduino core and the libraries
+ * of the device. Tests and the host runs use these to look at the emulated
+ * panel and to set up the stand-in server, the sensor and the network.
+ *
+ * The clock is real time plus every delay: delay() moves millis() on at
+ * once, so the fixed waits of setup() cost nothing on the host.
+ *
+ * The panel is a GC9A01 of 240x240 pixels. It decodes what reaches it over
+ * SPI, from the Waveshare driver, and what TFT_eSPI sends, as the commands
+ * and data bytes TFT_eSPI would send: CASET, RASET and RAMWR with their
+ * 8 bytes for a window and two bytes per pixel. Text is drawn with the
+ * Waveshare fonts in place of the TFT_eSPI ones, so the pixels of text
+ * are not those of the device; everything else is drawn as TFT_eSPI does.
+ * The panel counts the writes of every pixel as well, for an overdraw
+ * heatmap at the resolution of the pixels (see the native_heatmap env).
+ *
+ * The stand-in server answers the HTTPS fetches from the recordings in
+ * data/replay (see Replay.h for the format), without TLS: the BearSSL calls
+ * the fetch makes behave as a server with the knobs of Native_Server would
+ * make them. The MH-Z19B answers the read and range commands over
+ * SoftwareSerial at 9600 baud. LittleFS is the directory in NATIVE_FS,
+ * data by default, and the RTC memory is kept in a file in there.
+ */
+#ifndef NATIVE_H
+#define NATIVE_H
+
+#include <stdint.h>
+
+#define NATIVE_PANEL_WIDTH         240
+#define NATIVE_PANEL_HEIGHT        240
+#define NATIVE_PANEL_CS            16    // D0
+#define NATIVE_PANEL_DC            0     // D3
+#define NATIVE_FS_DEFAULT          "data"
+#define NATIVE_RTC_FILE            "/.rtc"
+#define NATIVE_SDK_FILE            "/.sdk_wifi" // Station config of the SDK, see user_interface.h
+#define NATIVE_BR_ERR_TOO_LARGE    6     // BearSSL; a record did not fit the receive buffer
+
+struct Native_Server {
+  bool     mfln = true;                  // Accepts MFLN when probed
+  bool     mfln_dropped = false;         // but not on the connects after the probe
+  uint8_t  refuse = 0;                   // Connects to refuse before one gets through
+  bool     not_modified = true;          // 304 when If-None-Match has the ETag of the recording
+  bool     gzip = true;                  // Sends the gzip recordings when asked for; plain only when false
+  bool     chunked = false;              // Send the body with chunked transfer encoding
+  bool     truncate = false;             // Close the connection halfway the body
+  uint32_t reset = 0;                    // Reset the connection after this many bytes of the response, 0 never
+  uint32_t latency_ms = 150;             // From the request until the first byte
+  uint32_t bandwidth = 0;                // Bytes per second, 0 is as fast as we read
+
+  uint32_t connects = 0;                 // What the server saw
+  uint32_t refused = 0;
+  uint32_t probes = 0;
+  uint32_t requests = 0;
+  uint32_t answered_304 = 0;
+  uint32_t resets = 0;
+  uint32_t sent = 0;                     // Bytes
+};
+
+struct Native_Sensor {
+  bool     present = true;               // Answers at all
+  int      ppm = 450;
+  int      temperature = 21;             // Celsius
+  uint8_t  bad_checksums = 0;            // Replies to send with a bad checksum
+  uint8_t  noise = 0;                    // Bytes of noise before each reply
+  uint32_t reply_ms = 2;                 // From the command until the first byte
+
+  uint32_t commands = 0;                 // What the sensor saw
+  uint32_t bad_commands = 0;
+};
+
+struct Native_WiFi {
+  const char *ssid = "native";
+  uint32_t    connect_ms = 3500;         // Scan, association and DHCP; made up, not measured
+  uint32_t    fast_ms = 400;             // To a known BSSID and channel with static addresses; idem
+};
+
+extern Native_Server native_server;
+extern Native_Sensor native_sensor;
+extern Native_WiFi   native_wifi;
+
+// Panel
+void     Native_Panel_Command(uint8_t command);
+void     Native_Panel_Data(uint8_t data);
+void     Native_Panel_Window(int32_t x0, int32_t y0, int32_t x1, int32_t y1);
+void     Native_Panel_Pixels(uint16_t color, uint32_t count);
+uint16_t Native_Panel_Pixel(int32_t x, int32_t y);
+void     Native_Panel_Writes_Clear();    // Count the writes per pixel from here on
+uint16_t Native_Panel_Writes(int32_t x, int32_t y);
+uint32_t Native_Panel_Hash();            // FNV-1a of the pixels
+uint32_t Native_Panel_Bytes();           // Over SPI since the start
+bool     Native_Panel_Save(const char *path); // As a PPM image
+bool     Native_Panel_Save_Heatmap(const char *path); // The writes per pixel as a PPM image
+
+// Host
+const char *Native_Path(const char *path, char *buffer, size_t size); // LittleFS path on the host
+uint8_t  Native_Pin(uint8_t pin);        // Level written to the pin
+uint32_t Native_Real_Millis();           // Without the delays
+void     Native_Clock_Set(uint32_t ms);  // Move millis() to ms
+
+#endif
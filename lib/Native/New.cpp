@@ -0,0 +1,45 @@
+/* *****************************************************************************
+
+   Copyright (C) 2022 P.A.G.M. Zengers
+
+   operator new and delete of the native env. The String of the host is a
+   std::string, which allocates with operator new inside libstdc++; the
+   -Wl,--wrap=malloc of Alloc.h only sees calls to malloc from our own
+   objects. These replace the ones of libstdc++ for the whole program and
+   call malloc from here, so with the wrap every allocation is counted, as
+   on the device. See the native_alloc env
+
+   This program is free software: you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation, either version 3 of the License, or
+   (at your option) any later version.
+
+ * ****************************************************************************/
+
+#include <stdlib.h>
+#include <new>
+
+void *operator new(size_t size) {
+  void *p = malloc(size ? size : 1);
+  if (p == NULL) throw std::bad_alloc();
+  return p;
+}
+
+void *operator new[](size_t size) {
+  return operator new(size);
+}
+
+void *operator new(size_t size, const std::nothrow_t &) noexcept {
+  return malloc(size ? size : 1);
+}
+
+void *operator new[](size_t size, const std::nothrow_t &) noexcept {
+  return malloc(size ? size : 1);
+}
+
+void operator delete(void *p) noexcept                 { free(p); }
+void operator delete[](void *p) noexcept               { free(p); }
+void operator delete(void *p, size_t) noexcept         { free(p); }
+void operator delete[](void *p, size_t) noexcept       { free(p); }
+void operator delete(void *p, const std::nothrow_t &) noexcept   { free(p); }
+void operator delete[](void *p, const std::nothrow_t &) noexcept { free(p); }
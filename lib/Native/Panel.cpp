@@ -0,0 +1,170 @@
+/* *****************************************************************************
+
+   Copyright (C) 2022 P.A.G.M. Zengers
+
+   The emulated GC9A01 panel of the native env, see Native.h
+
+   This program is free software: you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation, either version 3 of the License, or
+   (at your option) any later version.
+
+ * ****************************************************************************/
+
+#include <SPI.h>
+#include <string.h>
+#include "Native.h"
+
+#define PANEL_CASET                0x2A  // Column address set
+#define PANEL_RASET                0x2B  // Row address set
+#define PANEL_RAMWR                0x2C  // Memory write, pixels follow
+
+SPIClass SPI;
+
+static uint16_t panel_pixels[NATIVE_PANEL_WIDTH * NATIVE_PANEL_HEIGHT];
+static uint16_t panel_writes[NATIVE_PANEL_WIDTH * NATIVE_PANEL_HEIGHT]; // Per pixel, since Native_Panel_Writes_Clear
+static uint16_t panel_window[2][2] = { { 0, NATIVE_PANEL_WIDTH - 1 }, { 0, NATIVE_PANEL_HEIGHT - 1 } };
+static uint8_t  panel_command = 0,
+                panel_params[4],
+                panel_param_count = 0,
+                panel_high;              // First byte of a pixel
+static bool     panel_have_high = false;
+static uint16_t panel_x, panel_y;        // Next pixel of RAMWR
+static uint32_t panel_bytes = 0;
+
+uint8_t SPIClass::transfer(uint8_t data) {
+  if (Native_Pin(NATIVE_PANEL_CS) != LOW) return 0;
+  if (Native_Pin(NATIVE_PANEL_DC) == LOW) Native_Panel_Command(data);
+  else                                    Native_Panel_Data(data);
+  return 0;
+}
+
+void Native_Panel_Command(uint8_t command) {
+  panel_bytes++;
+  panel_command     = command;
+  panel_param_count = 0;
+  panel_have_high   = false;
+  if (command == PANEL_RAMWR) {
+    panel_x = panel_window[0][0];
+    panel_y = panel_window[1][0];
+  }
+}
+
+void Native_Panel_Data(uint8_t data) {
+/* *****************************************************************************
+   Native_Panel_Data
+
+   A data byte: a parameter of the address window, or half a pixel. Pixels
+   fill the window row by row, and start at the top again when it is full
+ * *****************************************************************************/
+  panel_bytes++;
+  if (panel_command == PANEL_CASET || panel_command == PANEL_RASET) {
+    if (panel_param_count == 4) return;
+    panel_params[panel_param_count++] = data;
+    if (panel_param_count == 4) {
+      uint16_t *set = panel_window[panel_command - PANEL_CASET];
+      set[0] = panel_params[0] << 8 | panel_params[1];
+      set[1] = panel_params[2] << 8 | panel_params[3];
+    }
+    return;
+  }
+  if (panel_command != PANEL_RAMWR) return; // Set up of the panel, nothing we show
+
+  if (!panel_have_high) {
+    panel_high = data;
+    panel_have_high = true;
+    return;
+  }
+  panel_have_high = false;
+  if (panel_x < NATIVE_PANEL_WIDTH && panel_y < NATIVE_PANEL_HEIGHT) {
+    uint32_t i = panel_y * NATIVE_PANEL_WIDTH + panel_x;
+    panel_pixels[i] = panel_high << 8 | data;
+    if (panel_writes[i] < UINT16_MAX) panel_writes[i]++;
+  }
+  if (++panel_x > panel_window[0][1]) {
+    panel_x = panel_window[0][0];
+    if (++panel_y > panel_window[1][1]) panel_y = panel_window[1][0];
+  }
+}
+
+void Native_Panel_Window(int32_t x0, int32_t y0, int32_t x1, int32_t y1) {
+  Native_Panel_Command(PANEL_CASET);
+  Native_Panel_Data(x0 >> 8);
+  Native_Panel_Data(x0);
+  Native_Panel_Data(x1 >> 8);
+  Native_Panel_Data(x1);
+  Native_Panel_Command(PANEL_RASET);
+  Native_Panel_Data(y0 >> 8);
+  Native_Panel_Data(y0);
+  Native_Panel_Data(y1 >> 8);
+  Native_Panel_Data(y1);
+  Native_Panel_Command(PANEL_RAMWR);
+}
+
+void Native_Panel_Pixels(uint16_t color, uint32_t count) {
+  while (count--) {
+    Native_Panel_Data(color >> 8);
+    Native_Panel_Data(color);
+  }
+}
+
+uint16_t Native_Panel_Pixel(int32_t x, int32_t y) {
+  if (x < 0 || y < 0 || x >= NATIVE_PANEL_WIDTH || y >= NATIVE_PANEL_HEIGHT) return 0;
+  return panel_pixels[y * NATIVE_PANEL_WIDTH + x];
+}
+
+void Native_Panel_Writes_Clear() {
+  memset(panel_writes, 0, sizeof(panel_writes));
+}
+
+uint16_t Native_Panel_Writes(int32_t x, int32_t y) {
+  if (x < 0 || y < 0 || x >= NATIVE_PANEL_WIDTH || y >= NATIVE_PANEL_HEIGHT) return 0;
+  return panel_writes[y * NATIVE_PANEL_WIDTH + x];
+}
+
+uint32_t Native_Panel_Hash() {
+  uint32_t hash = 2166136261UL;
+  for (uint32_t i = 0; i < NATIVE_PANEL_WIDTH * NATIVE_PANEL_HEIGHT; i++) {
+    hash = (hash ^ panel_pixels[i]) * 16777619UL; // FNV-1a, a pixel at a time
+  }
+  return hash;
+}
+
+uint32_t Native_Panel_Bytes() {
+  return panel_bytes;
+}
+
+bool Native_Panel_Save(const char *path) {
+  FILE *file = fopen(path, "wb");
+  if (!file) return false;
+  fprintf(file, "P6\n%d %d\n255\n", NATIVE_PANEL_WIDTH, NATIVE_PANEL_HEIGHT);
+  for (uint32_t i = 0; i < NATIVE_PANEL_WIDTH * NATIVE_PANEL_HEIGHT; i++) {
+    uint16_t pixel = panel_pixels[i];
+    uint8_t  red = pixel >> 11, green = (pixel >> 5) & 0x3F, blue = pixel & 0x1F;
+    uint8_t  rgb[3] = { (uint8_t)(red << 3 | red >> 2), (uint8_t)(green << 2 | green >> 4), (uint8_t)(blue << 3 | blue >> 2) };
+    fwrite(rgb, 1, sizeof(rgb), file);
+  }
+  return fclose(file) == 0;
+}
+
+bool Native_Panel_Save_Heatmap(const char *path) {
+/* *****************************************************************************
+   Native_Panel_Save_Heatmap
+
+   The writes per pixel as a PPM image: black is never written, written once
+   is blue, going to red at four times or more; as ScreenStats_Heatmap_SVG
+ * *****************************************************************************/
+  FILE *file = fopen(path, "wb");
+  if (!file) return false;
+  fprintf(file, "P6\n%d %d\n255\n", NATIVE_PANEL_WIDTH, NATIVE_PANEL_HEIGHT);
+  for (uint32_t i = 0; i < NATIVE_PANEL_WIDTH * NATIVE_PANEL_HEIGHT; i++) {
+    uint8_t rgb[3] = { 0, 0, 0 };
+    if (panel_writes[i] > 0) {
+      uint8_t heat = panel_writes[i] > 4 ? 3 : panel_writes[i] - 1; // 0 .. 3
+      rgb[0] = heat * 85;
+      rgb[2] = 255 - heat * 85;
+    }
+    fwrite(rgb, 1, sizeof(rgb), file);
+  }
+  return fclose(file) == 0;
+}
@@ -0,0 +1,39 @@
+/*
+ * SPI for the host. What is sent while the panel is selected goes to the
+ * emulated panel, as a command or as data by the level of its DC pin
+ */
+#ifndef NATIVE_SPI_H
+#define NATIVE_SPI_H
+
+#include <Arduino.h>
+
+#define SPI_MODE0                  0x00
+#define SPI_MODE1                  0x01
+#define SPI_MODE2                  0x10
+#define SPI_MODE3                  0x11
+#define LSBFIRST                   0
+#define MSBFIRST                   1
+#define SPI_CLOCK_DIV2             0x00101001
+
+class SPISettings {
+  public:
+    SPISettings(uint32_t clock = 1000000, uint8_t bit_order = MSBFIRST, uint8_t data_mode = SPI_MODE0) {}
+};
+
+class SPIClass {
+  public:
+    void     begin() {}
+    void     end() {}
+    void     setDataMode(uint8_t mode) {}
+    void     setBitOrder(uint8_t order) {}
+    void     setClockDivider(uint32_t divider) {}
+    void     setFrequency(uint32_t frequency) {}
+    void     beginTransaction(SPISettings settings) {}
+    void     endTransaction() {}
+    uint8_t  transfer(uint8_t data);
+    uint16_t transfer16(uint16_t data) { transfer(data >> 8); transfer(data); return 0; }
+};
+
+extern SPIClass SPI;
+
+#endif
@@ -0,0 +1,102 @@
+/* *****************************************************************************
+
+   Copyright (C) 2022 P.A.G.M. Zengers
+
+   The emulated MH-Z19B of the native env, see SoftwareSerial.h
+
+   This program is free software: you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation, either version 3 of the License, or
+   (at your option) any later version.
+
+ * ****************************************************************************/
+
+#include <SoftwareSerial.h>
+#include "Native.h"
+
+#define SENSOR_FRAME               9
+#define SENSOR_START               0xFF
+#define SENSOR_READ                0x86
+#define SENSOR_RANGE               0x99
+#define SENSOR_BYTE_US             1042  // 10 bits at 9600 baud
+#define SENSOR_NOISE               0x5A
+
+Native_Sensor native_sensor;
+
+static uint8_t Sensor_Checksum(const uint8_t *frame) {
+  uint8_t sum = 0;
+  for (int i = 1; i < SENSOR_FRAME - 1; i++) sum += frame[i];
+  return 0xFF - sum + 1;
+}
+
+size_t SoftwareSerial::write(uint8_t c) {
+  if (command_length == 0 && c != SENSOR_START) return 1; // Not the start of a command
+  command[command_length++] = c;
+  if (command_length == SENSOR_FRAME) {
+    command_length = 0;
+    Reply(command);
+  }
+  return 1;
+}
+
+void SoftwareSerial::Reply(const uint8_t *command) {
+/* *****************************************************************************
+   SoftwareSerial::Reply
+
+   Queue the answer of the sensor to a command, with the noise and bad
+   checksums native_sensor asks for. Commands it does not know, or with a
+   bad checksum, go unanswered as on the sensor
+ * *****************************************************************************/
+  native_sensor.commands++;
+  if (command[SENSOR_FRAME - 1] != Sensor_Checksum(command) ||
+      (command[2] != SENSOR_READ && command[2] != SENSOR_RANGE)) {
+    native_sensor.bad_commands++;
+    return;
+  }
+  if (!native_sensor.present) return;
+
+  uint8_t reply[SENSOR_FRAME] = { SENSOR_START, command[2], 0, 0, 0, 0, 0, 0, 0 };
+  if (command[2] == SENSOR_READ) {
+    reply[2] = native_sensor.ppm >> 8;
+    reply[3] = native_sensor.ppm;
+    reply[4] = native_sensor.temperature + 40;
+  }
+  reply[SENSOR_FRAME - 1] = Sensor_Checksum(reply);
+  if (native_sensor.bad_checksums > 0) {
+    native_sensor.bad_checksums--;
+    reply[SENSOR_FRAME - 1]++;
+  }
+
+  uint32_t at = micros() + native_sensor.reply_ms * 1000;
+  if (received_count > 0) {
+    const Byte &last = received[(received_first + received_count - 1) % NATIVE_SERIAL_BUFFER];
+    if ((int32_t)(last.at - at) > 0) at = last.at;
+  }
+  for (uint8_t i = 0; i < native_sensor.noise; i++) Receive(SENSOR_NOISE, at += SENSOR_BYTE_US);
+  for (uint8_t i = 0; i < SENSOR_FRAME; i++)        Receive(reply[i], at += SENSOR_BYTE_US);
+}
+
+void SoftwareSerial::Receive(uint8_t value, uint32_t at) {
+  if (received_count == NATIVE_SERIAL_BUFFER) return; // Overflow, lost
+  received[(received_first + received_count++) % NATIVE_SERIAL_BUFFER] = { value, at };
+}
+
+int SoftwareSerial::available() {
+  uint32_t now = micros();
+  int count = 0;
+  while (count < received_count &&
+         (int32_t)(now - received[(received_first + count) % NATIVE_SERIAL_BUFFER].at) >= 0) count++;
+  return count;
+}
+
+int SoftwareSerial::read() {
+  if (available() == 0) return -1;
+  uint8_t c = received[received_first].value;
+  received_first = (received_first + 1) % NATIVE_SERIAL_BUFFER;
+  received_count--;
+  return c;
+}
+
+int SoftwareSerial::peek() {
+  return available() > 0 ? received[received_first].value : -1;
+}
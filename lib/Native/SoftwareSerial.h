@@ -0,0 +1,41 @@
+/*
+ * SoftwareSerial for the host, with the MH-Z19B of native_sensor on the
+ * other end (see Native.h). It takes the 9 byte commands written to it and
+ * answers read (0x86) and range (0x99); the reply starts native_sensor.
+ * reply_ms after the command and comes in at 9600 baud, about 1.04 ms a
+ * byte, by micros(). The bytes wait in a fixed buffer of the size of the
+ * one of EspSoftwareSerial; what does not fit is lost, as on the device.
+ */
+#ifndef NATIVE_SOFTWARESERIAL_H
+#define NATIVE_SOFTWARESERIAL_H
+
+#include <Arduino.h>
+
+#define NATIVE_SERIAL_BUFFER       64    // Receive buffer of EspSoftwareSerial
+
+class SoftwareSerial : public Stream {
+  public:
+    SoftwareSerial(int8_t rx, int8_t tx) {}
+    void   begin(unsigned long baud) {}
+    void   end() {}
+    int    available() override;
+    int    read() override;
+    int    peek() override;
+    size_t write(uint8_t c) override;
+    using  Print::write;
+
+  private:
+    void   Reply(const uint8_t *command);
+    void   Receive(uint8_t value, uint32_t at);
+
+    struct Byte {
+      uint8_t  value;
+      uint32_t at;                       // micros() it has arrived
+    };
+    Byte             received[NATIVE_SERIAL_BUFFER];
+    uint8_t          received_first = 0, received_count = 0;
+    uint8_t          command[9];
+    uint8_t          command_length = 0;
+};
+
+#endif
@@ -0,0 +1,276 @@
+/* *****************************************************************************
+
+   Copyright (C) 2022 P.A.G.M. Zengers
+
+   TFT_eSPI on the emulated panel of the native env, see TFT_eSPI.h
+
+   This program is free software: you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation, either version 3 of the License, or
+   (at your option) any later version.
+
+ * ****************************************************************************/
+
+#include <TFT_eSPI.h>
+#include "fonts.h"
+#include "Native.h"
+
+#define PANEL_SLPOUT               0x11  // Sleep out
+#define PANEL_DISPON               0x29  // Display on
+
+TFT_eSPI::TFT_eSPI(int16_t width, int16_t height) : panel_width(width), panel_height(height) {
+}
+
+void TFT_eSPI::init() {
+  Native_Panel_Command(PANEL_SLPOUT);
+  Native_Panel_Command(PANEL_DISPON);
+}
+
+bool TFT_eSPI::Clip(int32_t &x, int32_t &y, int32_t &w, int32_t &h) {
+  if (x < 0) { w += x; x = 0; }
+  if (y < 0) { h += y; y = 0; }
+  if (x + w > panel_width)  w = panel_width - x;
+  if (y + h > panel_height) h = panel_height - y;
+  return w > 0 && h > 0;
+}
+
+void TFT_eSPI::drawPixel(int32_t x, int32_t y, uint32_t color) {
+  if (x < 0 || y < 0 || x >= panel_width || y >= panel_height) return;
+  Native_Panel_Window(x, y, x, y);
+  Native_Panel_Pixels(color, 1);
+}
+
+void TFT_eSPI::drawFastHLine(int32_t x, int32_t y, int32_t w, uint32_t color) {
+  int32_t h = 1;
+  if (!Clip(x, y, w, h)) return;
+  Native_Panel_Window(x, y, x + w - 1, y);
+  Native_Panel_Pixels(color, w);
+}
+
+void TFT_eSPI::drawFastVLine(int32_t x, int32_t y, int32_t h, uint32_t color) {
+  int32_t w = 1;
+  if (!Clip(x, y, w, h)) return;
+  Native_Panel_Window(x, y, x, y + h - 1);
+  Native_Panel_Pixels(color, h);
+}
+
+void TFT_eSPI::fillRect(int32_t x, int32_t y, int32_t w, int32_t h, uint32_t color) {
+  if (!Clip(x, y, w, h)) return;
+  Native_Panel_Window(x, y, x + w - 1, y + h - 1);
+  Native_Panel_Pixels(color, w * h);
+}
+
+void TFT_eSPI::drawRect(int32_t x, int32_t y, int32_t w, int32_t h, uint32_t color) {
+  drawFastHLine(x, y, w, color);
+  drawFastHLine(x, y + h - 1, w, color);
+  drawFastVLine(x, y + 1, h - 2, color); // Not the corners again
+  drawFastVLine(x + w - 1, y + 1, h - 2, color);
+}
+
+void TFT_eSPI::drawLine(int32_t x0, int32_t y0, int32_t x1, int32_t y1, uint32_t color) {
+/* *****************************************************************************
+   TFT_eSPI::drawLine
+
+   Bresenham, sending the straight runs of the line as fast lines
+ * *****************************************************************************/
+  bool steep = abs(y1 - y0) > abs(x1 - x0);
+  if (steep) {
+    std::swap(x0, y0);
+    std::swap(x1, y1);
+  }
+  if (x0 > x1) {
+    std::swap(x0, x1);
+    std::swap(y0, y1);
+  }
+
+  int32_t dx = x1 - x0, dy = abs(y1 - y0);
+  int32_t err = dx >> 1, ystep = y0 < y1 ? 1 : -1, xs = x0, dlen = 0;
+  for (; x0 <= x1; x0++) {
+    dlen++;
+    err -= dy;
+    if (err < 0) {
+      if (dlen == 1) steep ? drawPixel(y0, xs, color) : drawPixel(xs, y0, color);
+      else           steep ? drawFastVLine(y0, xs, dlen, color) : drawFastHLine(xs, y0, dlen, color);
+      dlen = 0;
+      y0 += ystep;
+      xs = x0 + 1;
+      err += dx;
+    }
+  }
+  if (dlen) steep ? drawFastVLine(y0, xs, dlen, color) : drawFastHLine(xs, y0, dlen, color);
+}
+
+void TFT_eSPI::fillTriangle(int32_t x0, int32_t y0, int32_t x1, int32_t y1, int32_t x2, int32_t y2, uint32_t color) {
+/* *****************************************************************************
+   TFT_eSPI::fillTriangle
+
+   A fast line per row, from the crossings with the edges
+ * *****************************************************************************/
+  if (y0 > y1) { std::swap(y0, y1); std::swap(x0, x1); } // Sort by y
+  if (y1 > y2) { std::swap(y2, y1); std::swap(x2, x1); }
+  if (y0 > y1) { std::swap(y0, y1); std::swap(x0, x1); }
+
+  if (y0 == y2) { // All on one row
+    int32_t a = std::min(x0, std::min(x1, x2)), b = std::max(x0, std::max(x1, x2));
+    drawFastHLine(a, y0, b - a + 1, color);
+    return;
+  }
+
+  int32_t dx01 = x1 - x0, dy01 = y1 - y0, dx02 = x2 - x0, dy02 = y2 - y0, dx12 = x2 - x1, dy12 = y2 - y1;
+  int32_t sa = 0, sb = 0, y, last = (y1 == y2) ? y1 : y1 - 1;
+  for (y = y0; y <= last; y++) { // Upper part, edges 0-1 and 0-2
+    int32_t a = x0 + sa / dy01, b = x0 + sb / dy02;
+    sa += dx01;
+    sb += dx02;
+    if (a > b) std::swap(a, b);
+    drawFastHLine(a, y, b - a + 1, color);
+  }
+  sa = dx12 * (y - y1);
+  sb = dx02 * (y - y0);
+  for (; y <= y2; y++) { // Lower part, edges 1-2 and 0-2
+    int32_t a = x1 + sa / dy12, b = x0 + sb / dy02;
+    sa += dx12;
+    sb += dx02;
+    if (a > b) std::swap(a, b);
+    drawFastHLine(a, y, b - a + 1, color);
+  }
+}
+
+void TFT_eSPI::pushImage(int32_t x, int32_t y, int32_t w, int32_t h, const uint16_t *data) {
+  int32_t dx = x < 0 ? -x : 0, dy = y < 0 ? -y : 0, cw = w, ch = h;
+  if (!Clip(x, y, cw, ch)) return;
+  Native_Panel_Window(x, y, x + cw - 1, y + ch - 1);
+  for (int32_t row = 0; row < ch; row++) {
+    for (int32_t col = 0; col < cw; col++) Native_Panel_Pixels(pgm_read_word(data + (row + dy) * w + col + dx), 1);
+  }
+}
+
+/* *****************************************************************************
+   Text
+ * ****************************************************************************/
+
+static const sFONT *Font(uint8_t font) {
+  switch (font) {
+    case 1:  return &Font8;
+    case 4:
+    case 6:  return &Font24;
+    default: return &Font16;
+  }
+}
+
+static int16_t Font_Width(uint8_t font) {
+  switch (font) {
+    case 1:  return 6;
+    case 6:  return 2 * Font24.Width;
+    default: return Font(font)->Width;
+  }
+}
+
+int16_t TFT_eSPI::fontHeight(int16_t font) {
+  switch (font) {
+    case 1:  return 8 * textsize;
+    case 4:  return 26 * textsize;
+    case 6:  return 48 * textsize;
+    default: return 16 * textsize;
+  }
+}
+
+int16_t TFT_eSPI::textWidth(const char *string, uint8_t font) {
+  int16_t width = 0;
+  for (; *string; string++) {
+    uint8_t c = *string;
+    if (font == 1 || (c >= 32 && c <= 127)) width += Font_Width(font) * textsize;
+  }
+  return width;
+}
+
+void TFT_eSPI::Glyph(int32_t x, int32_t y, uint16_t c, uint8_t font, uint8_t scale, int32_t w, int32_t h, uint32_t color, uint32_t bg) {
+/* *****************************************************************************
+   TFT_eSPI::Glyph
+
+   Draw c in a cell of w by h font pixels, each scale by scale. With a
+   background in one window, otherwise only the pixels of the glyph
+ * *****************************************************************************/
+  const sFONT *source = Font(font);
+  uint8_t  zoom = (font == 6) ? 2 : 1;             // Font pixels per pixel of the source
+  int32_t  top  = (font == 4) ? 1 : 0;             // Font24 in the 26 pixel line of font 4
+  uint16_t row_bytes = (source->Width + 7) / 8;
+  const uint8_t *glyph = (c >= ' ' && c <= '~') ? source->table + (c - ' ') * source->Height * row_bytes : NULL;
+
+  auto on = [&](int32_t col, int32_t row) {
+    col /= zoom;
+    row = row / zoom - top;
+    if (glyph == NULL || col >= source->Width || row < 0 || row >= source->Height) return false;
+    return (pgm_read_byte(glyph + row * row_bytes + col / 8) & (0x80 >> (col % 8))) != 0;
+  };
+
+  if (bg != color) {
+    int32_t cx = x, cy = y, cw = w * scale, ch = h * scale;
+    if (!Clip(cx, cy, cw, ch)) return;
+    Native_Panel_Window(cx, cy, cx + cw - 1, cy + ch - 1);
+    for (int32_t py = cy; py < cy + ch; py++) {
+      for (int32_t px = cx; px < cx + cw; px++) Native_Panel_Pixels(on((px - x) / scale, (py - y) / scale) ? color : bg, 1);
+    }
+    return;
+  }
+  for (int32_t row = 0; row < h; row++) {
+    for (int32_t col = 0; col < w; col++) {
+      if (!on(col, row)) continue;
+      if (scale == 1) drawPixel(x + col, y + row, color);
+      else            fillRect(x + col * scale, y + row * scale, scale, scale, color);
+    }
+  }
+}
+
+void TFT_eSPI::drawChar(int32_t x, int32_t y, uint16_t c, uint32_t color, uint32_t bg, uint8_t size) {
+  if (x >= panel_width || y >= panel_height || x + 6 * size - 1 < 0 || y + 8 * size - 1 < 0) return;
+  Glyph(x, y, c, 1, size, 6, 8, color, bg);
+}
+
+int16_t TFT_eSPI::drawChar(uint16_t uniCode, int32_t x, int32_t y, uint8_t font) {
+  if (font == 1) {
+    drawChar(x, y, uniCode, textcolor, textbgcolor, textsize);
+    return 6 * textsize;
+  }
+  if (uniCode < 32 || uniCode > 127) return 0;
+  int16_t width = Font_Width(font);
+  Glyph(x, y, uniCode, font, textsize, width, fontHeight(font) / textsize, textcolor, textbgcolor);
+  return width * textsize;
+}
+
+int16_t TFT_eSPI::drawString(const char *string, int32_t x, int32_t y, uint8_t font) {
+  int16_t width = textWidth(string, font);
+  if (textdatum == TC_DATUM) x -= width / 2;
+  if (textdatum == TR_DATUM) x -= width;
+  for (; *string; string++) x += drawChar((uint8_t)*string, x, y, font);
+  return width;
+}
+
+int16_t TFT_eSPI::drawCentreString(const char *string, int32_t x, int32_t y, uint8_t font) {
+  uint8_t datum = textdatum;
+  textdatum = TC_DATUM;
+  int16_t width = drawString(string, x, y, font);
+  textdatum = datum;
+  return width;
+}
+
+size_t TFT_eSPI::write(uint8_t c) {
+/* *****************************************************************************
+   TFT_eSPI::write
+
+   print() at the cursor, wrapping at the right edge
+ * *****************************************************************************/
+  if (c >= 0x80 || c == '\r') return 1; // UTF-8, see TFT_eSPI.h
+  if (c == '\n') {
+    cursor_x = 0;
+    cursor_y += fontHeight(textfont);
+    return 1;
+  }
+  int16_t width = (textfont == 1 || (c >= 32 && c <= 127)) ? Font_Width(textfont) * textsize : 0;
+  if (textwrapX && cursor_x + width > panel_width) {
+    cursor_x = 0;
+    cursor_y += fontHeight(textfont);
+  }
+  cursor_x += drawChar(c, cursor_x, cursor_y, textfont);
+  return 1;
+}
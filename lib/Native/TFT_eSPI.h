@@ -0,0 +1,119 @@
+/*
+ * TFT_eSPI for the host, drawing on the emulated panel of Native.h. The
+ * calls the firmware makes send what TFT_eSPI sends for them: an address
+ * window and the pixels, with lines, rectangles and triangles split into
+ * the same fast lines and pixels. The methods TFT_eSPI has virtual are
+ * virtual here too, so TFT_Counted (see ScreenStats.h) sees the same calls.
+ *
+ * Text uses the Waveshare fonts (fonts.h): font 1 is Font8 in a 6x8 cell,
+ * font 2 Font16, font 4 Font24 in a 26 pixel line and font 6 Font24 at
+ * twice the size, each times the text size. Bytes of 0x80 and up are taken
+ * as UTF-8, which TFT_eSPI decodes by default, and not drawn.
+ */
+#ifndef NATIVE_TFT_ESPI_H
+#define NATIVE_TFT_ESPI_H
+
+#include <Arduino.h>
+
+#define TFT_WIDTH                  240
+#define TFT_HEIGHT                 240
+
+#define TFT_BLACK                  0x0000
+#define TFT_NAVY                   0x000F
+#define TFT_DARKGREEN              0x03E0
+#define TFT_DARKCYAN               0x03EF
+#define TFT_MAROON                 0x7800
+#define TFT_PURPLE                 0x780F
+#define TFT_OLIVE                  0x7BE0
+#define TFT_LIGHTGREY              0xD69A
+#define TFT_DARKGREY               0x7BEF
+#define TFT_BLUE                   0x001F
+#define TFT_GREEN                  0x07E0
+#define TFT_CYAN                   0x07FF
+#define TFT_RED                    0xF800
+#define TFT_MAGENTA                0xF81F
+#define TFT_YELLOW                 0xFFE0
+#define TFT_WHITE                  0xFFFF
+#define TFT_ORANGE                 0xFDA0
+#define TFT_GREENYELLOW            0xB7E0
+#define TFT_PINK                   0xFE19
+#define TFT_BROWN                  0x9A60
+#define TFT_GOLD                   0xFEA0
+#define TFT_SILVER                 0xC618
+#define TFT_SKYBLUE                0x867D
+#define TFT_VIOLET                 0x915C
+
+#define TL_DATUM                   0     // Text datums
+#define TC_DATUM                   1
+#define TR_DATUM                   2
+
+class TFT_eSPI : public Print {
+  public:
+    TFT_eSPI(int16_t width = TFT_WIDTH, int16_t height = TFT_HEIGHT);
+
+    void init();
+    void begin() { init(); }
+    void setRotation(uint8_t rotation) { this->rotation = rotation; }
+    uint8_t getRotation() { return rotation; }
+    virtual int16_t width()  { return panel_width; }
+    virtual int16_t height() { return panel_height; }
+    void startWrite() {}
+    void endWrite() {}
+    void setSwapBytes(bool swap) {}
+
+    virtual void drawPixel(int32_t x, int32_t y, uint32_t color);
+    virtual void drawChar(int32_t x, int32_t y, uint16_t c, uint32_t color, uint32_t bg, uint8_t size);
+    virtual int16_t drawChar(uint16_t uniCode, int32_t x, int32_t y, uint8_t font);
+    virtual int16_t drawChar(uint16_t uniCode, int32_t x, int32_t y) { return drawChar(uniCode, x, y, textfont); }
+    virtual void drawLine(int32_t xs, int32_t ys, int32_t xe, int32_t ye, uint32_t color);
+    virtual void drawFastVLine(int32_t x, int32_t y, int32_t h, uint32_t color);
+    virtual void drawFastHLine(int32_t x, int32_t y, int32_t w, uint32_t color);
+    virtual void fillRect(int32_t x, int32_t y, int32_t w, int32_t h, uint32_t color);
+
+    void fillScreen(uint32_t color) { fillRect(0, 0, panel_width, panel_height, color); }
+    void drawRect(int32_t x, int32_t y, int32_t w, int32_t h, uint32_t color);
+    void fillTriangle(int32_t x0, int32_t y0, int32_t x1, int32_t y1, int32_t x2, int32_t y2, uint32_t color);
+    void pushImage(int32_t x, int32_t y, int32_t w, int32_t h, const uint16_t *data);
+    void pushImage(int32_t x, int32_t y, int32_t w, int32_t h, uint16_t *data) { pushImage(x, y, w, h, (const uint16_t *)data); }
+
+    void    setCursor(int16_t x, int16_t y) { cursor_x = x; cursor_y = y; }
+    int16_t getCursorX() { return cursor_x; }
+    int16_t getCursorY() { return cursor_y; }
+    void    setTextColor(uint16_t color) { textcolor = textbgcolor = color; }
+    void    setTextColor(uint16_t color, uint16_t bg) { textcolor = color; textbgcolor = bg; }
+    void    setTextSize(uint8_t size) { textsize = size > 0 ? size : 1; }
+    void    setTextFont(uint8_t font) { textfont = font; }
+    void    setTextDatum(uint8_t datum) { textdatum = datum; }
+    void    setTextPadding(uint16_t width) {}
+    void    setTextWrap(bool wrap_x, bool wrap_y = false) { textwrapX = wrap_x; }
+    int16_t textWidth(const char *string, uint8_t font);
+    int16_t textWidth(const char *string) { return textWidth(string, textfont); }
+    int16_t textWidth(const String &string, uint8_t font) { return textWidth(string.c_str(), font); }
+    int16_t textWidth(const String &string) { return textWidth(string.c_str(), textfont); }
+    int16_t fontHeight(int16_t font);
+    int16_t fontHeight() { return fontHeight(textfont); }
+
+    int16_t drawString(const char *string, int32_t x, int32_t y, uint8_t font);
+    int16_t drawString(const char *string, int32_t x, int32_t y) { return drawString(string, x, y, textfont); }
+    int16_t drawString(const String &string, int32_t x, int32_t y, uint8_t font) { return drawString(string.c_str(), x, y, font); }
+    int16_t drawString(const String &string, int32_t x, int32_t y) { return drawString(string.c_str(), x, y, textfont); }
+    int16_t drawCentreString(const char *string, int32_t x, int32_t y, uint8_t font);
+    int16_t drawCentreString(const String &string, int32_t x, int32_t y, uint8_t font) { return drawCentreString(string.c_str(), x, y, font); }
+
+    size_t write(uint8_t c) override;
+    using  Print::write;
+
+    uint32_t textcolor = TFT_WHITE, textbgcolor = TFT_WHITE;
+    uint8_t  textfont = 1, textsize = 1, textdatum = TL_DATUM;
+    int32_t  cursor_x = 0, cursor_y = 0;
+    bool     textwrapX = true;
+
+  private:
+    bool Clip(int32_t &x, int32_t &y, int32_t &w, int32_t &h);
+    void Glyph(int32_t x, int32_t y, uint16_t c, uint8_t font, uint8_t scale, int32_t w, int32_t h, uint32_t color, uint32_t bg);
+
+    int16_t panel_width, panel_height;
+    uint8_t rotation = 0;
+};
+
+#endif
@@ -0,0 +1,214 @@
+/* *****************************************************************************
+
+   Copyright (C) 2022 P.A.G.M. Zengers
+
+   The stand-in HTTPS server of the native env, see WiFiClientSecure.h
+
+   This program is free software: you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation, either version 3 of the License, or
+   (at your option) any later version.
+
+ * ****************************************************************************/
+
+#include <WiFiClientSecure.h>
+#include <map>
+#include "Native.h"
+
+#define SERVER_DIR                 "/replay/"
+#define SERVER_SLOTS               4     // Recordings per host, REPLAY_FILES
+#define SERVER_MAGIC               0x524D5250 // Of a recording, see Replay.h
+#define SERVER_HEADER_SIZE         20
+#define SERVER_CHUNK_SIZE          500
+
+Native_Server native_server;
+
+static std::map<std::string, uint32_t> server_turns; // Answers per host, to go round the recordings
+
+static bool Server_Load(const std::string &host, uint8_t slot, std::string &response) {
+  char name[96], path[256];
+  snprintf(name, sizeof(name), SERVER_DIR "%s.%d", host.c_str(), slot);
+  FILE *file = fopen(Native_Path(name, path, sizeof(path)), "rb");
+  if (!file) return false;
+  uint32_t header[SERVER_HEADER_SIZE / 4];
+  bool ok = fread(header, 1, sizeof(header), file) == sizeof(header) && header[0] == SERVER_MAGIC;
+  if (ok) {
+    response.resize(header[1]);
+    ok = fread(&response[0], 1, response.size(), file) == response.size();
+  }
+  fclose(file);
+  return ok;
+}
+
+static std::string Server_Header(const std::string &headers, const char *name) {
+/* *****************************************************************************
+   Server_Header
+
+   Value of header name in the status line and headers, "" when not there
+ * *****************************************************************************/
+  size_t length = strlen(name);
+  for (size_t start = 0; start < headers.size();) {
+    size_t end = headers.find("\r\n", start);
+    if (end == std::string::npos) end = headers.size();
+    if (end - start > length && headers[start + length] == ':' && strncasecmp(headers.c_str() + start, name, length) == 0) {
+      size_t value = headers.find_first_not_of(' ', start + length + 1);
+      return headers.substr(value, end - value);
+    }
+    start = end + 2;
+  }
+  return "";
+}
+
+bool WiFiClientSecure::probeMaxFragmentLength(const char *host, uint16_t port, uint16_t length) {
+  native_server.probes++;
+  return native_server.mfln;
+}
+
+int WiFiClientSecure::getLastSSLError(char *text, size_t size) {
+  if (text && size) snprintf(text, size, "%s", last_error == NATIVE_BR_ERR_TOO_LARGE ? "record too large" : "");
+  return last_error;
+}
+
+int WiFiClientSecure::connect(const char *name, uint16_t port) {
+/* *****************************************************************************
+   WiFiClientSecure::connect
+
+   The TCP connect and the handshake. Refused while native_server.refuse
+   counts down; with small buffers only when the server takes MFLN now
+ * *****************************************************************************/
+  stop();
+  native_server.connects++;
+  last_error = 0;
+  mfln_negotiated = false;
+  if (native_server.refuse > 0) {
+    native_server.refuse--;
+    native_server.refused++;
+    return 0;
+  }
+  bool small = rx_buffer < NATIVE_MFLN_FULL_BUFFER;
+  bool mfln  = native_server.mfln && !native_server.mfln_dropped;
+  if (small && !mfln) {
+    last_error = NATIVE_BR_ERR_TOO_LARGE;
+    return 0;
+  }
+  mfln_negotiated = small;
+  host      = name;
+  open      = true;
+  answered  = false;
+  request.clear();
+  response.clear();
+  position  = 0;
+  reset     = 0;
+  return 1;
+}
+
+size_t WiFiClientSecure::write(const uint8_t *buffer, size_t size) {
+  if (!open) return 0;
+  request.append((const char *)buffer, size);
+  if (!answered && request.find("\r\n\r\n") != std::string::npos) Answer();
+  return size;
+}
+
+void WiFiClientSecure::Answer() {
+/* *****************************************************************************
+   WiFiClientSecure::Answer
+
+   Make up the response to the request: a recording of the host that fits
+   Accept-Encoding (plain only without native_server.gzip), going round the
+   ones that do; a 304 when If-None-Match has its ETag; then the faults of
+   the knobs
+ * *****************************************************************************/
+  answered  = true;
+  requested = millis();
+  reset     = native_server.reset;
+  native_server.requests++;
+  bool        gzip = native_server.gzip && Server_Header(request, "Accept-Encoding").find("gzip") != std::string::npos;
+  std::string etag = Server_Header(request, "If-None-Match");
+
+  std::string fits[SERVER_SLOTS], recording;
+  uint8_t     count = 0;
+  for (uint8_t slot = 0; slot < SERVER_SLOTS; slot++) {
+    if (!Server_Load(host, slot, recording)) continue;
+    bool zipped = Server_Header(recording.substr(0, recording.find("\r\n\r\n")), "Content-Encoding") == "gzip";
+    if (zipped == gzip) fits[count++] = recording;
+  }
+  if (count == 0) {
+    response = "HTTP/1.1 404 Not Found\r\nConnection: close\r\n\r\n";
+    return;
+  }
+  response = fits[server_turns[host]++ % count];
+
+  size_t      end     = response.find("\r\n\r\n");
+  std::string headers = response.substr(0, end == std::string::npos ? response.size() : end + 2);
+  std::string body    = end == std::string::npos ? "" : response.substr(end + 4);
+  std::string tag     = Server_Header(headers, "ETag");
+  if (native_server.not_modified && !etag.empty() && etag == tag) {
+    native_server.answered_304++;
+    response = "HTTP/1.1 304 Not Modified\r\nETag: " + tag + "\r\nConnection: close\r\n\r\n";
+    return;
+  }
+
+  if (native_server.chunked && Server_Header(headers, "Transfer-Encoding").empty()) {
+    std::string lines;
+    for (size_t start = 0; start < headers.size();) { // All but Content-Length, which chunks may not have
+      size_t stop = headers.find("\r\n", start) + 2;
+      if (strncasecmp(headers.c_str() + start, "Content-Length:", 15) != 0) lines += headers.substr(start, stop - start);
+      start = stop;
+    }
+    headers = lines + "Transfer-Encoding: chunked\r\n";
+    std::string chunks;
+    char size[16];
+    for (size_t start = 0; start < body.size(); start += SERVER_CHUNK_SIZE) {
+      std::string chunk = body.substr(start, SERVER_CHUNK_SIZE);
+      snprintf(size, sizeof(size), "%zx\r\n", chunk.size());
+      chunks += size + chunk + "\r\n";
+    }
+    body = chunks + "0\r\n\r\n";
+  }
+  if (native_server.truncate) body.resize(body.size() / 2); // Then Connection: close
+  response = headers + "\r\n" + body;
+}
+
+bool WiFiClientSecure::Open() {
+  if (open && answered && reset > 0 && position >= reset) {
+    open = false;
+    native_server.resets++;
+  }
+  return open;
+}
+
+uint8_t WiFiClientSecure::connected() {
+  return Open() && (!answered || position < response.size()); // Connection: close after the response
+}
+
+int WiFiClientSecure::available() {
+/* *****************************************************************************
+   WiFiClientSecure::available
+
+   Bytes arrived by now: none until the latency after the request, then at
+   the bandwidth of native_server
+ * *****************************************************************************/
+  if (!Open() || !answered || position >= response.size()) return 0;
+  uint32_t elapsed = millis() - requested;
+  if (elapsed < native_server.latency_ms) return 0;
+  size_t arrived = response.size();
+  if (native_server.bandwidth > 0) {
+    arrived = min(arrived, (size_t)((uint64_t)(elapsed - native_server.latency_ms) * native_server.bandwidth / 1000 + 1));
+  }
+  return arrived > position ? arrived - position : 0;
+}
+
+int WiFiClientSecure::read() {
+  if (available() <= 0) return -1;
+  native_server.sent++;
+  return (uint8_t)response[position++];
+}
+
+int WiFiClientSecure::peek() {
+  if (available() <= 0) return -1;
+  return (uint8_t)response[position];
+}
+
+void WiFiClientSecure::stop() {
+  open = false;
+}
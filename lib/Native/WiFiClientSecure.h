@@ -0,0 +1,56 @@
+/*
+ * WiFiClientSecure for the host: the client end of the stand-in server of
+ * Native.h. There is no TLS and no socket; connect() and the request decide
+ * what the server would answer, from the recordings in LittleFS/replay and
+ * the knobs of native_server, and read() hands out the bytes after the
+ * latency at the bandwidth of the knobs. A reset ends the connection at a
+ * byte of the response, headers included: nothing arrives after it.
+ *
+ * The BearSSL parts the fetch depends on behave as against a real server.
+ * probeMaxFragmentLength says what the server says to the probe. A connect
+ * with a receive buffer under NATIVE_MFLN_FULL_BUFFER asks for MFLN; when
+ * the server does not accept it then, its records do not fit and the
+ * connect fails with BR_ERR_TOO_LARGE as getLastSSLError. getMFLNStatus is
+ * whether the connection negotiated it.
+ */
+#ifndef NATIVE_WIFICLIENTSECURE_H
+#define NATIVE_WIFICLIENTSECURE_H
+
+#include <ESP8266WiFi.h>
+
+#define NATIVE_MFLN_FULL_BUFFER    16384 // A receive buffer for the largest TLS record
+
+class WiFiClientSecure : public WiFiClient {
+  public:
+    void    setInsecure() {}
+    void    setBufferSizes(int recv, int xmit) { rx_buffer = recv; }
+    bool    probeMaxFragmentLength(const char *host, uint16_t port, uint16_t length);
+    bool    getMFLNStatus() { return mfln_negotiated; }
+    int     getLastSSLError(char *text = NULL, size_t size = 0);
+
+    int     connect(const char *host, uint16_t port) override;
+    int     connect(IPAddress ip, uint16_t port) override { return 0; }
+    uint8_t connected() override;
+    void    stop() override;
+    int     available() override;
+    int     read() override;
+    int     peek() override;
+    size_t  write(const uint8_t *buffer, size_t size) override;
+    using   WiFiClient::write;
+
+  private:
+    void    Answer();
+    bool    Open();
+
+    int         rx_buffer = NATIVE_MFLN_FULL_BUFFER;
+    bool        mfln_negotiated = false;
+    int         last_error = 0;
+    bool        open = false;
+    std::string host, request, response;
+    bool        answered = false;
+    size_t      position = 0;            // Next byte of response
+    uint32_t    reset = 0;               // Byte of response to reset the connection at, 0 never
+    uint32_t    requested = 0;           // millis() the request was complete
+};
+
+#endif
@@ -0,0 +1,30 @@
+/*
+ * WiFiManager for the host. The access point of native_wifi is always the
+ * one saved, so autoConnect connects to it the normal way, without a scan
+ * result to go on, and never opens the portal.
+ */
+#ifndef NATIVE_WIFIMANAGER_H
+#define NATIVE_WIFIMANAGER_H
+
+#include <ESP8266WiFi.h>
+#include "Native.h"
+
+class WiFiManager {
+  public:
+    void   setAPCallback(void (*callback)(WiFiManager *)) {}
+    void   setDebugOutput(bool debug) {}
+    void   setConnectTimeout(unsigned long seconds) {}
+    String getConfigPortalSSID() { return portal_ssid; }
+
+    bool autoConnect(const char *name) {
+      portal_ssid = name;
+      WiFi.begin(native_wifi.ssid, "native");
+      while (WiFi.status() != WL_CONNECTED) delay(10);
+      return true;
+    }
+
+  private:
+    String portal_ssid;
+};
+
+#endif
@@ -0,0 +1,38 @@
+/*
+ * Flash access of the ESP8266 for the host, where everything is in RAM
+ */
+#ifndef NATIVE_PGMSPACE_H
+#define NATIVE_PGMSPACE_H
+
+#include <stdint.h>
+#include <string.h>
+#include <strings.h>
+#include <stdio.h>
+
+#define PROGMEM
+#define PGM_P                      const char *
+#define PSTR(s)                    (s)
+#define FPSTR(p)                   (reinterpret_cast<const __FlashStringHelper *>(p))
+
+#define pgm_read_byte(addr)        (*(const uint8_t *)(addr))
+#define pgm_read_word(addr)        (*(const uint16_t *)(addr))
+#define pgm_read_dword(addr)       (*(const uint32_t *)(addr))
+#define pgm_read_ptr(addr)         (*(void * const *)(addr))
+
+#define memcpy_P                   memcpy
+#define memcmp_P                   memcmp
+#define strlen_P                   strlen
+#define strcpy_P                   strcpy
+#define strncpy_P                  strncpy
+#define strcmp_P                   strcmp
+#define strncmp_P                  strncmp
+#define strcasecmp_P               strcasecmp
+#define strncasecmp_P              strncasecmp
+#define strstr_P                   strstr
+#define sprintf_P                  sprintf
+#define snprintf_P                 snprintf
+#define vsnprintf_P                vsnprintf
+
+class __FlashStringHelper;
+
+#endif
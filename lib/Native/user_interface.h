@@ -0,0 +1,31 @@
+/*
+ * The station config of the SDK, for the host. The SDK keeps the SSID and
+ * password of the last WiFi.begin made while persistent in its own sector of
+ * flash; here that is NATIVE_SDK_FILE in the LittleFS directory, so it
+ * survives a restart as on the device. Remove the file for a device that
+ * never connected.
+ */
+#ifndef NATIVE_USER_INTERFACE_H
+#define NATIVE_USER_INTERFACE_H
+
+#include <stdint.h>
+
+struct station_config {
+  uint8_t ssid[32];                      // Not terminated when 32 long
+  uint8_t password[64];                  // Idem
+  uint8_t bssid_set;
+  uint8_t bssid[6];
+};
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+bool wifi_station_get_config_default(struct station_config *config);
+bool wifi_station_set_config(struct station_config *config);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
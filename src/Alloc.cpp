@@ -0,0 +1,144 @@
+/* *****************************************************************************
+
+   Copyright (C) 2022 P.A.G.M. Zengers
+
+   Heap allocation tracker, see Alloc.h
+
+   This program is free software: you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation, either version 3 of the License, or
+   (at your option) any later version.
+
+ * ****************************************************************************/
+
+#include "Alloc.h"
+
+#if ALLOC_ENABLED
+
+#include "Log.h"
+
+static Alloc_Site  alloc_other = { "(no scope)", NULL, false, 0, 0, 0 };
+static Alloc_Site *alloc_sites = NULL;   // Newest site first
+static Alloc_Site *alloc_current = &alloc_other;
+static uint8_t     alloc_exempt = 0;     // Exempt scopes we are in
+static bool        alloc_steady = false;
+
+static uint32_t    alloc_total = 0,      // Since the start
+                   alloc_bytes = 0,      // Idem
+                   alloc_loop_start = 0, // alloc_total at the start of this iteration
+                   alloc_loop_max = 0,   // Most in one iteration
+                   alloc_loops = 0,
+                   alloc_failures = 0,   // In the steady state, not exempt
+                   alloc_reported = 0;   // alloc_failures already logged
+static const char *alloc_failed_in = NULL;
+
+static void Alloc_Count(size_t size) {
+/* *****************************************************************************
+   Alloc_Count
+
+   Account one allocation to the current scope. Called from within malloc, so
+   it must not allocate or log itself
+ * *****************************************************************************/
+  Alloc_Site *site = alloc_current;
+  if (site->count == 0) { // First one here, link it
+    site->next = alloc_sites;
+    alloc_sites = site;
+  }
+  site->count++;
+  site->bytes += size;
+  alloc_total++;
+  alloc_bytes += size;
+  if (alloc_steady && alloc_exempt == 0) {
+    site->steady++;
+    alloc_failures++;
+    alloc_failed_in = site->name;
+  }
+}
+
+extern "C" {
+void *__real_malloc(size_t size);
+void *__real_calloc(size_t count, size_t size);
+void *__real_realloc(void *ptr, size_t size);
+
+void *__wrap_malloc(size_t size) {
+  Alloc_Count(size);
+  return __real_malloc(size);
+}
+
+void *__wrap_calloc(size_t count, size_t size) {
+  Alloc_Count(count * size);
+  return __real_calloc(count, size);
+}
+
+void *__wrap_realloc(void *ptr, size_t size) {
+  if (size > 0) Alloc_Count(size); // Growing or shrinking, it may move
+  return __real_realloc(ptr, size);
+}
+}
+
+Alloc_Scope::Alloc_Scope(Alloc_Site &site) {
+  outer = alloc_current;
+  alloc_current = &site;
+  if (site.exempt) alloc_exempt++;
+}
+
+Alloc_Scope::~Alloc_Scope() {
+  if (alloc_current->exempt) alloc_exempt--;
+  alloc_current = outer;
+}
+
+void Alloc_Loop() {
+/* *****************************************************************************
+   Alloc_Loop
+
+   End of a loop() iteration; keep the most allocations in one and log
+   allocations in the steady state
+ * *****************************************************************************/
+  uint32_t count = alloc_total - alloc_loop_start;
+  if (count > alloc_loop_max) alloc_loop_max = count;
+  alloc_loops++;
+  alloc_loop_start = alloc_total;
+
+  if (alloc_failures == alloc_reported) return;
+  LOG_ERROR("Allocation in the steady state; %lu in total, last in %s", alloc_failures, alloc_failed_in);
+  alloc_reported = alloc_failures;
+#if ALLOC_STRICT
+  Log_Flush();
+  panic();
+#endif
+}
+
+uint32_t Alloc_Failures() {
+  return alloc_failures;
+}
+
+uint32_t Alloc_Bytes() {
+  return alloc_bytes;
+}
+
+void Alloc_Steady() {
+  alloc_steady = true;
+  LOG_INFO("Steady state; %lu allocations so far", alloc_total);
+}
+
+void Alloc_Report() {
+/* *****************************************************************************
+   Alloc_Report
+
+   Write every scope that allocated and the heap stats to the log
+ * *****************************************************************************/
+  uint32_t free_heap;
+  uint16_t max_block;
+  uint8_t  fragmentation;
+  ESP.getHeapStats(&free_heap, &max_block, &fragmentation);
+
+  LOG_INFO("Alloc %lu in %lu loops, at most %lu per loop; %lu in the steady state",
+           alloc_total, alloc_loops, alloc_loop_max, alloc_failures);
+  LOG_INFO("Alloc heap %lu free, largest block %u, %u%% fragmented", free_heap, max_block, fragmentation);
+  for (Alloc_Site *site = alloc_sites; site != NULL; site = site->next) {
+    LOG_INFO("Alloc %-20s n=%lu bytes=%lu steady=%lu%s",
+             site->name, site->count, site->bytes, site->steady, site->exempt ? " (exempt)" : "");
+  }
+}
+
+#endif
@@ -0,0 +1,197 @@
+/* *****************************************************************************
+
+   Copyright (C) 2022 P.A.G.M. Zengers
+
+   Benchmarks of the Waveshare drawing primitives, see Bench.h
+
+   This program is free software: you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation, either version 3 of the License, or
+   (at your option) any later version.
+
+ * ****************************************************************************/
+
+#include "Bench.h"
+
+#if BENCH_ENABLED
+
+#include <Arduino.h>
+#include "DEV_Config.h"
+#include "LCD_Driver.h"
+#include "GUI_Paint.h"
+#include "image.h"
+#include "LCDStats.h"
+#include "LCDTrace.h"
+#include "ScreenStats.h"
+#include "Persist.h"
+#include "Log.h"
+
+struct Bench_Result {
+  uint32_t us;                           // Fastest run
+  uint32_t bytes;
+  uint32_t commands;
+  uint32_t windows;
+};
+
+static void Bench_Clear()        { Paint_Clear(WHITE); }
+static void Bench_Horizontal()   { Paint_DrawLine(10, 120, 230, 120, BLUE, DOT_PIXEL_1X1, LINE_STYLE_SOLID); }
+static void Bench_Vertical()     { Paint_DrawLine(120, 10, 120, 230, BLUE, DOT_PIXEL_1X1, LINE_STYLE_SOLID); }
+static void Bench_Diagonal()     { Paint_DrawLine(40, 40, 200, 200, BLUE, DOT_PIXEL_1X1, LINE_STYLE_SOLID); }
+static void Bench_Thick()        { Paint_DrawLine(40, 200, 200, 40, BLUE, DOT_PIXEL_3X3, LINE_STYLE_SOLID); }
+static void Bench_Rectangle()    { Paint_DrawRectangle(40, 40, 200, 200, RED, DOT_PIXEL_1X1, DRAW_FILL_EMPTY); }
+static void Bench_RectFull()     { Paint_DrawRectangle(80, 80, 160, 160, RED, DOT_PIXEL_1X1, DRAW_FILL_FULL); }
+static void Bench_Circle()       { Paint_DrawCircle(120, 120, 60, GREEN, DOT_PIXEL_1X1, DRAW_FILL_EMPTY); }
+static void Bench_CircleFull()   { Paint_DrawCircle(120, 120, 30, GREEN, DOT_PIXEL_1X1, DRAW_FILL_FULL); }
+static void Bench_Font8()        { Paint_DrawString_EN(30, 110, "RoundMeter 1234", &Font8,  WHITE, BLACK); }
+static void Bench_Font16()       { Paint_DrawString_EN(30, 110, "RoundMeter 1234", &Font16, WHITE, BLACK); }
+static void Bench_Font20()       { Paint_DrawString_EN(30, 110, "RoundMeter 1234", &Font20, WHITE, BLACK); }
+static void Bench_Font24()       { Paint_DrawString_EN(30, 110, "RoundMeter", &Font24, WHITE, BLACK); }
+static void Bench_Num()          { Paint_DrawNum(60, 110, 1234567, &Font16, WHITE, BLACK); }
+static void Bench_FloatNum()     { Paint_DrawFloatNum(60, 110, 12.345, 2, &Font16, WHITE, BLACK); }
+static void Bench_Image()        { Paint_DrawImage(gImage_70X70, 85, 85, 70, 70); }
+
+static const Bench_Case bench_cases[] = {
+  { "Paint_Clear",         Bench_Clear,      115211,     3 },
+  { "DrawLine horizontal", Bench_Horizontal,   2873,   663 },
+  { "DrawLine vertical",   Bench_Vertical,     2873,   663 },
+  { "DrawLine diagonal",   Bench_Diagonal,     2093,   483 },
+  { "DrawLine thick",      Bench_Thick,       52325, 12075 },
+  { "DrawRectangle",       Bench_Rectangle,    8372,  1932 },
+  { "DrawRectangle full",  Bench_RectFull,    84240, 19440 },
+  { "DrawCircle",          Bench_Circle,       4472,  1032 },
+  { "DrawCircle full",     Bench_CircleFull,  40560,  9360 },
+  { "DrawString Font8",    Bench_Font8,        2067,   477 },
+  { "DrawString Font16",   Bench_Font16,       6461,  1491 },
+  { "DrawString Font20",   Bench_Font20,      10426,  2406 },
+  { "DrawString Font24",   Bench_Font24,       9828,  2268 },
+  { "DrawNum",             Bench_Num,          3003,   693 },
+  { "DrawFloatNum",        Bench_FloatNum,    11440,  2640 },
+  { "DrawImage 70x70",     Bench_Image,       63700, 14700 }
+};
+
+#define BENCH_CASES                (sizeof(bench_cases) / sizeof(bench_cases[0]))
+
+static Bench_Result bench_results[BENCH_CASES_MAX],
+                    bench_baseline[BENCH_CASES_MAX];
+
+static void Bench_Measure(const Bench_Case &test, Bench_Result &result, bool screen) {
+/* *****************************************************************************
+   Bench_Measure
+
+   Run one case BENCH_RUNS times. The counters are the same every run, the
+   time is that of the fastest run. The primitives are counted by LCDStats,
+   the calls through tft by ScreenStats
+ * *****************************************************************************/
+  result.us = UINT32_MAX;
+  for (uint8_t run = 0; run < BENCH_RUNS; run++) {
+    LCD_Stats_Reset();
+#if SCREEN_STATS_ENABLED
+    ScreenStats_Begin();
+#endif
+    unsigned long start = micros();
+    test.run();
+    uint32_t us = micros() - start;
+    if (us < result.us) result.us = us;
+    yield(); // Keep the watchdog happy between runs
+  }
+  result.bytes    = lcd_stats.bytes;
+  result.commands = lcd_stats.commands;
+  result.windows  = lcd_stats.windows;
+#if SCREEN_STATS_ENABLED
+  if (screen) {
+    result.bytes    = ScreenStats_Get().bytes;
+    result.commands = ScreenStats_Get().calls;
+    result.windows  = 0;                 // Not counted per call
+  }
+#endif
+}
+
+static int Bench_Cases(const Bench_Case *cases, uint8_t count, bool screen, const char *file) {
+/* *****************************************************************************
+   Bench_Cases
+
+   Measure the cases and compare their bytes and commands with the baseline
+   of the case, their times with the baseline in file or save them as that
+   baseline when there is none. Returns the number of cases that failed
+ * *****************************************************************************/
+  count = min(count, (uint8_t)BENCH_CASES_MAX);
+  Persist_Begin();
+  bool have_baseline = Persist_Load(file, bench_baseline, count * sizeof(Bench_Result));
+
+  int failed = 0;
+  LOG_INFO("Bench %-20s %8s %8s %6s %7s", "", "us", "bytes", screen ? "calls" : "cmds", "windows");
+  for (uint8_t i = 0; i < count; i++) {
+    const Bench_Case &test   = cases[i];
+    Bench_Result     &result = bench_results[i];
+    Bench_Measure(test, result, screen);
+    if (screen) LOG_INFO("Bench %-20s %8lu %8lu %6lu %7s", test.name, result.us, result.bytes, result.commands, "n/a");
+    else        LOG_INFO("Bench %-20s %8lu %8lu %6lu %7lu",
+                         test.name, result.us, result.bytes, result.commands, result.windows);
+
+    bool counted = !screen || SCREEN_STATS_ENABLED, // The calls are counted by ScreenStats only
+         over    = false;
+    if (counted && test.bytes == 0) {
+      LOG_ERROR("Bench %s FAILED; no baseline, %lu bytes and %lu commands", test.name, result.bytes, result.commands);
+      over = true;
+    } else if (counted && (result.bytes > test.bytes || result.commands > test.commands)) {
+      LOG_ERROR("Bench %s FAILED; %lu bytes and %lu commands, baseline %lu and %lu",
+                test.name, result.bytes, result.commands, test.bytes, test.commands);
+      over = true;
+    } else if (counted && (result.bytes < test.bytes || result.commands < test.commands)) {
+      LOG_INFO("Bench %s; fewer bytes or commands than the baseline, update it", test.name);
+    }
+    if (!over && have_baseline) {
+      const Bench_Result &base = bench_baseline[i];
+      if (result.us > base.us + base.us * BENCH_TOLERANCE / 100) {
+        LOG_ERROR("Bench %s FAILED; %lu us, baseline %lu us", test.name, result.us, base.us);
+        over = true;
+      }
+    }
+    if (over) failed++;
+#if LCD_TRACE_ENABLED
+    if (!screen) {
+      char path[32] = "";
+#if LCD_TRACE_FILES
+      snprintf(path, sizeof(path), LCD_TRACE_DIR "/%02d.bin", i);
+#endif
+      LCD_Trace_Start(path[0] ? path : NULL); // Once more, traced; not timed as the trace slows it down
+      cases[i].run();
+      LCD_Trace_Stop();
+      LCD_Trace_Report(cases[i].name);
+    }
+#endif
+    Log_Flush(); // Nothing else runs yet, and the ring would overflow
+  }
+
+  if (!have_baseline) {
+    Persist_Save(file, bench_results, count * sizeof(Bench_Result));
+    LOG_INFO("Bench times saved as the baseline");
+  }
+  LOG_INFO("Bench done; %d of %d cases over the baseline", failed, count);
+  Log_Flush();
+  return failed;
+}
+
+int Bench_Run() {
+/* *****************************************************************************
+   Bench_Run
+
+   Take over the display, run all primitives and compare with the baseline
+ * *****************************************************************************/
+  // As Config_Init, without switching the serial port to another speed
+  GPIO_Init();
+  SPI.setDataMode(SPI_MODE3);
+  SPI.setBitOrder(MSBFIRST);
+  SPI.setClockDivider(SPI_CLOCK_DIV2);
+  SPI.begin();
+  LCD_Init();
+  Paint_NewImage(LCD_WIDTH, LCD_HEIGHT, 0, WHITE);
+
+  return Bench_Cases(bench_cases, BENCH_CASES, false, BENCH_FILE);
+}
+
+int Bench_Screen(const Bench_Case *cases, uint8_t count) {
+  return Bench_Cases(cases, count, true, BENCH_SCREEN_FILE);
+}
+
+#endif
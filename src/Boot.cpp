@@ -0,0 +1,117 @@
+/* *****************************************************************************
+
+   Copyright (C) 2022 P.A.G.M. Zengers
+
+   Boot timeline, see Boot.h
+
+   This program is free software: you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation, either version 3 of the License, or
+   (at your option) any later version.
+
+ * ****************************************************************************/
+
+#include <Arduino.h>
+#include "Boot.h"
+#include "Log.h"
+
+struct Boot_Timeline {
+  uint32_t sequence;                     // Starts counted since power on, 0 if unused
+  uint32_t reason;                       // rst_info reason of the reset before this start
+  uint32_t mark[BOOT_PHASES];            // millis() at the end of each phase, 0 if not reached
+};
+
+struct Boot_Rtc {
+  uint32_t      magic;
+  uint32_t      sequence;                // Of the newest timeline
+  Boot_Timeline timeline[BOOT_HISTORY];
+};
+
+static_assert(BOOT_HISTORY == 4, "Boot_Report prints one column per timeline");
+
+static Boot_Rtc boot_rtc;
+static uint8_t  boot_now;                // Timeline of this start
+static bool     boot_reported = false;
+
+static const char *boot_phase_names[BOOT_PHASES] = {
+  "serial", "tft init", "screen", "wifi", "sensor", "splash wait", "tasks", "first frame"
+};
+
+static void Boot_Save() {
+  ESP.rtcUserMemoryWrite(BOOT_RTC_OFFSET, (uint32_t *)&boot_rtc, sizeof(boot_rtc));
+}
+
+void Boot_Begin() {
+/* *****************************************************************************
+   Boot_Begin
+
+   Pick up the history from RTC memory and start the timeline of this start
+ * *****************************************************************************/
+  if (!ESP.rtcUserMemoryRead(BOOT_RTC_OFFSET, (uint32_t *)&boot_rtc, sizeof(boot_rtc)) ||
+      boot_rtc.magic != BOOT_MAGIC) {
+    memset(&boot_rtc, 0, sizeof(boot_rtc)); // Power on, RTC memory holds noise
+    boot_rtc.magic = BOOT_MAGIC;
+  }
+  boot_rtc.sequence++;
+  boot_now = boot_rtc.sequence % BOOT_HISTORY;
+  Boot_Timeline &timeline = boot_rtc.timeline[boot_now];
+  memset(&timeline, 0, sizeof(timeline));
+  timeline.sequence = boot_rtc.sequence;
+  timeline.reason   = ESP.getResetInfoPtr()->reason;
+  Boot_Save();
+}
+
+static long Boot_Duration(const Boot_Timeline &timeline, uint8_t phase) {
+/* *****************************************************************************
+   Boot_Duration
+
+   ms spent in a phase, the first frame counted from the start. -1 when the
+   phase was not reached
+ * *****************************************************************************/
+  if (timeline.sequence == 0 || timeline.mark[phase] == 0) return -1;
+  if (phase == 0 || phase == BOOT_FIRST_FRAME) return timeline.mark[phase];
+  if (timeline.mark[phase - 1] == 0) return -1;
+  return timeline.mark[phase] - timeline.mark[phase - 1];
+}
+
+static long Boot_Reason(const Boot_Timeline &timeline) {
+  return timeline.sequence == 0 ? -1 : (long)timeline.reason;
+}
+
+static void Boot_Report() {
+/* *****************************************************************************
+   Boot_Report
+
+   One line per phase, this start first and then the ones before
+ * *****************************************************************************/
+  const Boot_Timeline *timeline[BOOT_HISTORY];
+  for (uint8_t age = 0; age < BOOT_HISTORY; age++) {
+    timeline[age] = &boot_rtc.timeline[(boot_now + BOOT_HISTORY - age) % BOOT_HISTORY];
+  }
+  LOG_INFO("Boot %-12s %7s %7s %7s %7s", "(ms)", "now", "-1", "-2", "-3");
+  for (uint8_t phase = 0; phase < BOOT_PHASES; phase++) {
+    LOG_INFO("Boot %-12s %7ld %7ld %7ld %7ld", boot_phase_names[phase],
+             Boot_Duration(*timeline[0], phase), Boot_Duration(*timeline[1], phase),
+             Boot_Duration(*timeline[2], phase), Boot_Duration(*timeline[3], phase));
+  }
+  LOG_INFO("Boot %-12s %7ld %7ld %7ld %7ld", "reset reason",
+           Boot_Reason(*timeline[0]), Boot_Reason(*timeline[1]), Boot_Reason(*timeline[2]), Boot_Reason(*timeline[3]));
+}
+
+void Boot_Mark(uint8_t phase) {
+/* *****************************************************************************
+   Boot_Mark
+
+   A phase of the start has ended. Reports the timeline once setup() is done
+   and the first frame with data was shown, whichever comes last
+ * *****************************************************************************/
+  if (phase >= BOOT_PHASES || boot_reported) return;
+  Boot_Timeline &timeline = boot_rtc.timeline[boot_now];
+  timeline.mark[phase] = max(millis(), 1UL); // 0 means not reached
+  Boot_Save();
+
+  if (timeline.mark[BOOT_TASKS] != 0 && timeline.mark[BOOT_FIRST_FRAME] != 0) {
+    boot_reported = true;
+    Boot_Report();
+  }
+}
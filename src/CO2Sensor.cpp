@@ -0,0 +1,113 @@
+/* *****************************************************************************
+
+   Copyright (C) 2022 P.A.G.M. Zengers
+
+   Non blocking MH-Z19B driver, see CO2Sensor.h
+
+   This program is free software: you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation, either version 3 of the License, or
+   (at your option) any later version.
+
+ * ****************************************************************************/
+
+#include <MHZ19.h>
+#include "CO2Sensor.h"
+
+#define CO2_START_BYTE             0xFF
+#define CO2_SENSOR_NUMBER          0x01
+
+static Stream*       co2_port = NULL;
+static bool          co2_waiting = false;
+static unsigned long co2_requested;      // millis() of the last request
+static uint8_t       co2_reply[CO2_FRAME_LENGTH];
+static uint8_t       co2_received;       // Bytes of the reply received so far
+static int           co2_value = 0,
+                     co2_temperature = 0;
+
+static uint8_t CO2_Checksum(const uint8_t *frame) {
+/* *****************************************************************************
+   CO2_Checksum
+
+   Checksum of a frame: 0xFF minus the sum of bytes 1..7, plus one
+ * *****************************************************************************/
+  uint8_t sum = 0;
+  for (int i = 1; i < CO2_FRAME_LENGTH - 1; i++) sum += frame[i];
+  return 0xFF - sum + 1;
+}
+
+void CO2_Begin(Stream *port) {
+/* *****************************************************************************
+   CO2_Begin
+
+   Use port (already started at 9600 baud) to talk to the sensor, and forget
+   any request made before
+ * *****************************************************************************/
+  co2_port = port;
+  co2_waiting = false;
+}
+
+void CO2_Request() {
+/* *****************************************************************************
+   CO2_Request
+
+   Send the read command. A request still waiting for its reply is finished
+   or timed out first: while its reply is on the way no new command is sent,
+   the next CO2_Poll returns that reply. Anything left in the receive buffer
+   after it belongs to an older request and is thrown away
+ * *****************************************************************************/
+  if (co2_port == NULL) return;
+  if (co2_waiting && CO2_Poll() == CO2_PENDING) return;
+  while (co2_port->available()) co2_port->read();
+
+  uint8_t command[CO2_FRAME_LENGTH] = { CO2_START_BYTE, CO2_SENSOR_NUMBER, CO2_CMD_READ, 0, 0, 0, 0, 0, 0 };
+  command[CO2_FRAME_LENGTH - 1] = CO2_Checksum(command);
+  co2_port->write(command, CO2_FRAME_LENGTH);
+
+  co2_requested = millis();
+  co2_received  = 0;
+  co2_waiting   = true;
+}
+
+int CO2_Poll() {
+/* *****************************************************************************
+   CO2_Poll
+
+   Collect what has arrived of the reply. Returns CO2_PENDING while the reply
+   is incomplete, CO2_IDLE when nothing was requested, otherwise the
+   MHZ19_RESULT of the read. Never waits
+ * *****************************************************************************/
+  if (!co2_waiting) return CO2_IDLE;
+
+  while (co2_port->available() && co2_received < CO2_FRAME_LENGTH) {
+    uint8_t c = co2_port->read();
+    // Sync on the start of the reply, skip any noise before it
+    if (co2_received == 0 && c != CO2_START_BYTE) continue;
+    if (co2_received == 1 && c != CO2_CMD_READ) {
+      co2_received = (c == CO2_START_BYTE) ? 1 : 0;
+      continue;
+    }
+    co2_reply[co2_received++] = c;
+  }
+
+  if (co2_received < CO2_FRAME_LENGTH) {
+    if ((uint32_t)(millis() - co2_requested) < CO2_RESPONSE_TIMEOUT) return CO2_PENDING;
+    co2_waiting = false;
+    return MHZ19_RESULT_ERR_TIMEOUT;
+  }
+
+  co2_waiting = false;
+  if (co2_reply[CO2_FRAME_LENGTH - 1] != CO2_Checksum(co2_reply)) return MHZ19_RESULT_ERR_CRC;
+
+  co2_value       = co2_reply[2] * 256 + co2_reply[3];
+  co2_temperature = co2_reply[4] - 40;
+  return MHZ19_RESULT_OK;
+}
+
+int CO2_Value() {
+  return co2_value;
+}
+
+int CO2_Temperature() {
+  return co2_temperature;
+}
@@ -0,0 +1,94 @@
+/* *****************************************************************************
+
+   Copyright (C) 2022 P.A.G.M. Zengers
+
+   Timing of the https fetches, see Fetch.h
+
+   This program is free software: you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation, either version 3 of the License, or
+   (at your option) any later version.
+
+ * ****************************************************************************/
+
+#include <Arduino.h>
+#include "Fetch.h"
+#include "Log.h"
+
+static Fetch_Record  fetch_ring[FETCH_RECORDS];
+static uint8_t       fetch_head = 0;     // Record of the current or next fetch
+static unsigned long fetch_mark;         // millis() at the end of the previous phase
+
+static const char   *fetch_phase_names[FETCH_PHASES] = { "dns", "connect", "ttfb", "body" };
+
+void Fetch_Start(const char *host) {
+/* *****************************************************************************
+   Fetch_Start
+
+   Begin a new record, overwriting the oldest one
+ * *****************************************************************************/
+  Fetch_Record &record = fetch_ring[fetch_head];
+  memset(&record, 0, sizeof(Fetch_Record));
+  record.host  = host;
+  record.start = millis();
+  fetch_mark   = record.start;
+}
+
+void Fetch_Phase(uint8_t phase) {
+/* *****************************************************************************
+   Fetch_Phase
+
+   A phase has ended; it took the time since the previous one ended
+ * *****************************************************************************/
+  if (phase >= FETCH_PHASES) return;
+  Fetch_Record &record = fetch_ring[fetch_head];
+  unsigned long now = millis();
+  record.phase[phase] = (uint32_t)(now - fetch_mark);
+  record.phases = phase + 1;
+  fetch_mark = now;
+}
+
+void Fetch_Retries(uint8_t retries) {
+  fetch_ring[fetch_head].retries = retries;
+}
+
+void Fetch_End(int status, unsigned long bytes, bool ok) {
+/* *****************************************************************************
+   Fetch_End
+
+   Close the record, log it and move on to the next one
+ * *****************************************************************************/
+  Fetch_Record &record = fetch_ring[fetch_head];
+  if (record.phases == FETCH_TTFB + 1) Fetch_Phase(FETCH_BODY);
+  record.total  = (uint32_t)(millis() - record.start);
+  record.status = record.phases > FETCH_TTFB ? status : 0; // The status is of an older fetch otherwise
+  record.bytes  = bytes;
+  record.ok     = ok;
+
+  LOG_INFO("Fetch %s %s; dns %lu, connect %lu, ttfb %lu, body %lu ms",
+           record.host, ok ? "done" : "failed",
+           record.phase[FETCH_DNS], record.phase[FETCH_CONNECT], record.phase[FETCH_TTFB], record.phase[FETCH_BODY]);
+  LOG_INFO("Fetch %s; status %d, %lu bytes, %d retries, total %lu ms",
+           record.host, record.status, record.bytes, record.retries, record.total);
+
+  fetch_head = (fetch_head + 1) % FETCH_RECORDS;
+}
+
+const Fetch_Record *Fetch_Get(uint8_t age) {
+  if (age >= FETCH_RECORDS) return NULL;
+  const Fetch_Record *record = &fetch_ring[(fetch_head + FETCH_RECORDS - 1 - age) % FETCH_RECORDS];
+  return record->host ? record : NULL;
+}
+
+const Fetch_Record *Fetch_Last(const char *host) {
+  for (uint8_t age = 0; age < FETCH_RECORDS; age++) {
+    const Fetch_Record *record = Fetch_Get(age);
+    if (record == NULL) return NULL;
+    if (record->host == host) return record;
+  }
+  return NULL;
+}
+
+const char *Fetch_Phase_Name(uint8_t phase) {
+  return phase < FETCH_PHASES ? fetch_phase_names[phase] : "";
+}
@@ -33,6 +33,7 @@
 ******************************************************************************/
 #include "GUI_Paint.h"
 #include "DEV_Config.h"
+#include "Profile.h"
 #include <stdint.h>
 #include <stdlib.h>
 #include <string.h> //memset()
@@ -172,6 +173,7 @@ void Paint_SetPixel(UWORD Xpoint, UWORD Ypoint, UWORD Color)
 ******************************************************************************/
 void Paint_Clear(UWORD Color)
 {
+  PROFILE("Paint_Clear");
   LCD_SetCursor(0, 0, Paint.WidthByte , Paint.HeightByte);
   for (UWORD Y = 0; Y < Paint.HeightByte; Y++) {
     for (UWORD X = 0; X < Paint.WidthByte; X++ ) {//8 pixel =  1 byte
@@ -190,6 +192,7 @@ void Paint_Clear(UWORD Color)
 ******************************************************************************/
 void Paint_ClearWindows(UWORD Xstart, UWORD Ystart, UWORD Xend, UWORD Yend, UWORD Color)
 {
+  PROFILE("Paint_ClearWindows");
   UWORD X, Y;
   for (Y = Ystart; Y < Yend; Y++) {
     for (X = Xstart; X < Xend; X++) {//8 pixel =  1 byte
@@ -452,6 +455,7 @@ void Paint_DrawChar(UWORD Xpoint, UWORD Ypoint, const char Acsii_Char,
 void Paint_DrawString_EN(UWORD Xstart, UWORD Ystart, const char * pString,
                          sFONT* Font, UWORD Color_Background, UWORD Color_Foreground )
 {
+  PROFILE("Paint_DrawString_EN");
   UWORD Xpoint = Xstart;
   UWORD Ypoint = Ystart;
 
@@ -612,9 +616,9 @@ void Paint_DrawFloatNum(UWORD Xpoint, UWORD Ypoint, double Nummber,  UBYTE Decim
 {
   char Str[ARRAY_LEN] = {0};
   dtostrf(Nummber,0,Decimal_Point+2,Str);
-  char * pStr= (char *)malloc((strlen(Str))*sizeof(char));
+  char * pStr= (char *)malloc((strlen(Str)-1)*sizeof(char));
   memcpy(pStr,Str,(strlen(Str)-2));
-  * (pStr+strlen(Str)-1)='\0';
+  * (pStr+strlen(Str)-2)='\0'; // Drop the two extra decimals
   if((*(pStr+strlen(Str)-3))=='.')
   {
 	*(pStr+strlen(Str)-3)='\0';
@@ -663,6 +667,7 @@ void Paint_DrawTime(UWORD Xstart, UWORD Ystart, PAINT_TIME *pTime, sFONT* Font,
 ******************************************************************************/
 void Paint_DrawImage(const unsigned char *image, UWORD xStart, UWORD yStart, UWORD W_Image, UWORD H_Image)
 {
+  PROFILE("Paint_DrawImage");
   int i, j;
   for (j = 0; j < H_Image; j++) {
     for (i = 0; i < W_Image; i++) {
@@ -0,0 +1,51 @@
+/* *****************************************************************************
+
+   Copyright (C) 2022 P.A.G.M. Zengers
+
+   Golden image checks of the screens, see Golden.h
+
+   This program is free software: you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation, either version 3 of the License, or
+   (at your option) any later version.
+
+ * ****************************************************************************/
+
+#include "Golden.h"
+
+#if GOLDEN_ENABLED
+
+#include "Log.h"
+
+int Golden_Run(const Golden_Case *cases, uint8_t count) {
+/* *****************************************************************************
+   Golden_Run
+
+   Draw every case and compare its hash with the expected one. A case without
+   an expected hash fails as well, there is nothing to compare with
+ * *****************************************************************************/
+  int failed = 0;
+  for (uint8_t i = 0; i < count; i++) {
+    ScreenStats_Begin();
+    cases[i].draw(cases[i].arg);
+    uint32_t hash = ScreenStats_Get().hash;
+
+    if (hash == cases[i].hash) {
+      LOG_INFO("Golden %-20s %08lx ok", cases[i].name, hash);
+    } else if (cases[i].hash == 0) {
+      LOG_ERROR("Golden %s FAILED; %08lx, no expected hash", cases[i].name, hash);
+      failed++;
+    } else {
+      LOG_ERROR("Golden %s FAILED; %08lx, expected %08lx", cases[i].name, hash, cases[i].hash);
+      failed++;
+    }
+    Log_Flush(); // Nothing else runs yet, and the ring would overflow
+    delay(GOLDEN_SHOW_MS);
+  }
+
+  LOG_INFO("Golden done; %d of %d screens differ from the expected hashes", failed, count);
+  Log_Flush();
+  return failed;
+}
+
+#endif
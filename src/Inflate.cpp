@@ -0,0 +1,353 @@
+/* *****************************************************************************
+
+   Copyright (C) 2022 P.A.G.M. Zengers
+
+   Streaming gzip / deflate decompressor, see Inflate.h. The Huffman decoding
+   follows the canonical code approach of tinf by Joergen Ibsen, which needs
+   no lookup tables beyond the code length counts and sorted symbols.
+
+   This program is free software: you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation, either version 3 of the License, or
+   (at your option) any later version.
+
+ * ****************************************************************************/
+
+#include <stdlib.h>
+#include "Inflate.h"
+
+#define GZIP_ID1                   0x1f
+#define GZIP_ID2                   0x8b
+#define GZIP_CM_DEFLATE            8
+#define GZIP_FHCRC                 0x02
+#define GZIP_FEXTRA                0x04
+#define GZIP_FNAME                 0x08
+#define GZIP_FCOMMENT              0x10
+
+#define HUFF_MAX_BITS              15
+#define HUFF_LITLEN_CODES          288
+#define HUFF_DIST_CODES            30
+#define HUFF_CLEN_CODES            19
+
+struct Huffman {
+  uint16_t counts[HUFF_MAX_BITS + 1];    // Number of codes per code length
+  uint16_t symbols[HUFF_LITLEN_CODES];   // Symbols ordered by code
+};
+
+struct Inflater {
+  Inflate_ReadFn  read_byte;
+  Inflate_WriteFn write_byte;
+  uint32_t        bits;                  // Bit buffer, LSB first
+  uint8_t         bit_count;
+  bool            input_ended;
+  char           *window;
+  uint32_t        window_mask;
+  uint32_t        produced;              // Total bytes written (mod 2^32)
+  uint32_t        crc;
+  Huffman         litlen, dist;
+};
+
+static const uint16_t length_base[29] = {
+  3, 4, 5, 6, 7, 8, 9, 10, 11, 13, 15, 17, 19, 23, 27, 31,
+  35, 43, 51, 59, 67, 83, 99, 115, 131, 163, 195, 227, 258 };
+static const uint8_t length_extra[29] = {
+  0, 0, 0, 0, 0, 0, 0, 0, 1, 1, 1, 1, 2, 2, 2, 2,
+  3, 3, 3, 3, 4, 4, 4, 4, 5, 5, 5, 5, 0 };
+static const uint16_t dist_base[HUFF_DIST_CODES] = {
+  1, 2, 3, 4, 5, 7, 9, 13, 17, 25, 33, 49, 65, 97, 129, 193,
+  257, 385, 513, 769, 1025, 1537, 2049, 3073, 4097, 6145, 8193, 12289, 16385, 24577 };
+static const uint8_t dist_extra[HUFF_DIST_CODES] = {
+  0, 0, 0, 0, 1, 1, 2, 2, 3, 3, 4, 4, 5, 5, 6, 6,
+  7, 7, 8, 8, 9, 9, 10, 10, 11, 11, 12, 12, 13, 13 };
+static const uint8_t clen_order[HUFF_CLEN_CODES] = {
+  16, 17, 18, 0, 8, 7, 9, 6, 10, 5, 11, 4, 12, 3, 13, 2, 14, 1, 15 };
+
+// CRC32 (IEEE), four bits at a time to keep the table small
+static const uint32_t crc_nibble[16] = {
+  0x00000000, 0x1db71064, 0x3b6e20c8, 0x26d930ac, 0x76dc4190, 0x6b6b51f4, 0x4db26158, 0x5005713c,
+  0xedb88320, 0xf00f9344, 0xd6d6a3e8, 0xcb61b38c, 0x9b64c2b0, 0x86d3d2d4, 0xa00ae278, 0xbdbdf21c };
+
+static int Next_Byte(Inflater *d) {
+/* *****************************************************************************
+   Next_Byte
+
+   Read one input byte, remembering when the input ran dry
+ * *****************************************************************************/
+  int c = d->read_byte();
+  if (c < 0) {
+    d->input_ended = true;
+    return 0;
+  }
+  return c;
+}
+
+static uint32_t Get_Bits(Inflater *d, uint8_t count) {
+/* *****************************************************************************
+   Get_Bits
+
+   Read count (0..16) bits, least significant bit first
+ * *****************************************************************************/
+  while (d->bit_count < count) {
+    d->bits |= (uint32_t)Next_Byte(d) << d->bit_count;
+    d->bit_count += 8;
+  }
+  uint32_t value = d->bits & ((1UL << count) - 1);
+  d->bits >>= count;
+  d->bit_count -= count;
+  return value;
+}
+
+static void Put_Byte(Inflater *d, char c) {
+/* *****************************************************************************
+   Put_Byte
+
+   Hand one decompressed byte to the caller and keep it in the window
+ * *****************************************************************************/
+  d->window[d->produced & d->window_mask] = c;
+  d->produced++;
+  d->crc = (d->crc >> 4) ^ crc_nibble[(d->crc ^ (uint8_t)c) & 0x0f];
+  d->crc = (d->crc >> 4) ^ crc_nibble[(d->crc ^ ((uint8_t)c >> 4)) & 0x0f];
+  d->write_byte(c);
+}
+
+static bool Build_Huffman(Huffman *t, const uint8_t *lengths, uint16_t num) {
+/* *****************************************************************************
+   Build_Huffman
+
+   Build a canonical Huffman decoding table from a list of code lengths
+ * *****************************************************************************/
+  uint16_t offsets[HUFF_MAX_BITS + 1];
+
+  for (int i = 0; i <= HUFF_MAX_BITS; i++) t->counts[i] = 0;
+  for (uint16_t i = 0; i < num; i++) t->counts[lengths[i]]++;
+  t->counts[0] = 0;
+
+  // Reject over-subscribed code sets
+  int left = 1;
+  for (int i = 1; i <= HUFF_MAX_BITS; i++) {
+    left = (left << 1) - t->counts[i];
+    if (left < 0) return false;
+  }
+
+  uint16_t sum = 0;
+  for (int i = 0; i <= HUFF_MAX_BITS; i++) {
+    offsets[i] = sum;
+    sum += t->counts[i];
+  }
+  for (uint16_t i = 0; i < num; i++)
+    if (lengths[i]) t->symbols[offsets[lengths[i]]++] = i;
+  return true;
+}
+
+static int Decode_Symbol(Inflater *d, const Huffman *t) {
+/* *****************************************************************************
+   Decode_Symbol
+
+   Read one Huffman coded symbol, -1 when the bits do not form a valid code
+ * *****************************************************************************/
+  int sum = 0, cur = 0;
+  for (int len = 1; len <= HUFF_MAX_BITS; len++) {
+    cur = 2 * cur + Get_Bits(d, 1);
+    sum += t->counts[len];
+    cur -= t->counts[len];
+    if (cur < 0) return t->symbols[sum + cur];
+  }
+  return -1;
+}
+
+static int Inflate_Stored(Inflater *d) {
+/* *****************************************************************************
+   Inflate_Stored
+
+   Copy an uncompressed block
+ * *****************************************************************************/
+  d->bits = 0; // Stored blocks start at a byte boundary
+  d->bit_count = 0;
+  uint16_t len  = Next_Byte(d); // Low byte first; one read per statement, to keep them in order
+  len          |= Next_Byte(d) << 8;
+  uint16_t nlen = Next_Byte(d);
+  nlen         |= Next_Byte(d) << 8;
+  if (len != (uint16_t)~nlen) return INFLATE_ERR_DATA;
+  while (len--) {
+    char c = Next_Byte(d);
+    if (d->input_ended) return INFLATE_ERR_INPUT;
+    Put_Byte(d, c);
+  }
+  return INFLATE_OK;
+}
+
+static void Fixed_Tables(Inflater *d) {
+/* *****************************************************************************
+   Fixed_Tables
+
+   Set up the Huffman tables defined by RFC 1951 for block type 1
+ * *****************************************************************************/
+  uint8_t lengths[HUFF_LITLEN_CODES];
+  int i = 0;
+  for (; i < 144; i++) lengths[i] = 8;
+  for (; i < 256; i++) lengths[i] = 9;
+  for (; i < 280; i++) lengths[i] = 7;
+  for (; i < 288; i++) lengths[i] = 8;
+  Build_Huffman(&d->litlen, lengths, HUFF_LITLEN_CODES);
+  for (i = 0; i < HUFF_DIST_CODES; i++) lengths[i] = 5;
+  Build_Huffman(&d->dist, lengths, HUFF_DIST_CODES);
+}
+
+static int Dynamic_Tables(Inflater *d) {
+/* *****************************************************************************
+   Dynamic_Tables
+
+   Read the Huffman tables sent with a block of type 2
+ * *****************************************************************************/
+  uint8_t lengths[HUFF_LITLEN_CODES + HUFF_DIST_CODES + 2];
+  uint16_t hlit  = Get_Bits(d, 5) + 257;
+  uint16_t hdist = Get_Bits(d, 5) + 1;
+  uint16_t hclen = Get_Bits(d, 4) + 4;
+  if (hlit > HUFF_LITLEN_CODES || hdist > HUFF_DIST_CODES + 2) return INFLATE_ERR_DATA;
+
+  // The code lengths themselves are Huffman coded; borrow the distance table for it
+  for (int i = 0; i < HUFF_CLEN_CODES; i++) lengths[clen_order[i]] = 0;
+  for (int i = 0; i < hclen; i++) lengths[clen_order[i]] = Get_Bits(d, 3);
+  if (!Build_Huffman(&d->dist, lengths, HUFF_CLEN_CODES)) return INFLATE_ERR_DATA;
+
+  uint16_t num = 0;
+  while (num < hlit + hdist) {
+    int sym = Decode_Symbol(d, &d->dist);
+    if (sym < 0 || d->input_ended) return INFLATE_ERR_DATA;
+    uint8_t  value  = 0;
+    uint16_t repeat = 1;
+    switch (sym) {
+      case 16: if (num == 0) return INFLATE_ERR_DATA;
+               value  = lengths[num - 1];
+               repeat = 3 + Get_Bits(d, 2);
+               break;
+      case 17: repeat = 3 + Get_Bits(d, 3); break;
+      case 18: repeat = 11 + Get_Bits(d, 7); break;
+      default: value = sym; break;
+    }
+    if (num + repeat > hlit + hdist) return INFLATE_ERR_DATA;
+    while (repeat--) lengths[num++] = value;
+  }
+  if (lengths[256] == 0) return INFLATE_ERR_DATA; // No end of block code
+
+  if (!Build_Huffman(&d->litlen, lengths, hlit)) return INFLATE_ERR_DATA;
+  if (!Build_Huffman(&d->dist, lengths + hlit, hdist)) return INFLATE_ERR_DATA;
+  return INFLATE_OK;
+}
+
+static int Inflate_Block(Inflater *d) {
+/* *****************************************************************************
+   Inflate_Block
+
+   Decode one Huffman coded block with the current tables
+ * *****************************************************************************/
+  while (true) {
+    int sym = Decode_Symbol(d, &d->litlen);
+    if (sym < 0 || d->input_ended) return d->input_ended ? INFLATE_ERR_INPUT : INFLATE_ERR_DATA;
+
+    if (sym < 256) {
+      Put_Byte(d, (char)sym);
+      continue;
+    }
+    if (sym == 256) return INFLATE_OK;
+
+    sym -= 257;
+    if (sym >= 29) return INFLATE_ERR_DATA;
+    uint16_t length = length_base[sym] + Get_Bits(d, length_extra[sym]);
+
+    int dsym = Decode_Symbol(d, &d->dist);
+    if (dsym < 0 || dsym >= HUFF_DIST_CODES) return INFLATE_ERR_DATA;
+    uint32_t distance = dist_base[dsym] + Get_Bits(d, dist_extra[dsym]);
+    if (distance > d->window_mask + 1) return INFLATE_ERR_WINDOW;
+    if (distance > d->produced)        return INFLATE_ERR_DATA;
+
+    while (length--) Put_Byte(d, d->window[(d->produced - distance) & d->window_mask]);
+  }
+}
+
+static bool Skip_Zero_Terminated(Inflater *d) {
+/* *****************************************************************************
+   Skip_Zero_Terminated
+
+   Skip a file name or comment in the gzip header
+ * *****************************************************************************/
+  while (Next_Byte(d) != 0);
+  return !d->input_ended;
+}
+
+static int Gzip_Header(Inflater *d) {
+/* *****************************************************************************
+   Gzip_Header
+
+   Check and skip the gzip member header
+ * *****************************************************************************/
+  if (Next_Byte(d) != GZIP_ID1 || Next_Byte(d) != GZIP_ID2 ||
+      Next_Byte(d) != GZIP_CM_DEFLATE) return INFLATE_ERR_HEADER;
+  uint8_t flags = Next_Byte(d);
+  for (int i = 0; i < 6; i++) Next_Byte(d); // mtime, xfl, os
+
+  if (flags & GZIP_FEXTRA) {
+    uint16_t xlen = Next_Byte(d);
+    xlen         |= Next_Byte(d) << 8;
+    while (xlen-- && !d->input_ended) Next_Byte(d);
+  }
+  if ((flags & GZIP_FNAME)    && !Skip_Zero_Terminated(d)) return INFLATE_ERR_INPUT;
+  if ((flags & GZIP_FCOMMENT) && !Skip_Zero_Terminated(d)) return INFLATE_ERR_INPUT;
+  if (flags & GZIP_FHCRC) { Next_Byte(d); Next_Byte(d); }
+
+  return d->input_ended ? INFLATE_ERR_INPUT : INFLATE_OK;
+}
+
+int Gzip_Inflate(Inflate_ReadFn read_byte, Inflate_WriteFn write_byte, uint32_t window_size) {
+/* *****************************************************************************
+   Gzip_Inflate
+
+   Decompress one gzip member from read_byte into write_byte
+ * *****************************************************************************/
+  Inflater *d = (Inflater *)malloc(sizeof(Inflater));
+  if (d == NULL) return INFLATE_ERR_MEMORY;
+  d->window = (char *)malloc(window_size);
+  if (d->window == NULL) {
+    free(d);
+    return INFLATE_ERR_MEMORY;
+  }
+  d->read_byte   = read_byte;
+  d->write_byte  = write_byte;
+  d->bits        = 0;
+  d->bit_count   = 0;
+  d->input_ended = false;
+  d->window_mask = window_size - 1;
+  d->produced    = 0;
+  d->crc         = 0xffffffff;
+
+  int result = Gzip_Header(d);
+  bool last_block = false;
+  while (result == INFLATE_OK && !last_block) {
+    last_block = Get_Bits(d, 1);
+    switch (Get_Bits(d, 2)) {
+      case 0: result = Inflate_Stored(d); break;
+      case 1: Fixed_Tables(d);
+              result = Inflate_Block(d);
+              break;
+      case 2: result = Dynamic_Tables(d);
+              if (result == INFLATE_OK) result = Inflate_Block(d);
+              break;
+      default: result = INFLATE_ERR_DATA; break;
+    }
+    if (result == INFLATE_OK && d->input_ended) result = INFLATE_ERR_INPUT;
+  }
+
+  if (result == INFLATE_OK) { // Trailer: CRC32 and size of the original data
+    d->bits = 0;
+    d->bit_count = 0;
+    uint32_t crc  = 0, size = 0;
+    for (int i = 0; i < 4; i++) crc  |= (uint32_t)Next_Byte(d) << (8 * i);
+    for (int i = 0; i < 4; i++) size |= (uint32_t)Next_Byte(d) << (8 * i);
+    if (d->input_ended) result = INFLATE_ERR_INPUT;
+    else if (crc != ~d->crc || size != d->produced) result = INFLATE_ERR_CRC;
+  }
+
+  free(d->window);
+  free(d);
+  return result;
+}
@@ -0,0 +1,196 @@
+/* *****************************************************************************
+
+   Copyright (C) 2022 P.A.G.M. Zengers
+
+   Trace of the display bus, see LCDTrace.h
+
+   This program is free software: you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation, either version 3 of the License, or
+   (at your option) any later version.
+
+ * ****************************************************************************/
+
+#include "LCDTrace.h"
+
+#if LCD_TRACE_ENABLED
+
+#include <Arduino.h>
+#include <LittleFS.h>
+#include "Log.h"
+
+#define LCD_CASET                  0x2A  // Column address set
+#define LCD_RASET                  0x2B  // Row address set
+#define LCD_RAMWR                  0x2C  // Memory write, pixels follow
+
+struct LCD_Trace_Opcode {
+  uint8_t  opcode;
+  uint32_t count;                        // Times sent
+  uint32_t bytes;                        // Data bytes after it
+};
+
+bool lcd_trace_on = false;
+
+static LCD_Trace_Entry  trace[LCD_TRACE_ENTRIES]; // Not yet in the file
+static uint16_t         trace_buffered;
+static File             trace_file;
+static uint32_t         trace_paused;    // Cycles spent writing the file
+
+static LCD_Trace_Opcode trace_opcodes[LCD_TRACE_OPCODES];
+static uint8_t          trace_opcode_count;
+static int16_t          trace_opcode = -1; // Of the last command, -1 when not counted
+
+static uint32_t         trace_count, trace_first, trace_last;
+static uint16_t         trace_window[2][2];  // Columns and rows as set, start and end
+static uint8_t          trace_params[4];
+static uint8_t          trace_param_count;
+static uint8_t          trace_command;
+static bool             trace_have_pixel;
+static uint16_t         trace_pixel;
+static uint32_t         trace_windows, trace_redundant, trace_single, trace_pixels, trace_repeated;
+static uint32_t         trace_gaps, trace_gap_total, trace_gap_max;
+
+static void Trace_Flush() {
+/* *****************************************************************************
+   Trace_Flush
+
+   Write the buffered entries to the file, and leave the time it took out of
+   the trace
+ * *****************************************************************************/
+  uint32_t start = ESP.getCycleCount();
+  if (trace_file) trace_file.write((const uint8_t *)trace, trace_buffered * sizeof(LCD_Trace_Entry));
+  trace_buffered = 0;
+  trace_paused += ESP.getCycleCount() - start;
+}
+
+static void Trace_Opcode(uint8_t opcode) {
+  trace_opcode = -1;
+  for (uint8_t i = 0; i < trace_opcode_count; i++) {
+    if (trace_opcodes[i].opcode == opcode) trace_opcode = i;
+  }
+  if (trace_opcode < 0 && trace_opcode_count < LCD_TRACE_OPCODES) {
+    trace_opcode = trace_opcode_count++;
+    trace_opcodes[trace_opcode] = { opcode, 0, 0 };
+  }
+  if (trace_opcode >= 0) trace_opcodes[trace_opcode].count++;
+}
+
+void LCD_Trace_Add(uint8_t kind, uint16_t value) {
+/* *****************************************************************************
+   LCD_Trace_Add
+
+   Decode one write: count its command, follow the address window and the
+   pixels, and time the gap since the write before
+ * *****************************************************************************/
+  uint32_t cycles = ESP.getCycleCount() - trace_paused;
+  if (trace_count == 0) {
+    trace_first = cycles;
+  } else {
+    uint32_t us = (cycles - trace_last) / ESP.getCpuFreqMHz();
+    if (us > LCD_TRACE_GAP_US) {
+      trace_gaps++;
+      trace_gap_total += us;
+      if (us > trace_gap_max) trace_gap_max = us;
+    }
+  }
+  trace_last = cycles;
+  trace_count++;
+
+  if (trace_file) {
+    trace[trace_buffered++] = { cycles, value, kind, 0 };
+    if (trace_buffered == LCD_TRACE_ENTRIES) Trace_Flush();
+  }
+
+  if (kind == LCD_TRACE_COMMAND) {
+    trace_command = value;
+    trace_param_count = 0;
+    Trace_Opcode(value);
+    if (trace_command == LCD_RAMWR && trace_window[0][0] == trace_window[0][1] &&
+        trace_window[1][0] == trace_window[1][1]) trace_single++;
+    return;
+  }
+  if (trace_opcode >= 0) trace_opcodes[trace_opcode].bytes += kind == LCD_TRACE_WORD ? 2 : 1;
+
+  if (trace_command == LCD_CASET || trace_command == LCD_RASET) {
+    if (kind == LCD_TRACE_WORD && trace_param_count < 4) trace_params[trace_param_count++] = value >> 8;
+    if (trace_param_count < 4) trace_params[trace_param_count++] = value;
+    if (trace_param_count == 4) {
+      uint16_t *set = trace_window[trace_command - LCD_CASET];
+      uint16_t start = trace_params[0] << 8 | trace_params[1],
+               end   = trace_params[2] << 8 | trace_params[3];
+      if (trace_command == LCD_CASET) trace_windows++;
+      if (set[0] == start && set[1] == end) trace_redundant++;
+      set[0] = start;
+      set[1] = end;
+      trace_param_count++; // Done with this one
+    }
+  } else if (trace_command == LCD_RAMWR && kind == LCD_TRACE_WORD) {
+    trace_pixels++;
+    if (trace_have_pixel && value == trace_pixel) trace_repeated++;
+    trace_pixel = value;
+    trace_have_pixel = true;
+  }
+}
+
+void LCD_Trace_Start(const char *path) {
+/* *****************************************************************************
+   LCD_Trace_Start
+
+   Clear the counts and start tracing. The window is unknown until the
+   first CASET and RASET, pixel writes before the first RAMWR still count
+ * *****************************************************************************/
+  trace_count = trace_paused = 0;
+  trace_windows = trace_redundant = trace_single = trace_pixels = trace_repeated = 0;
+  trace_gaps = trace_gap_total = trace_gap_max = 0;
+  memset(trace_window, 0xFF, sizeof(trace_window));
+  trace_param_count  = 0;
+  trace_command      = LCD_RAMWR;
+  trace_have_pixel   = false;
+  trace_opcode_count = 0;
+  trace_opcode       = -1;
+
+  trace_buffered = 0;
+  if (path) {
+    trace_file = LittleFS.open(path, "w");
+    if (!trace_file) LOG_ERROR("Trace can not write %s", path);
+  }
+  lcd_trace_on = true;
+}
+
+void LCD_Trace_Stop() {
+  lcd_trace_on = false;
+  if (trace_file) {
+    Trace_Flush();
+    trace_file.close();
+  }
+}
+
+void LCD_Trace_Report(const char *name) {
+/* *****************************************************************************
+   LCD_Trace_Report
+
+   Log what could be saved, then the commands with the most data first
+ * *****************************************************************************/
+  uint32_t span = trace_count > 0 ? (trace_last - trace_first) / ESP.getCpuFreqMHz() : 0;
+  LOG_INFO("Trace %s; %lu writes in %lu us", name, trace_count, span);
+  LOG_INFO("Trace %s; %lu windows, %lu address sets redundant, %lu single pixel",
+           name, trace_windows, trace_redundant, trace_single);
+  LOG_INFO("Trace %s; %lu pixels, %lu same as the one before", name, trace_pixels, trace_repeated);
+  LOG_INFO("Trace %s; %lu idle gaps over %d us, %lu us in total, longest %lu us",
+           name, trace_gaps, LCD_TRACE_GAP_US, trace_gap_total, trace_gap_max);
+
+  bool reported[LCD_TRACE_OPCODES] = {};
+  for (uint8_t n = 0; n < trace_opcode_count; n++) {
+    int8_t most = -1;
+    for (uint8_t i = 0; i < trace_opcode_count; i++) {
+      if (!reported[i] && (most < 0 || trace_opcodes[i].bytes > trace_opcodes[most].bytes)) most = i;
+    }
+    reported[most] = true;
+    LOG_INFO("Trace %s; command %02X %lu times, %lu data bytes",
+             name, trace_opcodes[most].opcode, trace_opcodes[most].count, trace_opcodes[most].bytes);
+  }
+  if (trace_opcode_count == LCD_TRACE_OPCODES) LOG_WARN("Trace %s; more than %d commands, the rest is not counted",
+                                                        name, LCD_TRACE_OPCODES);
+}
+
+#endif
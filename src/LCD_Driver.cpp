@@ -28,6 +28,20 @@
 #
 ******************************************************************************/
 #include "LCD_Driver.h"
+#include "Profile.h"
+#include "LCDStats.h"
+#include "LCDTrace.h"
+
+LCD_Stats lcd_stats;
+
+/*******************************************************************************
+function:
+    Reset the bus counters, see LCDStats.h
+*******************************************************************************/
+void LCD_Stats_Reset()
+{
+  memset(&lcd_stats, 0, sizeof(lcd_stats));
+}
 
 /*******************************************************************************
 function:
@@ -66,6 +80,8 @@ void LCD_WriteData_Byte(UBYTE da)
   DEV_Digital_Write(DEV_DC_PIN, 1);
   DEV_SPI_WRITE(da);
   DEV_Digital_Write(DEV_CS_PIN, 1);
+  lcd_stats.bytes++;
+  LCD_TRACE(LCD_TRACE_BYTE, da);
 }  
 
  void LCD_WriteData_Word(UWORD da)
@@ -76,6 +92,8 @@ void LCD_WriteData_Byte(UBYTE da)
   DEV_SPI_WRITE(da>>8);
   DEV_SPI_WRITE(da);
   DEV_Digital_Write(DEV_CS_PIN, 1);
+  lcd_stats.bytes += 2;
+  LCD_TRACE(LCD_TRACE_WORD, da);
 }   
 
 void LCD_WriteReg(UBYTE da)  
@@ -85,6 +103,9 @@ void LCD_WriteReg(UBYTE da)
   DEV_Digital_Write(DEV_DC_PIN, 0);
   DEV_SPI_WRITE(da);
   //DEV_Digital_Write(DEV_CS_PIN,1);
+  lcd_stats.bytes++;
+  lcd_stats.commands++;
+  LCD_TRACE(LCD_TRACE_COMMAND, da);
 }
 
 /******************************************************************************
@@ -343,6 +364,7 @@ parameter :
 ******************************************************************************/
 void LCD_SetCursor(UWORD Xstart, UWORD Ystart, UWORD Xend, UWORD  Yend)
 { 
+  lcd_stats.windows++;
   LCD_WriteReg(0x2a);
   LCD_WriteData_Byte(0x00);
   LCD_WriteData_Byte(Xstart);
@@ -365,6 +387,7 @@ parameter :
 ******************************************************************************/
 void LCD_Clear(UWORD Color)
 {
+  PROFILE("LCD_Clear");
   UWORD i,j;    
   LCD_SetCursor(0,0,LCD_WIDTH-1,LCD_HEIGHT-1);
   for(i = 0; i < LCD_WIDTH; i++){
@@ -385,6 +408,7 @@ parameter :
 ******************************************************************************/
 void LCD_ClearWindow(UWORD Xstart, UWORD Ystart, UWORD Xend, UWORD Yend,UWORD color)
 {          
+  PROFILE("LCD_ClearWindow");
   UWORD i,j; 
   LCD_SetCursor(Xstart, Ystart, Xend-1,Yend-1);
   for(i = Ystart; i <= Yend-1; i++){                                
@@ -0,0 +1,116 @@
+/* *****************************************************************************
+
+   Copyright (C) 2022 P.A.G.M. Zengers
+
+   Non blocking serial logger, see Log.h
+
+   This program is free software: you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation, either version 3 of the License, or
+   (at your option) any later version.
+
+ * ****************************************************************************/
+
+#include "Log.h"
+
+struct Log_Entry {
+  const char    *format;                 // In flash
+  unsigned long  time;                   // millis() when logged
+  uint8_t        level;
+  uint8_t        count;                  // Arguments used
+  uintptr_t      args[LOG_ARGS];
+};
+
+static Log_Entry     log_ring[LOG_ENTRIES];
+static uint8_t       log_head = 0,       // Next entry to write
+                     log_tail = 0,       // Next entry to send
+                     log_used = 0;
+static unsigned long log_dropped = 0,    // Messages lost since the start
+                     log_dropped_told = 0; // Part of those we already reported
+static char          log_line[LOG_LINE_LENGTH];
+static uint16_t      log_line_length = 0,
+                     log_line_sent = 0;
+
+static const char    log_levels[] = "-EWID";
+
+void Log_Push(uint8_t level, const char *format, const uintptr_t *args, uint8_t count) {
+/* *****************************************************************************
+   Log_Push
+
+   Store a message for later. Never waits; a full ring drops the message
+ * *****************************************************************************/
+  if (log_used == LOG_ENTRIES) {
+    log_dropped++;
+    return;
+  }
+  Log_Entry &entry = log_ring[log_head];
+  entry.format = format;
+  entry.time   = millis();
+  entry.level  = level;
+  entry.count  = min(count, (uint8_t)LOG_ARGS);
+  for (uint8_t i = 0; i < entry.count; i++) entry.args[i] = args[i];
+  for (uint8_t i = entry.count; i < LOG_ARGS; i++) entry.args[i] = 0;
+
+  log_head = (log_head + 1) % LOG_ENTRIES;
+  log_used++;
+}
+
+static bool Log_Format() {
+/* *****************************************************************************
+   Log_Format
+
+   Format the oldest message into log_line. Returns false if there is none
+ * *****************************************************************************/
+  if (log_dropped != log_dropped_told) { // Tell first that we lost messages
+    log_line_length = snprintf_P(log_line, LOG_LINE_LENGTH, PSTR("%8lu W %lu log messages dropped\r\n"),
+                                 millis(), log_dropped - log_dropped_told);
+    log_dropped_told = log_dropped;
+  } else {
+    if (log_used == 0) return false;
+    const Log_Entry &entry = log_ring[log_tail];
+    int length = snprintf_P(log_line, LOG_LINE_LENGTH, PSTR("%8lu %c "), entry.time, log_levels[entry.level]);
+    length += snprintf_P(log_line + length, LOG_LINE_LENGTH - length, entry.format,
+                         entry.args[0], entry.args[1], entry.args[2], entry.args[3], entry.args[4], entry.args[5]);
+    length = min(length, LOG_LINE_LENGTH - 3);
+    log_line[length++] = '\r';
+    log_line[length++] = '\n';
+    log_line_length = length;
+    log_tail = (log_tail + 1) % LOG_ENTRIES;
+    log_used--;
+  }
+  log_line_sent = 0;
+  return true;
+}
+
+void Log_Drain() {
+/* *****************************************************************************
+   Log_Drain
+
+   Send as much as the UART transmit FIFO takes without waiting. Call often
+ * *****************************************************************************/
+  while (true) {
+    if (log_line_sent == log_line_length && !Log_Format()) return;
+    int room = Serial.availableForWrite();
+    if (room <= 0) return;
+    int chunk = min(room, log_line_length - log_line_sent);
+    Serial.write((const uint8_t *)log_line + log_line_sent, chunk);
+    log_line_sent += chunk;
+  }
+}
+
+void Log_Flush() {
+/* *****************************************************************************
+   Log_Flush
+
+   Send everything that is waiting, for when we are about to block or reset
+ * *****************************************************************************/
+  while (log_used > 0 || log_line_sent < log_line_length || log_dropped != log_dropped_told) {
+    Log_Drain();
+    yield();
+  }
+  Serial.flush();
+}
+
+unsigned long Log_Dropped() {
+  return log_dropped;
+}
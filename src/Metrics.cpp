@@ -0,0 +1,96 @@
+/* *****************************************************************************
+
+   Copyright (C) 2022 P.A.G.M. Zengers
+
+   Prometheus metrics writer, see Metrics.h
+
+   This program is free software: you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation, either version 3 of the License, or
+   (at your option) any later version.
+
+ * ****************************************************************************/
+
+#include <stdarg.h>
+#include "Metrics.h"
+#include "Log.h"
+
+static ESP8266WebServer *metrics_server = NULL;
+static char              metrics_chunk[METRICS_CHUNK_SIZE];
+static uint16_t          metrics_used = 0;
+
+static void Metrics_Send() {
+/* *****************************************************************************
+   Metrics_Send
+
+   Send what is in the buffer as one chunk
+ * *****************************************************************************/
+  if (metrics_used == 0) return;
+  metrics_server->sendContent(metrics_chunk, metrics_used);
+  metrics_used = 0;
+}
+
+void Metrics_Line(const char *format, ...) {
+/* *****************************************************************************
+   Metrics_Line
+
+   Format one line (format in flash) straight into the buffer. When it does
+   not fit behind what is there, the buffer is sent first and the line is
+   formatted again into the empty buffer. Only a line longer than the whole
+   buffer is cut, and that is logged
+ * *****************************************************************************/
+  va_list args, again;
+  va_start(args, format);
+  va_copy(again, args);
+  int length = vsnprintf_P(metrics_chunk + metrics_used, METRICS_CHUNK_SIZE - metrics_used, format, args);
+  if (length >= METRICS_CHUNK_SIZE - metrics_used) { // Room for the terminating zero as well
+    Metrics_Send();
+    length = vsnprintf_P(metrics_chunk, METRICS_CHUNK_SIZE, format, again);
+    if (length >= METRICS_CHUNK_SIZE) {
+      LOG_WARN("Metrics line of %d characters cut to %d", length, METRICS_CHUNK_SIZE - 1);
+      length = METRICS_CHUNK_SIZE - 1;
+    }
+  }
+  va_end(again);
+  va_end(args);
+  if (length > 0) metrics_used += length;
+}
+
+void Metrics_Start(ESP8266WebServer &server, const char *type) {
+  metrics_server = &server;
+  metrics_used = 0;
+  server.setContentLength(CONTENT_LENGTH_UNKNOWN); // Chunked
+  server.send(200, type, "");
+}
+
+void Metrics_Header(const char *name, const char *type, const char *help) {
+  Metrics_Line(PSTR("# HELP %s %s\n# TYPE %s %s\n"), name, help, name, type);
+}
+
+void Metrics_Value(const char *name, const char *labels, long value) {
+  if (labels) Metrics_Line(PSTR("%s{%s} %ld\n"), name, labels, value);
+  else        Metrics_Line(PSTR("%s %ld\n"), name, value);
+}
+
+void Metrics_Unsigned(const char *name, const char *labels, unsigned long value) {
+  if (labels) Metrics_Line(PSTR("%s{%s} %lu\n"), name, labels, value);
+  else        Metrics_Line(PSTR("%s %lu\n"), name, value);
+}
+
+void Metrics_Micros(const char *name, const char *labels, uint64_t us) {
+  unsigned long seconds  = us / 1000000,
+                fraction = us % 1000000;
+  if (labels) Metrics_Line(PSTR("%s{%s} %lu.%06lu\n"), name, labels, seconds, fraction);
+  else        Metrics_Line(PSTR("%s %lu.%06lu\n"), name, seconds, fraction);
+}
+
+void Metrics_End() {
+/* *****************************************************************************
+   Metrics_End
+
+   Send the rest and the empty chunk that ends the response
+ * *****************************************************************************/
+  Metrics_Send();
+  metrics_server->sendContent("");
+  metrics_server = NULL;
+}
@@ -0,0 +1,98 @@
+/* *****************************************************************************
+
+   Copyright (C) 2022 P.A.G.M. Zengers
+
+   Data that survives a power cycle, see Persist.h
+
+   This program is free software: you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation, either version 3 of the License, or
+   (at your option) any later version.
+
+ * ****************************************************************************/
+
+#include <Arduino.h>
+#include <LittleFS.h>
+#include "Persist.h"
+#include "Log.h"
+
+struct Persist_Header {
+  uint32_t magic;
+  uint16_t size;                         // Bytes of data after the header
+  uint16_t checksum;                     // Fletcher-16 of the data
+};
+
+static bool persist_mounted = false;
+
+static uint16_t Persist_Checksum(const void *data, uint16_t size) {
+  const uint8_t *p = (const uint8_t *)data;
+  uint16_t sum1 = 0, sum2 = 0;
+  for (uint16_t i = 0; i < size; i++) {
+    sum1 = (sum1 + p[i]) % 255;
+    sum2 = (sum2 + sum1) % 255;
+  }
+  return (sum2 << 8) | sum1;
+}
+
+bool Persist_Begin() {
+/* *****************************************************************************
+   Persist_Begin
+
+   Mount the file system, formatting it the first time
+ * *****************************************************************************/
+  persist_mounted = LittleFS.begin();
+  if (!persist_mounted) {
+    LOG_WARN("LittleFS not mounted; formatting");
+    persist_mounted = LittleFS.format() && LittleFS.begin();
+  }
+  if (!persist_mounted) LOG_ERROR("LittleFS not available; nothing is kept over a restart");
+  return persist_mounted;
+}
+
+bool Persist_Save(const char *path, const void *data, uint16_t size) {
+/* *****************************************************************************
+   Persist_Save
+
+   Write data to path, replacing what was there only when written completely
+ * *****************************************************************************/
+  if (!persist_mounted) return false;
+  char temp[32];
+  snprintf_P(temp, sizeof(temp), PSTR("%s.tmp"), path);
+
+  Persist_Header header = { PERSIST_MAGIC, size, Persist_Checksum(data, size) };
+  File file = LittleFS.open(temp, "w");
+  if (!file) return false;
+  bool ok = file.write((const uint8_t *)&header, sizeof(header)) == sizeof(header) &&
+            file.write((const uint8_t *)data, size) == size;
+  file.close();
+  if (ok) {
+    LittleFS.remove(path);
+    ok = LittleFS.rename(temp, path);
+  }
+  if (!ok) LOG_WARN("Could not save %s", path);
+  return ok;
+}
+
+bool Persist_Load(const char *path, void *data, uint16_t size) {
+/* *****************************************************************************
+   Persist_Load
+
+   Read data saved by Persist_Save. Returns false, with data cleared, if the
+   file is missing or does not match
+ * *****************************************************************************/
+  memset(data, 0, size);
+  if (!persist_mounted || !LittleFS.exists(path)) return false;
+  File file = LittleFS.open(path, "r");
+  if (!file) return false;
+
+  Persist_Header header;
+  bool ok = file.read((uint8_t *)&header, sizeof(header)) == sizeof(header) &&
+            header.magic == PERSIST_MAGIC && header.size == size;
+  if (ok) ok = file.read((uint8_t *)data, size) == size && Persist_Checksum(data, size) == header.checksum;
+  file.close();
+  if (!ok) {
+    memset(data, 0, size);
+    LOG_WARN("Ignoring %s; not written by this version or damaged", path);
+  }
+  return ok;
+}
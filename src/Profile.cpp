@@ -0,0 +1,73 @@
+/* *****************************************************************************
+
+   Copyright (C) 2022 P.A.G.M. Zengers
+
+   Scoped profiling timers, see Profile.h
+
+   This program is free software: you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation, either version 3 of the License, or
+   (at your option) any later version.
+
+ * ****************************************************************************/
+
+#include "Profile.h"
+
+#if PROFILE_ENABLED
+
+#include "Log.h"
+
+static Profile_Site *profile_sites = NULL; // Newest site first
+
+void Profile_Add(Profile_Site &site, uint32_t cycles) {
+/* *****************************************************************************
+   Profile_Add
+
+   Account one call of a site that took the given number of cycles
+ * *****************************************************************************/
+  if (site.count == 0) {
+    site.next = profile_sites;
+    profile_sites = &site;
+    site.min = cycles;
+  }
+  site.count++;
+  site.total += cycles;
+  if (cycles < site.min) site.min = cycles;
+  if (cycles > site.max) site.max = cycles;
+
+  uint8_t bucket = cycles ? 31 - __builtin_clz(cycles) : 0;
+  if (site.histogram[bucket] < UINT16_MAX) site.histogram[bucket]++;
+}
+
+static uint32_t Profile_Percentile(const Profile_Site &site, uint8_t percent) {
+/* *****************************************************************************
+   Profile_Percentile
+
+   Upper bound in cycles of the bucket in which the given percentage of the
+   calls is reached. Buckets that saturated make this an estimate
+ * *****************************************************************************/
+  uint32_t total = 0, seen = 0;
+  for (uint8_t i = 0; i < PROFILE_BUCKETS; i++) total += site.histogram[i];
+  uint32_t wanted = (total * percent + 99) / 100;
+  for (uint8_t i = 0; i < PROFILE_BUCKETS; i++) {
+    seen += site.histogram[i];
+    if (seen >= wanted) return i == 31 ? UINT32_MAX : 2UL << i;
+  }
+  return site.max;
+}
+
+void Profile_Report() {
+/* *****************************************************************************
+   Profile_Report
+
+   Write one line per site to the log, times in microseconds since the start
+ * *****************************************************************************/
+  uint32_t mhz = ESP.getCpuFreqMHz();
+  for (const Profile_Site *site = profile_sites; site != NULL; site = site->next) {
+    LOG_INFO("Profile %-14s n %lu; min %lu, avg %lu, max %lu, p90 < %lu us",
+             site->name, site->count, site->min / mhz, (uint32_t)(site->total / site->count / mhz),
+             site->max / mhz, Profile_Percentile(*site, 90) / mhz);
+  }
+}
+
+#endif
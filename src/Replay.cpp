@@ -0,0 +1,379 @@
+/* *****************************************************************************
+
+   Copyright (C) 2022 P.A.G.M. Zengers
+
+   Record and replay of the HTTPS responses, see Replay.h
+
+   This program is free software: you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation, either version 3 of the License, or
+   (at your option) any later version.
+
+ * ****************************************************************************/
+
+#include "Replay.h"
+
+#if REPLAY_MODE != REPLAY_OFF
+
+#include <stdarg.h>
+#include "Log.h"
+
+static const char *replay_hosts[REPLAY_HOSTS];
+static uint8_t     replay_slots[REPLAY_HOSTS]; // Next slot per host
+
+int Replay_Client::Slot(const char *host) {
+/* *****************************************************************************
+   Replay_Client::Slot
+
+   Take the next slot of the host, going round through REPLAY_FILES. Slots
+   start at 0 again after a restart
+ * *****************************************************************************/
+  for (uint8_t i = 0; i < REPLAY_HOSTS; i++) {
+    if (replay_hosts[i] == NULL) replay_hosts[i] = host;
+    if (strcmp(replay_hosts[i], host) != 0) continue;
+    uint8_t slot = replay_slots[i];
+    replay_slots[i] = (slot + 1) % REPLAY_FILES;
+    return slot;
+  }
+  return -1;
+}
+
+void Replay_Client::Path(char *path, uint8_t slot, bool temporary) {
+  sprintf(path, REPLAY_DIR "%s.%d%s", host, slot, temporary ? ".tmp" : "");
+}
+
+#if REPLAY_MODE == REPLAY_RECORD
+
+void Replay_Client::setInsecure()                        { client.setInsecure(); }
+void Replay_Client::setBufferSizes(int recv, int xmit)   { client.setBufferSizes(recv, xmit); }
+bool Replay_Client::getMFLNStatus()                      { return client.getMFLNStatus(); }
+int  Replay_Client::getLastSSLError()                    { return client.getLastSSLError(); }
+uint8_t Replay_Client::connected()                       { return client.connected(); }
+int  Replay_Client::available()                          { return client.available(); }
+int  Replay_Client::peek()                               { return client.peek(); }
+
+bool Replay_Client::probeMaxFragmentLength(const char *host, uint16_t port, uint16_t length) {
+  return client.probeMaxFragmentLength(host, port, length);
+}
+
+int Replay_Client::connect(const char *name, uint16_t port) {
+  client.setTimeout(getTimeout());
+  if (!client.connect(name, port)) return 0;
+
+  host = name;
+  int next = Slot(host);
+  char path[48];
+  Path(path, next, true);
+  file = LittleFS.open(path, "w+"); // Read back for the status at the end
+  open = next >= 0 && file;
+  if (!open) LOG_WARN("Replay cannot record %s", host);
+  slot = next;
+  memset(&header, 0, sizeof(header));
+  if (open) file.write((const uint8_t *)&header, sizeof(header)); // Filled in when complete
+  position = 0;
+  return 1;
+}
+
+size_t Replay_Client::write(uint8_t c) {
+  return write(&c, 1);
+}
+
+size_t Replay_Client::write(const uint8_t *buffer, size_t size) {
+  requested = millis();
+  return client.write(buffer, size);
+}
+
+int Replay_Client::read() {
+  int c = client.read();
+  if (c < 0 || !open) return c;
+  if (position == 0) header.ttfb = millis() - requested;
+  file.write((uint8_t)c);
+  position++;
+  return c;
+}
+
+void Replay_Client::stop() {
+/* *****************************************************************************
+   Replay_Client::stop
+
+   End of the response. Keep it when it was a 200, in place of the oldest
+   recording in this slot
+ * *****************************************************************************/
+  client.stop();
+  if (!open) return;
+  open = false;
+
+  header.magic    = REPLAY_MAGIC;
+  header.size     = position;
+  header.received = millis();
+  header.duration = header.received - requested;
+  file.seek(0);
+  file.write((const uint8_t *)&header, sizeof(header));
+  file.seek(sizeof(header));
+  char status[13] = "";
+  file.readBytes(status, sizeof(status) - 1);
+  file.close();
+
+  char temporary[48], path[48];
+  Path(temporary, slot, true);
+  Path(path, slot, false);
+  if (strncmp(status + 8, " 200", 4) != 0) { // "HTTP/1.1 200"
+    LittleFS.remove(temporary);
+    return;
+  }
+  LittleFS.remove(path);
+  LittleFS.rename(temporary, path);
+  LOG_INFO("Replay recorded %s; %lu bytes, first after %lu ms, all after %lu ms",
+           path, header.size, header.ttfb, header.duration);
+  Log_Flush(); // path is gone after we return
+}
+
+#else // REPLAY_PLAY
+
+static uint32_t replay_random = REPLAY_SEED;
+static uint8_t  replay_fault = REPLAY_FAULT_NONE; // Of the last connect
+static bool     replay_refused = false;  // The connect before was refused, let the retry through
+static uint32_t replay_passed = 0,
+                replay_failed = 0;
+
+static const char *Replay_Fault_Name(uint8_t fault) {
+  switch (fault) {
+    case REPLAY_FAULT_REFUSED:      return "refused connection";
+    case REPLAY_FAULT_NOT_MODIFIED: return "304";
+    case REPLAY_FAULT_TRUNCATED:    return "cut off body";
+    case REPLAY_FAULT_MFLN_DROPPED: return "MFLN dropped";
+    default:                        return "no fault";
+  }
+}
+
+static uint8_t Replay_Fault() {
+  replay_random = replay_random * 1103515245 + 12345; // Same faults for the same seed
+  uint8_t chance = (replay_random >> 16) % 100;
+  if (chance < REPLAY_FAULT_REFUSE) return REPLAY_FAULT_REFUSED;
+  chance -= REPLAY_FAULT_REFUSE;
+  if (chance < REPLAY_FAULT_304) return REPLAY_FAULT_NOT_MODIFIED;
+  chance -= REPLAY_FAULT_304;
+  if (chance < REPLAY_FAULT_TRUNCATE) return REPLAY_FAULT_TRUNCATED;
+  chance -= REPLAY_FAULT_TRUNCATE;
+  if (chance < REPLAY_FAULT_MFLN) return REPLAY_FAULT_MFLN_DROPPED;
+  return REPLAY_FAULT_NONE;
+}
+
+void Replay_Client::setInsecure()                        {}
+void Replay_Client::setBufferSizes(int recv, int xmit)   { rx_buffer = recv; }
+bool Replay_Client::getMFLNStatus()                      { return mfln; }
+int  Replay_Client::getLastSSLError()                    { return ssl_error; }
+
+bool Replay_Client::probeMaxFragmentLength(const char *host, uint16_t port, uint16_t length) {
+  return REPLAY_MFLN;
+}
+
+void Replay_Client::Queue(const char *format, ...) {
+  va_list args;
+  va_start(args, format);
+  pending_length = min(vsnprintf_P(pending, sizeof(pending), format, args), (int)sizeof(pending) - 1);
+  va_end(args);
+  pending_next = 0;
+}
+
+int Replay_Client::connect(const char *name, uint16_t port) {
+/* *****************************************************************************
+   Replay_Client::connect
+
+   Open the next recording of the host, skipping slots that were never
+   recorded, and decide on the fault. Fails when there is no recording at all,
+   and with small buffers when the server does not take MFLN
+ * *****************************************************************************/
+  stop();
+  host = name;
+  ssl_error = 0;
+  mfln = false;
+  if (!replay_refused) replay_fault = Replay_Fault();
+  if (replay_fault == REPLAY_FAULT_REFUSED && !replay_refused) {
+    replay_refused = true;
+    LOG_INFO("Replay %s; refused connection", host);
+    return 0;
+  }
+  replay_refused = false;
+  if (rx_buffer < REPLAY_FULL_BUFFER) {
+    if (!REPLAY_MFLN || replay_fault == REPLAY_FAULT_MFLN_DROPPED) {
+      ssl_error = REPLAY_SSL_TOO_LARGE;
+      LOG_INFO("Replay %s; MFLN not accepted, records too large for the buffers", host);
+      return 0;
+    }
+    mfln = true;
+  }
+
+  for (uint8_t tries = 0; tries < REPLAY_FILES && !open; tries++) {
+    int next = Slot(host);
+    if (next < 0) break;
+    char path[48];
+    Path(path, next, false);
+    file = LittleFS.open(path, "r");
+    if (!file) continue;
+    open = file.readBytes((char *)&header, sizeof(header)) == sizeof(header) && header.magic == REPLAY_MAGIC;
+    if (!open) file.close();
+    slot = next;
+  }
+  if (!open) {
+    LOG_WARN("Replay has no recording of %s", host);
+    return 0;
+  }
+
+  // Find where the body starts, whether it was chunked already and the Content-Length
+  char text[128];
+  bool chunked = false;
+  size_t length;
+  length_size = 0;
+  do {
+    uint32_t line = file.position() - sizeof(header);
+    length = file.readBytesUntil('\n', text, sizeof(text) - 1);
+    text[length] = '\0';
+    if (strncasecmp_P(text, PSTR("Transfer-Encoding:"), 18) == 0 && strstr_P(text, PSTR("chunked"))) chunked = true;
+    if (strncasecmp_P(text, PSTR("Content-Length:"), 15) == 0) {
+      length_at   = line;
+      length_size = file.position() - sizeof(header) - line;
+    }
+  } while (length > 1 && file.position() < sizeof(header) + header.size);
+  body_start = file.position() - sizeof(header);
+  file.seek(sizeof(header));
+
+  position   = 0;
+  end        = header.size;
+  sent       = 0;
+  chunk_left = 0;
+  in_body    = false;
+  done       = false;
+  chunking   = REPLAY_CHUNKED && !chunked;
+  have_lookahead = false;
+  pending_length = pending_next = 0;
+  if (replay_fault == REPLAY_FAULT_NOT_MODIFIED) {
+    Queue(PSTR("HTTP/1.1 304 Not Modified\r\nConnection: close\r\n\r\n"));
+    end = 0;
+  }
+  if (replay_fault == REPLAY_FAULT_TRUNCATED) end = body_start + (header.size - body_start) / 2;
+
+  LOG_INFO("Replay %s slot %d; %lu bytes recorded %lu ms after that start, %s",
+           host, slot, header.size, header.received, Replay_Fault_Name(replay_fault));
+  requested = millis();
+  return 1;
+}
+
+int Replay_Client::Next() {
+/* *****************************************************************************
+   Replay_Client::Next
+
+   The next byte of the response, -1 at the end. Made up bytes (a 304, the
+   chunk sizes) go before the rest of the recording
+ * *****************************************************************************/
+  if (pending_next < pending_length) return pending[pending_next++];
+  if (done) return -1;
+
+  if (chunking && length_size > 0 && position == length_at) { // A length does not go with chunks
+    position += length_size;
+    file.seek(sizeof(header) + position);
+    length_size = 0;
+  }
+  if (chunking && !in_body && position + 2 == body_start) { // The blank line after the headers is next
+    in_body = true;
+    Queue(PSTR("Transfer-Encoding: chunked\r\n"));
+    return Next();
+  }
+  if (chunking && position >= body_start && chunk_left == 0) {
+    uint32_t size  = min((uint32_t)REPLAY_CHUNK_SIZE, end - position);
+    bool     first = (position == body_start);
+    if (size == 0) {
+      done = true;
+      if (replay_fault == REPLAY_FAULT_TRUNCATED) return -1; // Gone, as by a reset
+      Queue(first ? PSTR("0\r\n\r\n") : PSTR("\r\n0\r\n\r\n"));
+      return Next();
+    }
+    Queue(first ? PSTR("%lx\r\n") : PSTR("\r\n%lx\r\n"), size);
+    chunk_left = size;
+    return Next();
+  }
+
+  int c = position < end ? file.read() : -1;
+  if (c < 0) {
+    done = true;
+    return -1;
+  }
+  position++;
+  if (chunk_left > 0) chunk_left--;
+  return c;
+}
+
+size_t Replay_Client::write(uint8_t c) {
+  requested = millis();
+  return 1;
+}
+
+size_t Replay_Client::write(const uint8_t *buffer, size_t size) {
+  requested = millis(); // The request itself does not matter, we always answer with the recording
+  return size;
+}
+
+uint8_t Replay_Client::connected() {
+  if (!open) return 0;
+  if (!have_lookahead) {
+    lookahead = Next();
+    have_lookahead = true;
+  }
+  return lookahead >= 0;
+}
+
+int Replay_Client::available() {
+/* *****************************************************************************
+   Replay_Client::available
+
+   Whether a byte has arrived by now: nothing until REPLAY_LATENCY_MS after
+   the request, then REPLAY_BANDWIDTH bytes per second. Only says 1, the
+   length of what is left is not known with chunks made up on the way
+ * *****************************************************************************/
+  if (!connected()) return 0;
+  uint32_t elapsed = millis() - requested;
+  if (elapsed < REPLAY_LATENCY_MS) return 0;
+  if (REPLAY_BANDWIDTH > 0 && (uint64_t)(elapsed - REPLAY_LATENCY_MS) * REPLAY_BANDWIDTH / 1000 < sent) return 0;
+  return 1;
+}
+
+int Replay_Client::read() {
+  if (available() <= 0) return -1;
+  have_lookahead = false;
+  sent++;
+  return lookahead;
+}
+
+int Replay_Client::peek() {
+  if (available() <= 0) return -1;
+  return lookahead;
+}
+
+void Replay_Client::stop() {
+  if (open) file.close();
+  open = false;
+}
+
+void Replay_Check(const char *host, bool ok) {
+/* *****************************************************************************
+   Replay_Check
+
+   Compare the outcome of a fetch with what the fault should lead to. Every
+   fault but a cut off body must end well; a refused connection through the
+   retry. A cut off body may still hold all we need, so that is only logged
+ * *****************************************************************************/
+  if (replay_fault == REPLAY_FAULT_TRUNCATED) {
+    LOG_INFO("Replay check %s; cut off body %s", host, ok ? "accepted" : "rejected");
+    return;
+  }
+  if (ok) replay_passed++;
+  else {
+    replay_failed++;
+    LOG_ERROR("Replay check %s FAILED after %s", host, Replay_Fault_Name(replay_fault));
+  }
+  LOG_INFO("Replay checks; %lu passed, %lu failed", replay_passed, replay_failed);
+}
+
+#endif
+
+#endif
@@ -0,0 +1,115 @@
+/* *****************************************************************************
+
+   Copyright (C) 2022 P.A.G.M. Zengers
+
+   Cooperative task scheduler, see Scheduler.h
+
+   This program is free software: you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation, either version 3 of the License, or
+   (at your option) any later version.
+
+ * ****************************************************************************/
+
+#include <Arduino.h>
+#include "Scheduler.h"
+
+struct Task {
+  Task_Function function;                // NULL when the slot is free
+  uint32_t      deadline;                // millis() at which the task is due
+  uint32_t      period;                  // TASK_ONCE or the interval in ms
+  uint8_t       priority;                // 0 is the most important
+};
+
+static Task          tasks[TASK_MAX];
+
+static bool Task_Due(const Task &task, uint32_t now) {
+/* *****************************************************************************
+   Task_Due
+
+   True when the deadline has passed. The signed difference keeps this right
+   across the wrap around of millis()
+ * *****************************************************************************/
+  return (int32_t)(now - task.deadline) >= 0;
+}
+
+int Task_Add(Task_Function function, uint32_t delay_ms, uint32_t period_ms, uint8_t priority, uint32_t now) {
+/* *****************************************************************************
+   Task_Add
+
+   Schedule function to run delay_ms after now, and then every period_ms
+   unless that is TASK_ONCE. Returns the task id or TASK_NONE when the table
+   is full
+ * *****************************************************************************/
+  for (int id = 0; id < TASK_MAX; id++) {
+    if (tasks[id].function != NULL) continue;
+    tasks[id].function = function;
+    tasks[id].deadline = now + delay_ms;
+    tasks[id].period   = period_ms;
+    tasks[id].priority = priority;
+    return id;
+  }
+  return TASK_NONE;
+}
+
+void Task_Remove(int id) {
+/* *****************************************************************************
+   Task_Remove
+
+   Stop a task
+ * *****************************************************************************/
+  if (id >= 0 && id < TASK_MAX) tasks[id].function = NULL;
+}
+
+void Task_Delay(int id, uint32_t delay_ms, uint32_t now) {
+/* *****************************************************************************
+   Task_Delay
+
+   Move the next run of a task to delay_ms after now
+ * *****************************************************************************/
+  if (id >= 0 && id < TASK_MAX) tasks[id].deadline = now + delay_ms;
+}
+
+bool Task_Run(uint32_t now) {
+/* *****************************************************************************
+   Task_Run
+
+   Run the most important task that is due; with equal priority the one that
+   is most overdue. Returns false when nothing was due
+ * *****************************************************************************/
+  int next = TASK_NONE;
+  for (int id = 0; id < TASK_MAX; id++) {
+    if (tasks[id].function == NULL || !Task_Due(tasks[id], now)) continue;
+    if (next == TASK_NONE ||
+        tasks[id].priority < tasks[next].priority ||
+        (tasks[id].priority == tasks[next].priority &&
+         (int32_t)(tasks[id].deadline - tasks[next].deadline) < 0)) next = id;
+  }
+  if (next == TASK_NONE) return false;
+
+  Task_Function function = tasks[next].function;
+  if (tasks[next].period == TASK_ONCE) {
+    tasks[next].function = NULL;
+  } else {
+    // Keep a fixed rhythm, but do not try to catch up on runs we missed
+    tasks[next].deadline += tasks[next].period;
+    if (Task_Due(tasks[next], now)) tasks[next].deadline = now + tasks[next].period;
+  }
+  function();
+  return true;
+}
+
+uint32_t Task_Next(uint32_t now) {
+/* *****************************************************************************
+   Task_Next
+
+   Milliseconds until the next task is due, 0 when one is due already
+ * *****************************************************************************/
+  uint32_t wait = UINT32_MAX;
+  for (int id = 0; id < TASK_MAX; id++) {
+    if (tasks[id].function == NULL) continue;
+    if (Task_Due(tasks[id], now)) return 0;
+    wait = min(wait, tasks[id].deadline - now);
+  }
+  return wait;
+}
@@ -0,0 +1,323 @@
+/* *****************************************************************************
+
+   Copyright (C) 2022 P.A.G.M. Zengers
+
+   Cost of drawing a screen, see ScreenStats.h
+
+   This program is free software: you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation, either version 3 of the License, or
+   (at your option) any later version.
+
+ * ****************************************************************************/
+
+#include "ScreenStats.h"
+
+#if SCREEN_STATS_ENABLED
+
+#include "Log.h"
+#include "Metrics.h"
+#include "Alloc.h"
+
+#if SCREEN_HEATMAP_ENABLED
+struct Heatmap {
+  const char  *name;                     // Screen, NULL while not used
+  Screen_Stats stats;                    // Of the draw
+  uint16_t     tiles[SCREEN_STATS_TILES_X * SCREEN_STATS_TILES_Y]; // Pixels written per tile
+};
+#endif
+
+static Screen_Stats stats;
+static uint8_t      stats_written[SCREEN_STATS_WIDTH * SCREEN_STATS_HEIGHT / 8]; // One bit per pixel
+static uint8_t      stats_depth = 0;     // TFT_eSPI calls itself; only the outer call counts
+#if ALLOC_ENABLED
+static uint32_t     stats_alloc_start;   // Alloc_Bytes at the start of the draw
+#endif
+#if SCREEN_HEATMAP_ENABLED
+static uint16_t     stats_tiles[SCREEN_STATS_TILES_X * SCREEN_STATS_TILES_Y];
+static Heatmap      heatmaps[SCREEN_STATS_SCREENS];
+#endif
+
+static uint32_t Stats_Mark(int32_t x, int32_t y, int32_t w, int32_t h) {
+/* *****************************************************************************
+   Stats_Mark
+
+   Mark a w by h rectangle as written. Returns its pixels on the screen
+ * *****************************************************************************/
+  if (x < 0) { w += x; x = 0; }
+  if (y < 0) { h += y; y = 0; }
+  if (x + w > SCREEN_STATS_WIDTH)  w = SCREEN_STATS_WIDTH - x;
+  if (y + h > SCREEN_STATS_HEIGHT) h = SCREEN_STATS_HEIGHT - y;
+  if (w <= 0 || h <= 0) return 0;
+
+  for (int32_t row = y; row < y + h; row++) {
+    for (int32_t col = x; col < x + w; col++) {
+#if SCREEN_HEATMAP_ENABLED
+      stats_tiles[(row / SCREEN_STATS_TILE) * SCREEN_STATS_TILES_X + col / SCREEN_STATS_TILE]++;
+#endif
+      uint32_t bit = row * SCREEN_STATS_WIDTH + col;
+      if (stats_written[bit >> 3] & (1 << (bit & 7))) continue;
+      stats_written[bit >> 3] |= 1 << (bit & 7);
+      stats.unique++;
+    }
+  }
+  return w * h;
+}
+
+static void Stats_Call(uint32_t pixels) {
+/* *****************************************************************************
+   Stats_Call
+
+   Account a drawing call that wrote the given pixels
+ * *****************************************************************************/
+  if (pixels == 0) return;
+  stats.calls++;
+  stats.pixels += pixels;
+  stats.bytes  += SCREEN_STATS_WINDOW_BYTES + 2 * pixels;
+  uint32_t free_heap = ESP.getFreeHeap();
+  if (free_heap < stats.heap_min) stats.heap_min = free_heap;
+}
+
+static void Stats_Area(int32_t x, int32_t y, int32_t w, int32_t h) {
+  Stats_Call(Stats_Mark(x, y, w, h));
+}
+
+static void Stats_Hash(uint32_t value) {
+  stats.hash = (stats.hash ^ value) * 16777619UL; // FNV-1a, a word at a time
+}
+
+static void Stats_Hash(char kind, int32_t x, int32_t y, int32_t w, int32_t h, uint32_t color) {
+  Stats_Hash(kind);
+  Stats_Hash(x);
+  Stats_Hash(y);
+  Stats_Hash(w);
+  Stats_Hash(h);
+  Stats_Hash(color);
+}
+
+void ScreenStats_Begin() {
+  memset(&stats, 0, sizeof(stats));
+  memset(stats_written, 0, sizeof(stats_written));
+#if SCREEN_HEATMAP_ENABLED
+  memset(stats_tiles, 0, sizeof(stats_tiles));
+#endif
+  stats.heap_start = ESP.getFreeHeap();
+  stats.heap_min   = stats.heap_start;
+  stats.hash       = 2166136261UL;
+#if ALLOC_ENABLED
+  stats_alloc_start = Alloc_Bytes();
+#endif
+}
+
+const Screen_Stats &ScreenStats_Get() {
+  return stats;
+}
+
+bool ScreenStats_End(const Screen &screen, bool full) {
+/* *****************************************************************************
+   ScreenStats_End
+
+   Log what the draw cost and check it against the budgets of the screen.
+   Draws that did not write anything are left out
+ * *****************************************************************************/
+  uint32_t free_heap = ESP.getFreeHeap();
+  if (free_heap < stats.heap_min) stats.heap_min = free_heap;
+#if ALLOC_ENABLED
+  stats.allocated = Alloc_Bytes() - stats_alloc_start;
+#endif
+  if (stats.pixels == 0) return true;
+
+  uint32_t overdraw = stats.pixels * 100 / stats.unique;
+  uint32_t heap     = max(stats.heap_start - stats.heap_min, stats.allocated);
+  uint32_t budget   = full ? screen.budget_full : screen.budget_update;
+  LOG_INFO("Screen %s %s; %lu bytes, %lu calls, overdraw %lu%%, heap %lu",
+           screen.name, full ? "full" : "update", stats.bytes, stats.calls, overdraw, heap);
+
+  bool ok = true;
+  if (stats.bytes > budget) {
+    LOG_ERROR("Screen %s over budget; %lu bytes, allowed %lu", screen.name, stats.bytes, budget);
+    ok = false;
+  }
+  if (overdraw > screen.budget_overdraw) {
+    LOG_ERROR("Screen %s over budget; overdraw %lu%%, allowed %d%%", screen.name, overdraw, screen.budget_overdraw);
+    ok = false;
+  }
+  if (heap > screen.budget_heap) {
+    LOG_ERROR("Screen %s over budget; heap %lu, allowed %d", screen.name, heap, screen.budget_heap);
+    ok = false;
+  }
+
+#if SCREEN_HEATMAP_ENABLED
+  if (full) { // Keep it as the heatmap of the screen
+    Heatmap *heatmap = NULL;
+    for (uint8_t i = 0; i < SCREEN_STATS_SCREENS && heatmap == NULL; i++) {
+      if (heatmaps[i].name == NULL || strcmp(heatmaps[i].name, screen.name) == 0) heatmap = &heatmaps[i];
+    }
+    if (heatmap) {
+      heatmap->name  = screen.name;
+      heatmap->stats = stats;
+      memcpy(heatmap->tiles, stats_tiles, sizeof(stats_tiles));
+    }
+  }
+#endif
+  return ok;
+}
+
+#if SCREEN_HEATMAP_ENABLED
+
+static uint32_t Heatmap_Tile(const Heatmap &heatmap, uint16_t tile) {
+  return heatmap.tiles[tile] * 100 / (SCREEN_STATS_TILE * SCREEN_STATS_TILE); // Writes per pixel, in 1/100
+}
+
+void ScreenStats_Heatmap() {
+/* *****************************************************************************
+   ScreenStats_Heatmap
+
+   Write the heatmap of every screen: a summary, then a character per tile
+   with the times its pixels were written on average. ' ' is never, '.' less
+   than once, '1' to '9' that many times and '#' ten times or more
+ * *****************************************************************************/
+  char row[SCREEN_STATS_TILES_X + 1];
+
+  for (uint8_t i = 0; i < SCREEN_STATS_SCREENS && heatmaps[i].name; i++) {
+    const Heatmap &heatmap = heatmaps[i];
+    uint16_t hottest = 0, hot = 0;
+    for (uint16_t tile = 0; tile < SCREEN_STATS_TILES_X * SCREEN_STATS_TILES_Y; tile++) {
+      uint32_t writes = Heatmap_Tile(heatmap, tile);
+      if (writes > Heatmap_Tile(heatmap, hottest)) hottest = tile;
+      if (writes > SCREEN_STATS_HOT) hot++;
+    }
+    Metrics_Line(PSTR("%s: %lu bytes, %lu calls, %lu pixels, %lu unique, overdraw %lu%%\n"),
+                 heatmap.name, heatmap.stats.bytes, heatmap.stats.calls, heatmap.stats.pixels,
+                 heatmap.stats.unique, heatmap.stats.unique ? heatmap.stats.pixels * 100 / heatmap.stats.unique : 0);
+    Metrics_Line(PSTR("%d hot tiles, hottest at %d,%d written %lu%%\n"), hot,
+                 (hottest % SCREEN_STATS_TILES_X) * SCREEN_STATS_TILE, (hottest / SCREEN_STATS_TILES_X) * SCREEN_STATS_TILE,
+                 Heatmap_Tile(heatmap, hottest));
+
+    for (uint8_t y = 0; y < SCREEN_STATS_TILES_Y; y++) {
+      for (uint8_t x = 0; x < SCREEN_STATS_TILES_X; x++) {
+        uint16_t tile   = y * SCREEN_STATS_TILES_X + x;
+        uint32_t writes = Heatmap_Tile(heatmap, tile);
+        if (heatmap.tiles[tile] == 0) row[x] = ' ';
+        else if (writes < 100)        row[x] = '.';
+        else if (writes < 1000)       row[x] = '0' + writes / 100;
+        else                          row[x] = '#';
+      }
+      row[SCREEN_STATS_TILES_X] = '\0';
+      Metrics_Line(PSTR("|%s|\n"), row);
+    }
+    Metrics_Line(PSTR("\n"));
+  }
+}
+
+void ScreenStats_Heatmap_SVG(const char *name) {
+/* *****************************************************************************
+   ScreenStats_Heatmap_SVG
+
+   Write the heatmap of the named screen as an SVG image, a square per tile.
+   Written once is blue, going to red at four times or more
+ * *****************************************************************************/
+  Metrics_Line(PSTR("<svg xmlns=\"http://www.w3.org/2000/svg\" viewBox=\"0 0 %d %d\">\n"),
+               SCREEN_STATS_WIDTH, SCREEN_STATS_HEIGHT);
+  Metrics_Line(PSTR("<rect width=\"100%%\" height=\"100%%\" fill=\"black\"/>\n"));
+  for (uint8_t i = 0; i < SCREEN_STATS_SCREENS && heatmaps[i].name; i++) {
+    const Heatmap &heatmap = heatmaps[i];
+    if (strcmp(heatmap.name, name) != 0) continue;
+    for (uint16_t tile = 0; tile < SCREEN_STATS_TILES_X * SCREEN_STATS_TILES_Y; tile++) {
+      if (heatmap.tiles[tile] == 0) continue;
+      uint32_t writes = Heatmap_Tile(heatmap, tile);
+      uint16_t heat   = constrain(writes, 100, 400) - 100; // 0 .. 300
+      Metrics_Line(PSTR("<rect x=\"%d\" y=\"%d\" width=\"%d\" height=\"%d\" fill=\"rgb(%d,0,%d)\"><title>%lu%%</title></rect>\n"),
+                   (tile % SCREEN_STATS_TILES_X) * SCREEN_STATS_TILE, (tile / SCREEN_STATS_TILES_X) * SCREEN_STATS_TILE,
+                   SCREEN_STATS_TILE, SCREEN_STATS_TILE, heat * 255 / 300, 255 - heat * 255 / 300, writes);
+    }
+  }
+  Metrics_Line(PSTR("</svg>\n"));
+}
+#endif
+
+void TFT_Counted::drawPixel(int32_t x, int32_t y, uint32_t color) {
+  if (stats_depth++ == 0) {
+    Stats_Area(x, y, 1, 1);
+    Stats_Hash('p', x, y, 1, 1, color);
+  }
+  TFT_eSPI::drawPixel(x, y, color);
+  stats_depth--;
+}
+
+void TFT_Counted::drawChar(int32_t x, int32_t y, uint16_t c, uint32_t color, uint32_t bg, uint8_t size) {
+  if (stats_depth++ == 0) {
+    Stats_Area(x, y, 6 * size, 8 * size); // GLCD font, 5x7 plus spacing
+    Stats_Hash('c', x, y, c, size, color);
+    Stats_Hash(bg);
+  }
+  TFT_eSPI::drawChar(x, y, c, color, bg, size);
+  stats_depth--;
+}
+
+int16_t TFT_Counted::drawChar(uint16_t uniCode, int32_t x, int32_t y, uint8_t font) {
+  bool outer = (stats_depth++ == 0);
+  int16_t width = TFT_eSPI::drawChar(uniCode, x, y, font);
+  if (outer) {
+    Stats_Area(x, y, width, fontHeight(font));
+    Stats_Hash('f', x, y, uniCode, font, textcolor);
+    Stats_Hash(textbgcolor);
+  }
+  stats_depth--;
+  return width;
+}
+
+void TFT_Counted::drawLine(int32_t xs, int32_t ys, int32_t xe, int32_t ye, uint32_t color) {
+  if (stats_depth++ == 0) {
+    Stats_Hash('l', xs, ys, xe, ye, color);
+    int32_t dx = abs(xe - xs), dy = abs(ye - ys);
+    if (dx == 0 || dy == 0) Stats_Area(min(xs, xe), min(ys, ye), dx + 1, dy + 1);
+    else { // One pixel per step along the longest axis
+      int32_t steps = max(dx, dy);
+      uint32_t pixels = 0;
+      for (int32_t i = 0; i <= steps; i++) pixels += Stats_Mark(xs + (xe - xs) * i / steps, ys + (ye - ys) * i / steps, 1, 1);
+      Stats_Call(pixels);
+    }
+  }
+  TFT_eSPI::drawLine(xs, ys, xe, ye, color);
+  stats_depth--;
+}
+
+void TFT_Counted::drawFastVLine(int32_t x, int32_t y, int32_t h, uint32_t color) {
+  if (stats_depth++ == 0) {
+    Stats_Area(x, y, 1, h);
+    Stats_Hash('r', x, y, 1, h, color); // As the fillRect it is
+  }
+  TFT_eSPI::drawFastVLine(x, y, h, color);
+  stats_depth--;
+}
+
+void TFT_Counted::drawFastHLine(int32_t x, int32_t y, int32_t w, uint32_t color) {
+  if (stats_depth++ == 0) {
+    Stats_Area(x, y, w, 1);
+    Stats_Hash('r', x, y, w, 1, color);
+  }
+  TFT_eSPI::drawFastHLine(x, y, w, color);
+  stats_depth--;
+}
+
+void TFT_Counted::fillRect(int32_t x, int32_t y, int32_t w, int32_t h, uint32_t color) {
+  if (stats_depth++ == 0) {
+    Stats_Area(x, y, w, h);
+    Stats_Hash('r', x, y, w, h, color);
+  }
+  TFT_eSPI::fillRect(x, y, w, h, color);
+  stats_depth--;
+}
+
+void TFT_Counted::pushImage(int32_t x, int32_t y, int32_t w, int32_t h, const uint16_t *data) {
+  if (stats_depth++ == 0) {
+    Stats_Area(x, y, w, h);
+    Stats_Hash('i', x, y, w, h, 0);
+    for (int32_t i = 0; i < w * h; i++) Stats_Hash(pgm_read_word(data + i)); // Icons are in flash
+  }
+  TFT_eSPI::pushImage(x, y, w, h, data);
+  stats_depth--;
+}
+
+#endif
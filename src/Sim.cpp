@@ -0,0 +1,137 @@
+/* *****************************************************************************
+
+   Copyright (C) 2022 P.A.G.M. Zengers
+
+   Simulation of a whole day on the device, see Sim.h
+
+   This program is free software: you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation, either version 3 of the License, or
+   (at your option) any later version.
+
+ * ****************************************************************************/
+
+#include <Arduino.h>
+#include "Sim.h"
+
+#if SIM_ENABLED
+
+#include "Log.h"
+#if SIM_FRAMES
+#include <LittleFS.h>
+#include "Native.h"
+#endif
+
+struct Sim_Cadence {
+  const char *name;
+  uint32_t    runs;
+  uint32_t    last;                      // Virtual ms of the previous run
+  uint32_t    shortest;                  // Interval between two runs, ms
+  uint32_t    longest;
+};
+
+// CO2 over the day: minute of the day and ppm, the level in between is interpolated
+static const uint16_t sim_co2_script[][2] PROGMEM = {
+  {    0,  450 },
+  {  480,  450 },                        // 08:00 the room is taken
+  {  720, 1300 },
+  {  750,  700 },                        // 12:30 windows open
+  { 1020, 1500 },
+  { 1320,  500 },                        // 22:00 empty again
+  { 1440,  450 }
+};
+
+static Sim_Cadence sim_cadence[SIM_TASKS] = {
+  { "render",  0, 0, UINT32_MAX, 0 },
+  { "weather", 0, 0, UINT32_MAX, 0 },
+  { "rain",    0, 0, UINT32_MAX, 0 },
+  { "co2",     0, 0, UINT32_MAX, 0 }
+};
+
+static uint32_t sim_offset = SIM_CLOCK_START, // Virtual minus real ms
+                sim_skipped = 0;         // ms jumped while idle
+
+uint32_t Sim_Millis() {
+  return millis() + sim_offset;
+}
+
+void Sim_Delay(uint32_t ms) {
+  sim_offset += ms;
+  yield();
+}
+
+void Sim_Idle(uint32_t wait) {
+/* *****************************************************************************
+   Sim_Idle
+
+   Jump to the next deadline. The log goes out first, a jump would otherwise
+   fill it faster than the serial port can send
+ * *****************************************************************************/
+  if (wait == 0 || wait == UINT32_MAX) return;
+  Log_Flush();
+  sim_offset  += wait;
+  sim_skipped += wait;
+}
+
+int Sim_CO2() {
+  uint32_t minute = (SIM_START_HOUR * 60 + (Sim_Millis() - SIM_CLOCK_START) / 60000) % 1440;
+  uint8_t  i = 1;
+  while (pgm_read_word(&sim_co2_script[i][0]) <= minute) i++;
+  int from_minute = pgm_read_word(&sim_co2_script[i - 1][0]), from_ppm = pgm_read_word(&sim_co2_script[i - 1][1]),
+      to_minute   = pgm_read_word(&sim_co2_script[i][0]),     to_ppm   = pgm_read_word(&sim_co2_script[i][1]);
+  return map(minute, from_minute, to_minute, from_ppm, to_ppm);
+}
+
+void Sim_Task(uint8_t task) {
+  Sim_Cadence &cadence = sim_cadence[task];
+  uint32_t now = Sim_Millis();
+  if (cadence.last != 0) { // Also across reports
+    uint32_t interval = now - cadence.last;
+    if (interval < cadence.shortest) cadence.shortest = interval;
+    if (interval > cadence.longest)  cadence.longest  = interval;
+  }
+  cadence.runs++;
+  cadence.last = now;
+}
+
+void Sim_Frame(const char *screen, uint32_t hash, uint32_t bytes) {
+/* *****************************************************************************
+   Sim_Frame
+
+   Log the frame, and with SIM_FRAMES save what the panel shows now as
+   <virtual ms>_<screen>.ppm, the ms padded so the files sort in order
+ * *****************************************************************************/
+  uint32_t now = Sim_Millis();
+  LOG_INFO("Frame %lu.%03lu %s %08lx %lu", now / 1000, now % 1000, screen, hash, bytes);
+
+#if SIM_FRAMES
+  static bool sim_frames_dir = false;
+  if (!sim_frames_dir) sim_frames_dir = LittleFS.exists(SIM_FRAMES_DIR) || LittleFS.mkdir(SIM_FRAMES_DIR);
+  char name[64], path[256];
+  snprintf(name, sizeof(name), SIM_FRAMES_DIR "/%010lu_%s.ppm", (unsigned long)now, screen);
+  if (!Native_Panel_Save(Native_Path(name, path, sizeof(path)))) LOG_WARN("Sim can not save frame %lu", now);
+#endif
+}
+
+void Sim_Report() {
+/* *****************************************************************************
+   Sim_Report
+
+   Log how far the simulation is and the cadence of the tasks since the
+   previous report
+ * *****************************************************************************/
+  uint32_t now = Sim_Millis() - SIM_CLOCK_START, minute = (SIM_START_HOUR * 60 + now / 60000) % 1440;
+  LOG_INFO("Sim %02lu:%02lu; %lu s virtual in %lu s, %lu s idle skipped",
+           minute / 60, minute % 60, now / 1000, millis() / 1000, sim_skipped / 1000);
+  for (uint8_t i = 0; i < SIM_TASKS; i++) {
+    Sim_Cadence &cadence = sim_cadence[i];
+    if (cadence.runs == 0) continue;
+    LOG_INFO("Sim %-8s %lu runs, interval %lu to %lu ms",
+             cadence.name, cadence.runs, cadence.shortest == UINT32_MAX ? 0 : cadence.shortest, cadence.longest);
+    cadence.runs     = 0;
+    cadence.shortest = UINT32_MAX;
+    cadence.longest  = 0;
+  }
+}
+
+#endif
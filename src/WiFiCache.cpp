@@ -0,0 +1,124 @@
+/* *****************************************************************************
+
+   Copyright (C) 2022 P.A.G.M. Zengers
+
+   Fast reconnect to the last access point, see WiFiCache.h
+
+   This program is free software: you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation, either version 3 of the License, or
+   (at your option) any later version.
+
+ * ****************************************************************************/
+
+#include <Arduino.h>
+#include <ESP8266WiFi.h>
+#include "WiFiCache.h"
+#include "Persist.h"
+#include "Log.h"
+
+extern "C" {
+#include <user_interface.h>
+}
+
+struct WiFi_Cache {
+  uint8_t  bssid[6];
+  int32_t  channel;
+  uint32_t ip, gateway, subnet, dns1, dns2;
+  uint16_t starts;                       // Fast connects since DHCP gave the addresses
+};
+
+static bool wifi_static   = false;       // Connected on the saved addresses
+static bool wifi_renewing = false;       // Back on DHCP, the new addresses are not saved yet
+
+bool WiFi_Fast_Connect(uint32_t timeout_ms) {
+/* *****************************************************************************
+   WiFi_Fast_Connect
+
+   Connect with what we saved last time and the SSID and password of the SDK.
+   Returns false when there is nothing saved, the addresses were used
+   WIFI_CACHE_MAX_STARTS times or the access point did not take us back in time
+ * *****************************************************************************/
+  WiFi_Cache cache;
+  if (!Persist_Load(WIFI_CACHE_FILE, &cache, sizeof(cache)) || cache.ip == 0) return false;
+  if (cache.starts >= WIFI_CACHE_MAX_STARTS) {
+    LOG_INFO("Saved addresses used for %d starts; asking DHCP again", cache.starts);
+    return false;
+  }
+
+  station_config config;
+  char ssid[sizeof(config.ssid) + 1], psk[sizeof(config.password) + 1]; // Not terminated when full
+  if (!wifi_station_get_config_default(&config) || config.ssid[0] == 0) return false;
+  memcpy(ssid, config.ssid, sizeof(config.ssid));
+  memcpy(psk, config.password, sizeof(config.password));
+  ssid[sizeof(config.ssid)] = psk[sizeof(config.password)] = 0;
+
+  unsigned long start = millis();
+  WiFi.persistent(false); // The SDK has this already, do not write it to flash again
+  WiFi.mode(WIFI_STA);
+  WiFi.config(IPAddress(cache.ip), IPAddress(cache.gateway), IPAddress(cache.subnet),
+              IPAddress(cache.dns1), IPAddress(cache.dns2));
+  WiFi.begin(ssid, psk, cache.channel, cache.bssid, true);
+  memset(psk, 0, sizeof(psk));
+  memset(&config, 0, sizeof(config));
+  while (WiFi.status() != WL_CONNECTED) {
+    if ((uint32_t)(millis() - start) > timeout_ms) {
+      LOG_WARN("Fast connect to %s timed out; trying the normal way", ssid);
+      Log_Flush(); // ssid is gone after we return
+      WiFi.disconnect();
+      WiFi.config(IPAddress(0u), IPAddress(0u), IPAddress(0u)); // Back to DHCP
+      WiFi.persistent(true);
+      return false;
+    }
+    delay(10);
+  }
+  WiFi.persistent(true);
+  wifi_static = true;
+  cache.starts++;
+  Persist_Save(WIFI_CACHE_FILE, &cache, sizeof(cache));
+  LOG_INFO("Fast connect on channel %d in %lu ms", cache.channel, (unsigned long)(uint32_t)(millis() - start));
+  return true;
+}
+
+void WiFi_Remember() {
+/* *****************************************************************************
+   WiFi_Remember
+
+   Save the access point and addresses of the current connection, which DHCP
+   gave
+ * *****************************************************************************/
+  wifi_static = false;
+  WiFi_Cache cache;
+  memset(&cache, 0, sizeof(cache));
+  memcpy(cache.bssid, WiFi.BSSID(), sizeof(cache.bssid));
+  cache.channel = WiFi.channel();
+  cache.ip      = WiFi.localIP();
+  cache.gateway = WiFi.gatewayIP();
+  cache.subnet  = WiFi.subnetMask();
+  cache.dns1    = WiFi.dnsIP(0);
+  cache.dns2    = WiFi.dnsIP(1);
+  Persist_Save(WIFI_CACHE_FILE, &cache, sizeof(cache));
+}
+
+bool WiFi_Renew() {
+/* *****************************************************************************
+   WiFi_Renew
+
+   On the saved addresses: go back to DHCP, the connection stays up. The run
+   after, once DHCP gave an address, save that. Returns true while waiting
+   for DHCP
+ * *****************************************************************************/
+  if (wifi_renewing) {
+    if (!WiFi.localIP().isSet()) return true;
+    wifi_renewing = false;
+    WiFi_Remember();
+    LOG_INFO("DHCP gave the addresses again; saved");
+    return false;
+  }
+  if (!wifi_static) return false; // DHCP renews the lease itself
+  LOG_INFO("Running on the saved addresses for %lu h; asking DHCP again", WIFI_RENEW_MS / 3600000UL);
+  WiFi.config(IPAddress(0u), IPAddress(0u), IPAddress(0u));
+  wifi_static   = false;
+  wifi_renewing = true;
+  return true;
+}
@@ -59,6 +59,30 @@
 #include <SoftwareSerial.h>
 #include <MHZ19.h>
 #include "WeatherSymbols.h"       // Our pictures in a C array
+#include "Inflate.h"              // Streaming gzip decompression
+#include "RainTable.h"            // Radar value to mm/hour
+#include "Weather.h"              // Parsed weather and rain info
+#include "CO2Sensor.h"            // Non blocking MH-Z19B reading
+#include "Scheduler.h"            // Runs our tasks from loop()
+#include "Screen.h"               // Screens shown by the render loop
+#include "Log.h"                  // Non blocking logging to the serial port
+#include "Profile.h"              // Cycle count timers, only with PROFILE_ENABLED
+#include "Metrics.h"              // Prometheus metrics over http
+#include "Fetch.h"                // Timing of every fetch
+#include "Persist.h"              // Last snapshots kept over a restart
+#include "WiFiCache.h"            // Fast reconnect to the last access point
+#include "Boot.h"                 // Timeline of the start
+#include "Bench.h"                // Drawing benchmarks, only with BENCH_ENABLED
+#include "ScreenStats.h"          // Cost of drawing a screen, only with SCREEN_STATS_ENABLED
+#include "Alloc.h"                // Heap allocation tracker, only with ALLOC_ENABLED
+#include "Golden.h"               // Golden image checks, only with GOLDEN_ENABLED
+#include "Replay.h"               // Record and replay of the responses, only with REPLAY_MODE
+#include "Sim.h"                  // A day on a virtual clock, only with SIM_ENABLED
+
+#if SIM_ENABLED // From here on the time is virtual, see Sim.h
+#define millis()                   Sim_Millis()
+#define delay(ms)                  Sim_Delay(ms)
+#endif
 
 /* *****************************************************************************
    Defines, to ensure our code is easier to maintain
@@ -83,7 +107,9 @@
 #define PIN_D10                    1
 
 // Serial port config
+#ifndef DEBUG_OUTPUT_BAUDRATE
 #define DEBUG_OUTPUT_BAUDRATE      9600  // Hardware serial (USB)
+#endif
 #define SENSOR_OUTPUT_BAUDRATE     9600  // Software serial
 
 // Screen definitions
@@ -92,6 +118,8 @@
 #define SCREEN_CO2                 2     // ID for Show_CO2 info
 #define SCREEN_RAIN                3     // ID for Show_CO2 info
 #define SCREEN_COUNT               3     //  screens available
+#define PROGRESS_STEP_MS           1000  // ms between two dots of the progress bar
+#define PROGRESS_STEPS             (SCREEN_CHANGE_TIMEOUT / PROGRESS_STEP_MS)
 
 #define RESET_DELAY_ON_ERROR       15000 // (ms) delay after panic to ensure last message is read
 #define ESTABLISH_DELAY            500   // (ms) delay after important tasks to settle down
@@ -100,13 +128,48 @@
 #define RAIN_INTERVAL_SEC          600   // Interval time (sec) between for retrieving buienradar info
 #define CO2_INTERVAL_SEC           5     // Interval time (sec) between for retrieving CO2 info
 
+// Task priorities, 0 goes first when several tasks are due
+#define PRIO_GET_WEATHER           0
+#define PRIO_GET_RAIN              1
+#define PRIO_RENDER                2
+#define PRIO_CO2                   3
+#define PRIO_PROFILE               4
+#define PRIO_ALLOC                 5
+#define PRIO_SIM                   6
+#define PRIO_WIFI                  7
+
 #define HTTPS_TIMEOUT_SEC          15    // (sec) timeout for https call
+#define HTTPS_PORT                 443
+
+// BearSSL buffer sizes. When the server accepts Maximum Fragment Length Negotiation (MFLN)
+// we can run with small buffers, otherwise we need the full 16k TLS record buffer
+#define TLS_MFLN_SIZE              512   // Fragment length we ask the server for
+#define TLS_MFLN_RX_BUFFER         512   // Receive buffer when MFLN is accepted
+#define TLS_MFLN_TX_BUFFER         512   // Transmit buffer when MFLN is accepted
+#define TLS_DEFAULT_RX_BUFFER      16384 // BearSSL defaults, used as fallback
+#define TLS_DEFAULT_TX_BUFFER      512
+#define MFLN_UNKNOWN               -1    // Not probed yet
+#define MFLN_UNSUPPORTED           0
+#define MFLN_SUPPORTED             1
+#define HEAP_SAMPLE_BYTES          256   // Sample free heap every n body bytes during a fetch
+#define INFLATE_HEAP_RESERVE       8192  // Only ask for gzip if the window fits with this to spare
+
+// Streaming extraction of the weather feed; we only keep the parts we need
+#define FEED_ACTUAL_LENGTH         300   // Chars kept after "actual": (sunrise and sunset)
+#define FEED_STATION_LENGTH        1024  // Max chars kept of the record of our weather station
+#define FEED_FIND_ACTUAL           0     // States of the extraction
+#define FEED_ACTUAL                1
+#define FEED_FIND_STATION          2
+#define FEED_STATION               3
+#define FEED_DONE                  4
 
 #define TEXT_SIZE_SMALL            1     // 16 pixels high
 #define TEXT_SIZE_MEDIUM           2     // 26 pixels high
 #define TEXT_SIZE_LARGE            4     // 48 pixels high
 #define TEXT_SIZE_XLARGE           6
 #define TEXT_MAX_LENGTH            30
+#define TEXT_LINE_LENGTH           48    // Buffer for one formatted line on screen
+#define SPLASH_LEFT                35    // Left margin of the start up screen
 
 #define SYMBOL_WIDTH               50
 #define SYMBOL_HEIGTH              50
@@ -132,7 +195,14 @@
 #define RAIN_TOPY                  40
 #define RAIN_XLEN                  161
 #define RAIN_YLEN                  160
-#define RAIN_READINGS 24
+#define RAIN_LINE_LENGTH           32    // Max length of a line like "077|20:10"
+#define RAIN_NO_RAIN               10    // (1/1000 mm/hour) below this we call it dry
+#define RAIN_SCALE_LOW             5000  // (1/1000 mm/hour) graph scales
+#define RAIN_SCALE_MEDIUM          20000
+#define RAIN_SCALE_HIGH            100000
+
+#define WEATHER_FILE               "/weather.bin" // Last snapshots, for a warm start
+#define RAIN_FILE                  "/rain.bin"
 
 /* MHZ Error codes  0   NULL, Library logic error, should not occur
                     1   OK
@@ -141,49 +211,111 @@
                     4   CRC error in received data
                     5   Filter kicked in (value within 30 seconds of reset)
                     6   Failed   */
+#define MHZ_RESULT_CODES           7
 
 /* *****************************************************************************
    Global variables out of scope of functions
  * *****************************************************************************/
 int                  MHZ_CO2,            // CO2 value of MHZ
-                     MHZ_Temp;           // Indoor temp from MHZ
-
-String               MHZ_Error,          // Last error message from MHZ
-      	             WTH_timestamp,      // "2022-01-02T12:30:00",
-		                 WTH_description,    // "Zwaar bewolkt",
-                     WTH_icon,           // "https://www.buienradar.nl/resources/images/weather/30x30/c.png"
-                     WTH_winddirection,  // "ZW",
-                     WTH_sunrise,
-                     WTH_sunset,
-                     WTH_error,
-                     WTH_airpressure,    // 1010.4,
-		                 WTH_temperature,    // 12.3,
-	                   WTH_windspeed,      // 5.7,
-		                 WTH_humidity,       // 83.0,
-			               WTH_precipitation,  // 0.0,
-			               WTH_sunpower,       // 61.0,
-			               WTH_rainFallLast24Hour, // 3.9,
-			               WTH_rainFallLastHour; // 0.0,
-
-String               RAIN_error;
-float                Rain[RAIN_READINGS];         // Rain forecast in mm/hour
-float                Rain_max;
+                     MHZ_Temp,           // Indoor temp from MHZ
+                     MHZ_Error = MHZ19_RESULT_NULL; // Result of the last read
+
+int                  WTH_error = 0,      // HTTP status of the last weather fetch
+                     RAIN_error = 0;     // HTTP status of the last rain fetch
+
+// Front and back buffers. The parser fills the one not shown, and swaps when complete
+WeatherSnapshot      weather_buffer[2];
+WeatherSnapshot     *weather_now = &weather_buffer[0];
+RainSnapshot         rain_buffer[2];
+RainSnapshot        *rain_now = &rain_buffer[0];
+
+// Validators of the last good response, sent back to ask for changes only
+String               WTH_etag,
+                     WTH_lastModified,
+                     RAIN_etag,
+                     RAIN_lastModified;
+
+// Device metrics
+unsigned long        WTH_count200 = 0,   // Weather responses with new data
+                     WTH_count304 = 0,   // Weather responses "not modified"
+                     RAIN_count200 = 0,
+                     RAIN_count304 = 0,
+                     WTH_countFail = 0,  // Weather fetches that brought nothing
+                     RAIN_countFail = 0;
+unsigned long        MHZ_results[MHZ_RESULT_CODES]; // Sensor reads per MHZ19_RESULT
 
 // Weather data
 const char*          json_host = "data.buienradar.nl";
 const char*          json_link = "/2.0/feed/json";
-unsigned long        json_next_get = 0;
 const char*          rain_host = "gpsgadget.buienradar.nl";
 const char*          rain_link1 = "/data/raintext?";
 const char*          rain_link2 = "lat=52.14&lon=5.58"; 
 String               stationid = "\"stationid\":6260";
-unsigned long        rain_next_get = 0;
 int                  screen_to_show =0; 
-
-WiFiClientSecure httpsClient; // https://github.com/espressif/arduino-esp32/tree/master/libraries/WiFiClientSecure
+int                  progress_step = 0;  // Dots shown on the progress bar of this screen
+
+// Render loop
+unsigned long        frame_last,         // millis() of the previous frame
+                     screen_elapsed;     // ms the current screen is showing
+const WeatherSnapshot *weather_drawn = NULL; // Snapshots on screen, to see when new data arrives
+const RainSnapshot   *rain_drawn = NULL;
+int                  co2_drawn = -1;     // CO2 value on the meter
+
+// Frame time against FRAME_BUDGET_US, reported at every screen change
+unsigned long        frame_count,
+                     frame_overruns,
+                     frame_time_total,   // us
+                     frame_time_max;     // us
+
+// Frame time since the start, for the metrics
+unsigned long        frame_time_last,    // us
+                     frame_count_total,
+                     frame_overruns_total;
+uint64_t             frame_time_sum;     // us
+#if SCREEN_STATS_ENABLED
+unsigned long        frame_bytes_last,   // Estimated SPI bytes, see ScreenStats.h
+                     frame_bytes_total,
+                     frame_over_budget_total; // Draws over a budget of their screen
+#endif
+
+// Warm start from the snapshots saved at the last fetch
+bool                 warm_start = false;
+unsigned long        boot_first_frame = 0; // millis() when the first screen with data was drawn
+unsigned long        wifi_connect_ms = 0;  // Time it took to get on the network at the start
+int                  bench_failed = 0;     // Bench cases over their baseline at the start
+int                  wifi_renew_task = TASK_NONE; // Back to DHCP after running on the saved addresses
+
+// MFLN support per host, probed once and remembered until a connect fails
+int                  json_mfln = MFLN_UNKNOWN;
+int                  rain_mfln = MFLN_UNKNOWN;
+
+// Weather feed compression with the small inflate window; off once the feed reached back further
+bool                 json_small_window = true;
+
+// Body of the current https response
+bool                 body_chunked,       // Transfer-Encoding: chunked
+                     body_timeout;       // Body ended because the server stopped sending
+unsigned long        body_chunk_left,    // Bytes left in the current chunk
+                     body_bytes;         // Bytes received, before decompression
+
+// Streaming extraction of the weather feed
+int                  feed_state,
+                     feed_match,         // Chars of the current search pattern matched
+                     feed_actual_len,
+                     feed_station_len;
+unsigned long        feed_bytes;         // Bytes of JSON seen
+char                 feed_actual[FEED_ACTUAL_LENGTH + 1],
+                     feed_station[FEED_STATION_LENGTH + 1];
+
+// Heap usage while fetching
+uint32_t             heap_fetch_start,   // Free heap when the fetch started
+                     heap_fetch_min;     // Lowest free heap seen during the fetch
+
+Https_Client     httpsClient; // A WiFiClientSecure, unless we record or replay; see Replay.h
 SoftwareSerial   sensor(PIN_D1, PIN_D2); //rx, tx
 MHZ19            mhz(&sensor); 
-TFT_eSPI         tft = TFT_eSPI();  // Create object "tft"
+TFT_Screen       tft = TFT_Screen();  // Create object "tft", a TFT_eSPI unless we count what it draws
+ESP8266WebServer server(METRICS_PORT);
 
 unsigned int rainbow(byte value) {
 /* *************************************************************************************************
@@ -229,12 +361,14 @@ unsigned int rainbow(byte value) {
 
 }
 
-void ringMeter(int value, int vmin, int vmax, int x, int y, int r, String units, int scheme) {
+void ringMeter(int value, int vmin, int vmax, int x, int y, int r, const char *units, int scheme) {
 /* *************************************************************************************************
    ringMeter
 
    Draw the meter on the screen, returns x coord of righthand side
  * *************************************************************************************************/
+  PROFILE("ringMeter");
+  ALLOC_SCOPE("ringMeter");
   // Minimum value of r is about 52 before value text intrudes on ring
   // drawing the text first is an option
   
@@ -303,8 +437,10 @@ void ringMeter(int value, int vmin, int vmax, int x, int y, int r, String units,
   tft.setTextColor(text_colour, TFT_BLACK);
   
   // Print value, if the meter is large then use big font 6, othewise use 4
-  if (r > 84) tft.drawCentreString(" " + String(value) + " ", x - 5, y - 20, TEXT_SIZE_XLARGE); // Value in middle
-  else tft.drawCentreString(" " + String(value) + " ", x - 5, y - 20, TEXT_SIZE_LARGE); // Value in middle
+  char text[16];
+  snprintf(text, sizeof(text), " %d ", value);
+  if (r > 84) tft.drawCentreString(text, x - 5, y - 20, TEXT_SIZE_XLARGE); // Value in middle
+  else tft.drawCentreString(text, x - 5, y - 20, TEXT_SIZE_LARGE); // Value in middle
 
   // Print units, if the meter is large then use big font 4, othewise use 2
   tft.setTextColor(TFT_WHITE, TFT_BLACK);
@@ -319,9 +455,11 @@ void configModeCallback (WiFiManager *myWiFiManager) {
    From the WifiManager library. Will be called when in station mode. Gives it
    the opportunity to inform the user or do other things
  * *************************************************************************************************/
-  Serial.println(F("Station mode; My ip:"));
-  Serial.println(WiFi.softAPIP());
-  Serial.println("SSID: " + String(myWiFiManager->getConfigPortalSSID()));
+  String ip   = WiFi.softAPIP().toString();
+  String ssid = myWiFiManager->getConfigPortalSSID();
+  LOG_INFO("Station mode; My ip: %s", ip.c_str());
+  LOG_INFO("SSID: %s", ssid.c_str());
+  Log_Flush(); // The portal blocks, and ip and ssid are gone after we return
 
   //tft.setCursor( 0, 12); tft.print("Station mode; My ip:");
   //tft.setCursor( 0, 24); tft.print(WiFi.softAPIP());
@@ -330,14 +468,41 @@ void configModeCallback (WiFiManager *myWiFiManager) {
 
 }
 
-float mmHour(int radarvalue) {
+char* Format_Fixed(char* buffer, int value, int decimals) {
+/* *************************************************************************************************
+   Format_Fixed
+
+   Format a fixed point value with 0 or 1 decimals, e.g. 123 -> "12.3"
+ * *************************************************************************************************/
+  if (decimals == 0) sprintf(buffer, "%d", value);
+  else sprintf(buffer, "%s%d.%d", value < 0 ? "-" : "", abs(value) / 10, abs(value) % 10);
+  return buffer;
+}
+
+char* Format_Time(char* buffer, uint16_t minutes) {
+/* *************************************************************************************************
+   Format_Time
+
+   Format minutes after midnight as HH:MM
+ * *************************************************************************************************/
+  sprintf(buffer, "%02d:%02d", minutes / 60, minutes % 60);
+  return buffer;
+}
+
+uint32_t mmHour(int radarvalue, int hundredths) {
 /* *************************************************************************************************
    mmHour
 
-   Calculate the rain fall in mm/hour by using the values from buienradar and their logaritmic type
-   of scale like this 10^((value -109)/32) (example: 77 = 0.1 mm/hour)
+   Calculate the rain fall in 1/1000 mm/hour by using the values from buienradar and their logaritmic
+   type of scale like this 10^((value -109)/32) (example: 77 = 0.1 mm/hour). The values come from
+   rain_table; decimals in the radar value are interpolated between two entries
  * *************************************************************************************************/
-  return (pow(10, (radarvalue - 109) / 32.0) * 10.0) / 10.0;
+  if (radarvalue < 0) return 0;
+  if (radarvalue >= RAIN_TABLE_SIZE - 1) return pgm_read_dword(&rain_table[RAIN_TABLE_SIZE - 1]);
+
+  uint32_t low  = pgm_read_dword(&rain_table[radarvalue]);
+  uint32_t high = pgm_read_dword(&rain_table[radarvalue + 1]);
+  return low + (uint32_t)(((uint64_t)(high - low) * hundredths) / 100);
 }
 
 void Show_Rain() {
@@ -346,8 +511,12 @@ void Show_Rain() {
 
    Gets the global saved rain info fetched from the URL and displays on the TFT screen
  * *************************************************************************************************/
+  PROFILE("Show_Rain");
+
+  LOG_DEBUG("Executing Show_Rain");
+  const RainSnapshot *forecast = rain_now; // Stays the same while we draw
+  char text[TEXT_LINE_LENGTH];
 
-  Serial.println(F("Executing Show_Rain"));
   tft.startWrite();
   tft.fillScreen(TFT_BLACK); // Clear the screen first
 
@@ -355,20 +524,22 @@ void Show_Rain() {
 
   tft.setTextColor(TFT_SKYBLUE);
   tft.setTextSize(TEXT_SIZE_SMALL);
-  tft.drawCentreString(String(WTH_rainFallLast24Hour) + " mm",METER_RADIUS,15,TEXT_SIZE_SMALL);
+  Format_Fixed(text, weather_now->rainFallLast24Hour, 1);
+  strcat(text, " mm");
+  tft.drawCentreString(text,METER_RADIUS,15,TEXT_SIZE_SMALL);
   tft.drawCentreString("Laatste 24 uur",METER_RADIUS,27,TEXT_SIZE_SMALL);
   
   // Bottom text
   tft.setTextColor(TFT_SKYBLUE);
   tft.drawCentreString("Regen komende 2 uur",METER_RADIUS,210,TEXT_SIZE_SMALL); // Value in middle
-  tft.drawCentreString("BuienRadar.nl",METER_RADIUS,220,TEXT_SIZE_SMALL); // Value in middle
+  tft.drawCentreString(forecast->stale ? "BuienRadar.nl (oud)" : "BuienRadar.nl",METER_RADIUS,220,TEXT_SIZE_SMALL); // Value in middle
 
 
-  //Rain_max = 4; // for testing
+  //rain_now->max = 4000; // for testing
 
 
   // If there is no rain expected, don't bother printing, but give a simple message and return
-  if (Rain_max < 0.01) {
+  if (forecast->max < RAIN_NO_RAIN) {
     tft.setCursor(10, 118);
     tft.setTextSize(TEXT_SIZE_MEDIUM);
     tft.print("Geen regen voorzien");
@@ -376,33 +547,28 @@ void Show_Rain() {
     tft.print("  komende twee uur");
    
     tft.drawLine(105,230,135,230,TFT_MAROON);
-    for (int j=0;j<(SCREEN_CHANGE_TIMEOUT / 1000);j++) {
-      delay(1000);
-      tft.drawPixel(105+(j*3),230,TFT_SKYBLUE);
-      tft.drawPixel(105+1+(j*3),230,TFT_SKYBLUE);
-    }
-    Serial.println(F("Completed Show_Rain"));
+    tft.endWrite();
+    LOG_DEBUG("Completed Show_Rain");
     return;
   }
 
   // Arriving here, we not that it will rain coming 2 hours
   // Make fixed definitions of 5 and 20 mm or higher if it is really wet
   int bar_color = TFT_RED;
-  if (Rain_max <= 5) {
-    Rain_max = 5;
+  uint32_t rain_scale = RAIN_SCALE_HIGH;
+  if (forecast->max <= RAIN_SCALE_LOW) {
+    rain_scale = RAIN_SCALE_LOW;
     bar_color = TFT_BLUE;
   } else {
-    if (Rain_max <= 20) {
-      Rain_max  = 20;
+    if (forecast->max <= RAIN_SCALE_MEDIUM) {
+      rain_scale = RAIN_SCALE_MEDIUM;
       bar_color = TFT_MAGENTA;
-    } else {
-      Rain_max = 100;
     }
   }
 
-  // Calculate the value for the two reference lines
-  float lowline = round(Rain_max * 10 / 3) / 10;  // at 1/3 of graph
-  float highline = round(Rain_max * 20 / 3) / 10; // at 2/3 of graph
+  // Calculate the value (mm/hour) for the two reference lines
+  int lowline  = rain_scale / (3 * RAIN_MILLI);     // at 1/3 of graph
+  int highline = 2 * rain_scale / (3 * RAIN_MILLI); // at 2/3 of graph
 
   // Draw graph border
   tft.drawRect(RAIN_TOPX-1,RAIN_TOPY-1,RAIN_XLEN+1,RAIN_YLEN+2,TFT_NAVY);
@@ -414,12 +580,13 @@ void Show_Rain() {
   for (int moment = 0; moment < RAIN_READINGS-1; moment++) {
 
     // Lets set the first dot to start with
-    y_len      = int(RAIN_YLEN - Rain[moment] / Rain_max * RAIN_YLEN) + RAIN_TOPY;
-    y_len_next = int(RAIN_YLEN - Rain[moment+1] / Rain_max * RAIN_YLEN) + RAIN_TOPY;
+    // Bars are rounded up to the next pixel; anything above the scale reaches the top
+    y_len      = RAIN_YLEN - (min(forecast->rain[moment],   rain_scale) * RAIN_YLEN + rain_scale - 1) / rain_scale + RAIN_TOPY;
+    y_len_next = RAIN_YLEN - (min(forecast->rain[moment+1], rain_scale) * RAIN_YLEN + rain_scale - 1) / rain_scale + RAIN_TOPY;
    
     for (int j = 0; j <  7; j++) {
       int intermediate_bar = int((y_len_next - y_len) * j/7) + y_len;
-      //Serial.println("xas: " + String(x_axes) + "; m: "  + String(Rain[moment]) + ";" + String(Rain[moment+1]) +
+      //Serial.println("xas: " + String(x_axes) + "; m: "  + String(forecast->rain[moment]) + ";" + String(forecast->rain[moment+1]) +
       //             " ylen:" + String(y_len) + ";" + String(y_len_next) + "; j:" + String(j) +
       //             "  int:" + String(intermediate_bar));
       tft.drawLine(x_axes,RAIN_TOPY + RAIN_YLEN,x_axes,intermediate_bar,bar_color);
@@ -443,39 +610,50 @@ void Show_Rain() {
   // and write the text for the reference value on it
   tft.setTextColor(TFT_SKYBLUE);
   tft.setTextSize(TEXT_SIZE_SMALL);
-  tft.drawString(String(int(lowline)) + " mm/h",5,int(2*RAIN_YLEN/3+RAIN_TOPY));
-  tft.drawString(String(int(highline)) + " mm/h",5,int(RAIN_YLEN/3+RAIN_TOPY));
+  sprintf(text, "%d mm/h", lowline);
+  tft.drawString(text,5,int(2*RAIN_YLEN/3+RAIN_TOPY));
+  sprintf(text, "%d mm/h", highline);
+  tft.drawString(text,5,int(RAIN_YLEN/3+RAIN_TOPY));
 
   tft.drawLine(105,230,135,230,TFT_MAROON);
-  for (int j=0;j<(SCREEN_CHANGE_TIMEOUT / 1000);j++) {
-    delay(1000);
-    tft.drawPixel(105+(j*3),230,TFT_SKYBLUE);
-    tft.drawPixel(105+1+(j*3),230,TFT_SKYBLUE);
-  }
   tft.endWrite();
-  Serial.println(F("Completed Show_Rain"));
+  LOG_DEBUG("Completed Show_Rain");
 }
 
 void Get_CO2() {
 /* *****************************************************************************
    Get_CO2
 
-   Retrieve info from the MHZ19b sensor
+   Retrieve info from the MHZ19b sensor. We pick up the reply to the request of
+   the previous call and send a new request, so we never wait for the sensor
  * *****************************************************************************/ 
-  Serial.println(F("Executing Get_CO2")); 
-  MHZ19_RESULT MHZ_Error = mhz.retrieveData();
-  
-  MHZ_CO2 = 0; // reset to zero to ensure we have the latest values
-  MHZ_Temp = 0;
-
-  if (MHZ_Error == MHZ19_RESULT_OK) {
-    MHZ_CO2 = mhz.getCO2();
-    MHZ_Temp = mhz.getTemperature();
-  } else {
-    Serial.print(F("Reading from MHZ19B Sensor failed; error code: "));
-    Serial.println(MHZ_Error);
+  PROFILE("Get_CO2");
+  LOG_DEBUG("Executing Get_CO2"); 
+#if SIM_ENABLED
+  MHZ_Error = MHZ19_RESULT_OK; // The script instead of the sensor
+  MHZ_results[MHZ_Error]++;
+  MHZ_CO2   = Sim_CO2();
+  MHZ_Temp  = 21;
+  return;
+#endif
+  int result = CO2_Poll();
+  if (result == CO2_PENDING) return; // Reply not complete yet, try again next time
+
+  if (result != CO2_IDLE) {
+    MHZ_Error = result;
+    if (result >= 0 && result < MHZ_RESULT_CODES) MHZ_results[result]++;
+    MHZ_CO2 = 0; // reset to zero to ensure we have the latest values
+    MHZ_Temp = 0;
+
+    if (MHZ_Error == MHZ19_RESULT_OK) {
+      MHZ_CO2 = CO2_Value();
+      MHZ_Temp = CO2_Temperature();
+    } else {
+      LOG_WARN("Reading from MHZ19B Sensor failed; error code: %d", MHZ_Error);
+    }
   }
-  Serial.println(F("Completed Get_CO2"));
+  CO2_Request();
+  LOG_DEBUG("Completed Get_CO2");
 }
 
 void Show_CO2() {
@@ -484,24 +662,17 @@ void Show_CO2() {
 
    Displays CO2 info on screen
  * *************************************************************************************************/
-  Serial.println(F("Executing Show_CO2"));
+  PROFILE("Show_CO2");
+  LOG_DEBUG("Executing Show_CO2");
   tft.startWrite(); 
   tft.fillScreen(TFT_BLACK);
   tft.drawLine(105,230,135,230,TFT_MAROON);
   tft.setTextSize(TEXT_SIZE_SMALL);
-
-  for (int j=0;j<(SCREEN_CHANGE_TIMEOUT / 1000);j++) {
-    Get_CO2(); 
-    yield(); // give me a break
-    ringMeter(MHZ_CO2, METER_MINVALUE, METER_MAXVALUE,
-              METER_XPOS, METER_YPOS, METER_RADIUS,"CO2",THREECOLOR); // Draw analogue meter 
-    delay(1000); 
-
-    tft.drawPixel(105+(j*3),230,TFT_SKYBLUE);
-    tft.drawPixel(105+1+(j*3),230,TFT_SKYBLUE);
-  }
+  ringMeter(MHZ_CO2, METER_MINVALUE, METER_MAXVALUE,
+            METER_XPOS, METER_YPOS, METER_RADIUS,"CO2",THREECOLOR); // Draw analogue meter 
+  co2_drawn = MHZ_CO2;
   tft.endWrite();
-  Serial.println(F("Completed Show_CO2"));
+  LOG_DEBUG("Completed Show_CO2");
 }
 
 void Show_Weather() {
@@ -510,59 +681,66 @@ void Show_Weather() {
 
    Gets the global saved weather info fetched from the URL and displays on the TFT screen
  * *************************************************************************************************/
-  Serial.println(F("Executing Show_Weather"));
-
-  Serial.println("Timestamp         " + WTH_timestamp);
-  Serial.println("Description       " + WTH_description);
-  Serial.println("Icon              " + WTH_icon); 
-  Serial.println("Winddirection     " + WTH_winddirection);
-  Serial.println("Airpressure       " + String(WTH_airpressure));
-  Serial.println("Temperature       " + String(WTH_temperature));
-  Serial.println("Windspeed         " + String(WTH_windspeed));
-  Serial.println("Vochtigheid       " + String(WTH_humidity));
-  Serial.println("Kans op regen     " + String(WTH_precipitation));
-  Serial.println("Sunpower          " + String(WTH_sunpower));
-  Serial.println("Rain last 24 hour " + String(WTH_rainFallLast24Hour));
-  Serial.println("Rain last hour    " + String(WTH_rainFallLastHour));
-  Serial.println("Sunrise           " + String(WTH_sunrise));
-  Serial.println("Sunset            " + String(WTH_sunset)); 
+  PROFILE("Show_Weather");
+  LOG_DEBUG("Executing Show_Weather");
+  const WeatherSnapshot *w = weather_now; // Stays the same while we draw
+  char text[TEXT_LINE_LENGTH];
+  char value[TEXT_LINE_LENGTH];
+
+  LOG_DEBUG("Timestamp         %02d:%02d", w->timestamp / 60, w->timestamp % 60);
+  LOG_DEBUG("Description       %s", w->description);
+  LOG_DEBUG("Icon              %d", w->icon); 
+  LOG_DEBUG("Winddirection     %s", w->winddirection);
+  LOG_DEBUG("Airpressure       %d (1/10 hPa)", w->airpressure);
+  LOG_DEBUG("Temperature       %d (1/10 C)", w->temperature);
+  LOG_DEBUG("Windspeed         %d", w->windspeed);
+  LOG_DEBUG("Vochtigheid       %d", w->humidity);
+  LOG_DEBUG("Kans op regen     %d", w->precipitation);
+  LOG_DEBUG("Sunpower          %d", w->sunpower);
+  LOG_DEBUG("Rain last 24 hour %d (1/10 mm)", w->rainFallLast24Hour);
+  LOG_DEBUG("Rain last hour    %d (1/10 mm)", w->rainFallLastHour);
+  LOG_DEBUG("Sunrise           %02d:%02d", w->sunrise / 60, w->sunrise % 60);
+  LOG_DEBUG("Sunset            %02d:%02d", w->sunset / 60, w->sunset % 60); 
 
   yield(); // give me a break
 
   tft.startWrite();
   tft.fillScreen(TFT_BLACK);
 
-  // The name of the weather symbol is catched in the variable image
-  if (WTH_icon == "a")    tft.pushImage(95,10,50,50,zonnig);
-  if (WTH_icon == "j")    tft.pushImage(95,10,50,50,halfbewolkt);
-  if (WTH_icon == "b" || 
-      WTH_icon == "d" ||
-      WTH_icon == "f")    tft.pushImage(95,10,50,50,bewolkt);
-  if (WTH_icon == "c")    tft.pushImage(95,10,50,50,zwaarbewolkt);
-  if (WTH_icon == "cc")   tft.pushImage(95,10,50,50,wolkennacht);
-  if (WTH_icon == "g" ||
-      WTH_icon == "s")    tft.pushImage(95,10,50,50,bliksem);
-  if (WTH_icon == "t" ||
-      WTH_icon == "u" ||
-      WTH_icon == "v")    tft.pushImage(95,10,50,50,sneeuw);
-  if (WTH_icon == "m")    tft.pushImage(95,10,50,50,buien);
-  if (WTH_icon == "n")    tft.pushImage(95,10,50,50,mist);
-  if (WTH_icon == "q")    tft.pushImage(95,10,50,50,regen);
-  if (WTH_icon == "w")    tft.pushImage(95,10,50,50,hagel);
+  // Show the picture that goes with the weather symbol
+  {
+    PROFILE("pushImage");
+    switch (w->icon) {
+      case ICON_ZONNIG:       tft.pushImage(95,10,50,50,zonnig); break;
+      case ICON_HALFBEWOLKT:  tft.pushImage(95,10,50,50,halfbewolkt); break;
+      case ICON_BEWOLKT:      tft.pushImage(95,10,50,50,bewolkt); break;
+      case ICON_ZWAARBEWOLKT: tft.pushImage(95,10,50,50,zwaarbewolkt); break;
+      case ICON_WOLKENNACHT:  tft.pushImage(95,10,50,50,wolkennacht); break;
+      case ICON_BLIKSEM:      tft.pushImage(95,10,50,50,bliksem); break;
+      case ICON_SNEEUW:       tft.pushImage(95,10,50,50,sneeuw); break;
+      case ICON_BUIEN:        tft.pushImage(95,10,50,50,buien); break;
+      case ICON_MIST:         tft.pushImage(95,10,50,50,mist); break;
+      case ICON_REGEN:        tft.pushImage(95,10,50,50,regen); break;
+      case ICON_HAGEL:        tft.pushImage(95,10,50,50,hagel); break;
+      default: break;
+    }
+  }
 
   tft.fillRect(0,68,240,32,TFT_DARKGREY);
 
   tft.setTextSize(TEXT_SIZE_SMALL);
   tft.setCursor(10,118);
   tft.setTextColor(TFT_GREENYELLOW);
-  if (WTH_description.length() < TEXT_MAX_LENGTH) {
-    tft.drawCentreString(WTH_description,120,82,TEXT_SIZE_SMALL); // Value in middle
+  if (strlen(w->description) < TEXT_MAX_LENGTH) {
+    tft.drawCentreString(w->description,120,82,TEXT_SIZE_SMALL); // Value in middle
   } else {
-    int ls = WTH_description.lastIndexOf(' ', TEXT_MAX_LENGTH);
-    String w1 = WTH_description.substring(0,min(ls,TEXT_MAX_LENGTH)+1);
-    String w2 = WTH_description.substring(min(ls,TEXT_MAX_LENGTH)+1);
-    tft.drawCentreString(w1,120,75,TEXT_SIZE_SMALL); // Value in middle
-    tft.drawCentreString(w2,120,89,TEXT_SIZE_SMALL); // Value in middle
+    // Split on the last space within TEXT_MAX_LENGTH
+    int ls = TEXT_MAX_LENGTH;
+    while (ls >= 0 && w->description[ls] != ' ') ls--;
+    memcpy(text, w->description, ls + 1);
+    text[ls + 1] = 0;
+    tft.drawCentreString(text,120,75,TEXT_SIZE_SMALL); // Value in middle
+    tft.drawCentreString(w->description + ls + 1,120,89,TEXT_SIZE_SMALL); // Value in middle
   }
 
   yield(); // give me a break
@@ -575,7 +753,7 @@ void Show_Weather() {
   tft.setTextColor(TFT_WHITE);
   tft.setTextSize(TEXT_SIZE_MEDIUM);
   tft.setCursor(35,118);
-  tft.print(WTH_airpressure);
+  tft.print(Format_Fixed(value, w->airpressure, 1));
 
   // Humidity
   tft.setTextColor(TFT_YELLOW);
@@ -585,13 +763,15 @@ void Show_Weather() {
   tft.setTextColor(TFT_WHITE);
   tft.setTextSize(TEXT_SIZE_MEDIUM);
   tft.setCursor(155,118);
-  tft.print(WTH_humidity);
+  tft.print(w->humidity);
 
  
   tft.fillRect(0,140,240,32,TFT_DARKGREY);
   tft.setTextSize(TEXT_SIZE_SMALL);
   tft.setTextColor(TFT_GREENYELLOW);
-  tft.drawCentreString("Zon op " + WTH_sunrise + "   Zon onder " + WTH_sunset,120,152, TEXT_SIZE_SMALL);
+  sprintf(text, "Zon op %s", Format_Time(value, w->sunrise));
+  sprintf(text + strlen(text), "   Zon onder %s", Format_Time(value, w->sunset));
+  tft.drawCentreString(text,120,152, TEXT_SIZE_SMALL);
 
   // Wind direction
   tft.setTextColor(TFT_YELLOW);
@@ -601,7 +781,7 @@ void Show_Weather() {
   tft.setTextColor(TFT_WHITE);
   tft.setTextSize(TEXT_SIZE_MEDIUM);
   tft.setCursor(50,46);
-  tft.print(WTH_winddirection);
+  tft.print(w->winddirection);
 
   // Wind speed
   tft.setTextColor(TFT_YELLOW);
@@ -611,7 +791,7 @@ void Show_Weather() {
   tft.setTextColor(TFT_WHITE);
   tft.setTextSize(TEXT_SIZE_MEDIUM);
   tft.setCursor(155,46);
-  tft.print(WTH_windspeed);
+  tft.print(w->windspeed);
 
   // Temperature
   tft.setTextColor(TFT_YELLOW);
@@ -622,7 +802,7 @@ void Show_Weather() {
   tft.setTextSize(TEXT_SIZE_MEDIUM);
   tft.setCursor(35,193);
   tft.print((char)0x1f);
-  tft.print(WTH_temperature);
+  tft.print(Format_Fixed(value, w->temperature, 1));
   tft.print((char)247);
 
   // Sunpower
@@ -633,23 +813,300 @@ void Show_Weather() {
   tft.setTextColor(TFT_WHITE);
   tft.setTextSize(TEXT_SIZE_MEDIUM);
   tft.setCursor(155,193);
-  tft.print(WTH_sunpower);  
+  tft.print(w->sunpower);  
   
   // bottom text
   tft.setTextSize(TEXT_SIZE_SMALL);
   tft.setTextColor(TFT_MAROON);
   tft.drawCentreString("RZ Jan\'22",120,210,1);
-  tft.drawCentreString("@" + WTH_timestamp + " rc" + WTH_error,120,220,1);
+  if (w->stale) sprintf(text, "@%s oud", Format_Time(value, w->timestamp));
+  else          sprintf(text, "@%s rc%d", Format_Time(value, w->timestamp), WTH_error);
+  tft.drawCentreString(text,120,220,1);
   tft.drawLine(105,230,135,230,TFT_MAROON);
+  tft.endWrite();
+
+  LOG_DEBUG("Completed Show_Weather");
+}
+
+void Heap_Sample() {
+/* *****************************************************************************
+   Heap_Sample
+
+   Remember the lowest free heap seen during a fetch
+ * *****************************************************************************/ 
+  uint32_t free_heap = ESP.getFreeHeap();
+  if (free_heap < heap_fetch_min) heap_fetch_min = free_heap;
+}
+
+void Heap_Report(const char* host) {
+/* *****************************************************************************
+   Heap_Report
+
+   Print the peak heap use of the fetch that just finished
+ * *****************************************************************************/ 
+  Heap_Sample();
+  LOG_INFO("Heap during fetch from %s; free at start %u, lowest %u, peak use %u, largest block %u",
+           host, heap_fetch_start, heap_fetch_min, heap_fetch_start - heap_fetch_min, ESP.getMaxFreeBlockSize());
+}
+
+bool Https_Connect(const char* host, int &mfln) {
+/* *****************************************************************************
+   Https_Connect
+
+   Connect httpsClient to host. The first time we ask the server if it supports
+   MFLN; when it does the connection runs with small BearSSL buffers, which frees
+   about 15k of heap. If a connect with small buffers fails we fall back to the
+   default buffers and probe again on the next fetch
+ * *****************************************************************************/ 
+  PROFILE("Https_Connect");
+  heap_fetch_start = ESP.getFreeHeap();
+  heap_fetch_min   = heap_fetch_start;
+
+#if REPLAY_MODE != REPLAY_PLAY // A replay does not need the network
+  IPAddress ip; // Resolved apart from connect, to time it. Cached, so connect does not ask again
+  if (!WiFi.hostByName(host, ip)) {
+    LOG_ERROR("Could not resolve %s", host);
+    return false;
+  }
+#endif
+  Fetch_Phase(FETCH_DNS);
+
+  httpsClient.setInsecure(); // do not bother about certificate
+  httpsClient.setTimeout(HTTPS_TIMEOUT_SEC * 1000);
+
+  if (mfln == MFLN_UNKNOWN) {
+    mfln = httpsClient.probeMaxFragmentLength(host, HTTPS_PORT, TLS_MFLN_SIZE) ? MFLN_SUPPORTED : MFLN_UNSUPPORTED;
+    LOG_INFO("MFLN %d %s by %s", TLS_MFLN_SIZE, mfln == MFLN_SUPPORTED ? "supported" : "not supported", host);
+  }
+  bool small_buffers = (mfln == MFLN_SUPPORTED);
+  if (small_buffers) httpsClient.setBufferSizes(TLS_MFLN_RX_BUFFER, TLS_MFLN_TX_BUFFER);
+  else               httpsClient.setBufferSizes(TLS_DEFAULT_RX_BUFFER, TLS_DEFAULT_TX_BUFFER);
+  delay(ESTABLISH_DELAY);
 
-  for (int j=0;j<(SCREEN_CHANGE_TIMEOUT / 1000);j++) {
+  LOG_INFO("HTTPS Connecting to %s", host);
+  int r = 0; //retry counter
+  while (( !httpsClient.connect(host, HTTPS_PORT)) && (r < HTTPS_TIMEOUT_SEC)) {
+    if (small_buffers) { // Server might have changed its mind, continue without MFLN
+      small_buffers = false;
+      mfln = MFLN_UNKNOWN;
+      httpsClient.setBufferSizes(TLS_DEFAULT_RX_BUFFER, TLS_DEFAULT_TX_BUFFER);
+    }
     delay(1000);
-    tft.drawPixel(105+(j*3),230,TFT_SKYBLUE);
-    tft.drawPixel(105+1+(j*3),230,TFT_SKYBLUE);
+    r++;
   }
-  tft.endWrite();
+  Fetch_Retries(r);
+  if (r == HTTPS_TIMEOUT_SEC) {
+    LOG_ERROR("Connection to %s failed; BearSSL Last error %d", host, httpsClient.getLastSSLError());
+    return false;
+  }
+  Fetch_Phase(FETCH_CONNECT);
+  Heap_Sample();
+  LOG_INFO("Connection successfull after %d retries; buffers %s", r,
+           small_buffers && httpsClient.getMFLNStatus() ? "small (MFLN)" : "default");
+  return true;
+}
+
+void Https_Get(const char* host, String path, String etag, String lastModified, bool gzip) {
+/* *****************************************************************************
+   Https_Get
 
-  Serial.println(F("Completed Show_Weather"));
+   Send a (conditional) GET request. When we have validators from a previous
+   response the server can answer with 304 if nothing changed since
+ * *****************************************************************************/ 
+  String request = String("GET ") + path + " HTTP/1.1\r\n" +
+                   "Host: " + host + "\r\n";
+  if (gzip)                      request += "Accept-Encoding: gzip\r\n";
+  if (etag.length() > 0)         request += "If-None-Match: " + etag + "\r\n";
+  if (lastModified.length() > 0) request += "If-Modified-Since: " + lastModified + "\r\n";
+  request += "Connection: close\r\n\r\n";
+  httpsClient.print(request);
+
+  unsigned long sent = millis(); // Wait for the first byte of the answer, to time it
+  while (!httpsClient.available() && httpsClient.connected() && (uint32_t)(millis() - sent) < HTTPS_TIMEOUT_SEC * 1000UL) {
+    Log_Drain();
+    yield();
+  }
+  Fetch_Phase(FETCH_TTFB);
+}
+
+String Header_Value(String line, const char* name) {
+/* *****************************************************************************
+   Header_Value
+
+   Return the value of header name if line is that header, otherwise ""
+ * *****************************************************************************/ 
+  int colon = line.indexOf(':');
+  if (colon == -1 || !line.substring(0, colon).equalsIgnoreCase(name)) return "";
+  String value = line.substring(colon + 1);
+  value.trim();
+  return value;
+}
+
+int Https_Read() {
+/* *****************************************************************************
+   Https_Read
+
+   Read one byte from httpsClient, waiting for it if needed. Returns -1 when the
+   server closed the connection or did not send anything within the timeout
+ * *****************************************************************************/ 
+  unsigned long start = millis();
+  while (!httpsClient.available()) {
+    Log_Drain(); // Use the wait to send log messages
+    if (!httpsClient.connected()) return -1;
+    if ((uint32_t)(millis() - start) > HTTPS_TIMEOUT_SEC * 1000UL) {
+      body_timeout = true;
+      return -1;
+    }
+    yield(); // give me a break
+  }
+  body_bytes++;
+  return httpsClient.read();
+}
+
+int Body_Read() {
+/* *****************************************************************************
+   Body_Read
+
+   Read one byte of the response body, removing the chunked transfer encoding
+   if the server used it. Returns -1 at the end of the body
+ * *****************************************************************************/ 
+  if (!body_chunked) return Https_Read();
+
+  if (body_chunk_left == 0) { // Read the next chunk size line, e.g. "1f40;ext\r\n"
+    bool digits = false, extension = false;
+    int c;
+    while ((c = Https_Read()) >= 0) {
+      if (c == '\n') {
+        if (digits) break;
+        continue; // CRLF that ends the previous chunk
+      }
+      if (c == ';') extension = true;
+      if (extension || !isxdigit(c)) continue;
+      body_chunk_left = body_chunk_left * 16 + (isdigit(c) ? c - '0' : (c | 0x20) - 'a' + 10);
+      digits = true;
+    }
+    if (c < 0 || body_chunk_left == 0) return -1; // Last chunk
+  }
+  body_chunk_left--;
+  return Https_Read();
+}
+
+bool Feed_Match(char c, const char* pattern) {
+/* *****************************************************************************
+   Feed_Match
+
+   Feed one char to the search for pattern, returns true when found
+ * *****************************************************************************/ 
+  if (c == pattern[feed_match]) feed_match++;
+  else feed_match = (c == pattern[0]) ? 1 : 0;
+  if (pattern[feed_match] != 0) return false;
+  feed_match = 0;
+  return true;
+}
+
+void Feed_Reset() {
+/* *****************************************************************************
+   Feed_Reset
+
+   Prepare the extraction for a new weather feed
+ * *****************************************************************************/ 
+  feed_state       = FEED_FIND_ACTUAL;
+  feed_match       = 0;
+  feed_actual_len  = 0;
+  feed_station_len = 0;
+  feed_bytes       = 0;
+  feed_actual[0]   = 0;
+  feed_station[0]  = 0;
+}
+
+void Feed_Char(char c) {
+/* *****************************************************************************
+   Feed_Char
+
+   Take the next char of the weather feed. We keep the part after "actual": for
+   sunrise and sunset, and the record of our station up to its closing brace
+ * *****************************************************************************/ 
+  feed_bytes++;
+  if (feed_bytes % HEAP_SAMPLE_BYTES == 0) Heap_Sample();
+
+  switch (feed_state) {
+    case FEED_FIND_ACTUAL:
+      if (Feed_Match(c, "\"actual\":")) feed_state = FEED_ACTUAL;
+      break;
+
+    case FEED_ACTUAL:
+      feed_actual[feed_actual_len++] = c;
+      feed_actual[feed_actual_len] = 0;
+      if (feed_actual_len == FEED_ACTUAL_LENGTH) feed_state = FEED_FIND_STATION;
+      // fall through, the station may follow within these chars
+
+    case FEED_FIND_STATION:
+      if (Feed_Match(c, stationid.c_str())) {
+        feed_state = FEED_STATION;
+        feed_station_len = min((int)stationid.length(), FEED_STATION_LENGTH);
+        memcpy(feed_station, stationid.c_str(), feed_station_len);
+        feed_station[feed_station_len] = 0;
+      }
+      break;
+
+    case FEED_STATION:
+      if (c == '}' || feed_station_len == FEED_STATION_LENGTH) {
+        feed_state = FEED_DONE;
+        break;
+      }
+      feed_station[feed_station_len++] = c;
+      feed_station[feed_station_len] = 0;
+      break;
+  }
+}
+
+int Parse_Fixed(String value, int decimals) {
+/* *****************************************************************************
+   Parse_Fixed
+
+   Convert a number like "-12.34" to fixed point with 0 or 1 decimals, without
+   float math. Further decimals are cut off
+ * *****************************************************************************/ 
+  const char* p = value.c_str();
+  bool negative = (*p == '-');
+  if (negative) p++;
+  int result = 0;
+  while (isdigit(*p)) result = result * 10 + (*p++ - '0');
+  if (decimals > 0) result = result * 10 + ((*p == '.' && isdigit(p[1])) ? p[1] - '0' : 0);
+  return negative ? -result : result;
+}
+
+uint16_t Parse_Time(const char* p) {
+/* *****************************************************************************
+   Parse_Time
+
+   Convert "HH:MM" to minutes after midnight
+ * *****************************************************************************/ 
+  int hours = 0, minutes = 0;
+  while (isdigit(*p)) hours = hours * 10 + (*p++ - '0');
+  if (*p == ':') p++;
+  while (isdigit(*p)) minutes = minutes * 10 + (*p++ - '0');
+  return hours * 60 + minutes;
+}
+
+WeatherIcon Icon_Code(String code) {
+/* *****************************************************************************
+   Icon_Code
+
+   Translate the Buienradar weather symbol code to the picture we show
+ * *****************************************************************************/ 
+  if (code == "a")  return ICON_ZONNIG;
+  if (code == "j")  return ICON_HALFBEWOLKT;
+  if (code == "b" || code == "d" || code == "f") return ICON_BEWOLKT;
+  if (code == "c")  return ICON_ZWAARBEWOLKT;
+  if (code == "cc") return ICON_WOLKENNACHT;
+  if (code == "g" || code == "s") return ICON_BLIKSEM;
+  if (code == "t" || code == "u" || code == "v") return ICON_SNEEUW;
+  if (code == "m")  return ICON_BUIEN;
+  if (code == "n")  return ICON_MIST;
+  if (code == "q")  return ICON_REGEN;
+  if (code == "w")  return ICON_HAGEL;
+  return ICON_NONE;
 }
 
 String grep(String item, String payload) {
@@ -676,39 +1133,31 @@ void Get_Weather() {
 
    Time to retrieve the weather info again
  * *************************************************************************************************/
+  PROFILE("Get_Weather");
   // Retrieve info from Weerlive.nl website
-  Serial.println(F("Executing Get_Weather"));
+  LOG_DEBUG("Executing Get_Weather");
 
   String headerDate = "";
-  String payload = "";
+  String etag = "";
+  String lastModified = "";
+  bool   gzip = false;
 
-  httpsClient.setInsecure(); // do not bother about certificate
-  httpsClient.setTimeout(HTTPS_TIMEOUT_SEC * 1000);
-  delay(ESTABLISH_DELAY);
-
-  Serial.print(F("HTTPS Connecting to "));
-  Serial.print(json_host);
-  Serial.print(".");
-  int r = 0; //retry counter
-  while (( !httpsClient.connect(json_host, 443)) && (r < HTTPS_TIMEOUT_SEC)) {
-    delay(1000);
-    Serial.print(".");
-    r++;
-  }
-  if (r == HTTPS_TIMEOUT_SEC) {
-    Serial.println(F(" Connection failed"));
-    Serial.print(F("BearSSL Last error "));
-    Serial.println(httpsClient.getLastSSLError());
+  if (!Https_Connect(json_host, json_mfln)) {
+    WTH_countFail++;
     return;
   }
-  Serial.println(F(" Connection successfull"));
 
-  // Get info
-  httpsClient.print(String("GET ") + json_link + " HTTP/1.1\r\n" +
-                    "Host: " + json_host + "\r\n" +
-                    "Connection: close\r\n\r\n");
+  // Get info. Only ask for compression when an inflate window will fit; the full one, or the small
+  // one as long as the feed did not reach back further than that
+  uint32_t window = 0;
+  uint32_t block  = ESP.getMaxFreeBlockSize();
+  if (block > INFLATE_WINDOW_SIZE + INFLATE_HEAP_RESERVE) window = INFLATE_WINDOW_SIZE;
+  else if (json_small_window && block > INFLATE_SMALL_WINDOW + INFLATE_HEAP_RESERVE) window = INFLATE_SMALL_WINDOW;
+  Https_Get(json_host, json_link, WTH_etag, WTH_lastModified, window > 0);
 
   // Receive headers
+  body_chunked = false;
+  WTH_error = 0; // No status line is no status, not the one of last time
   while (httpsClient.connected()) {
 
     yield(); // give me a break
@@ -719,63 +1168,140 @@ void Get_Weather() {
     if (line.substring(0, line.indexOf(':')) == "Date")
       headerDate = line.substring(line.indexOf(':') + 2, 99);
     if (line.substring(0, line.indexOf('/')) == "HTTP")
-      WTH_error = line.substring(line.indexOf(' ') + 1, line.indexOf(' ') + 4);
+      WTH_error = line.substring(line.indexOf(' ') + 1, line.indexOf(' ') + 4).toInt();
+    if (etag.length() == 0)         etag         = Header_Value(line, "ETag");
+    if (lastModified.length() == 0) lastModified = Header_Value(line, "Last-Modified");
+    if (Header_Value(line, "Content-Encoding").equalsIgnoreCase("gzip"))    gzip = true;
+    if (Header_Value(line, "Transfer-Encoding").equalsIgnoreCase("chunked")) body_chunked = true;
   }
   
-  if (WTH_error != "200") { 
-    Serial.print(F("HTTP status "));
-    Serial.println(WTH_error);
+  if (WTH_error == 304) { // Nothing changed, keep what we have
+    httpsClient.stop();
+    WTH_count304++;
+    LOG_INFO("Weather not modified; 200/304 count %lu/%lu", WTH_count200, WTH_count304);
+    return;
+  }
+
+  if (WTH_error != 200) { 
+    httpsClient.stop();
+    WTH_countFail++;
+    LOG_WARN("HTTP status %d from %s", WTH_error, json_host);
     return;
   }
 
   // Receive body. This is a JSON string. But since it is lengthy and the JSON parser requires more mem than we 
-  // have, we stick to simply string grabbing
-  while (httpsClient.available()) {
-    yield(); // give me a break
-    char c = httpsClient.read();
-    payload += c;
+  // have, we stick to simply string grabbing. The grabbing is done while the body streams in, so we never
+  // hold more than our own station's record
+  unsigned long body_start = millis();
+  body_chunk_left = 0;
+  body_bytes      = 0;
+  body_timeout    = false;
+  Feed_Reset();
+  if (gzip) {
+    int rc = Gzip_Inflate(Body_Read, Feed_Char, window > 0 ? window : INFLATE_WINDOW_SIZE);
+    if (rc == INFLATE_ERR_WINDOW) { // Only with the small window
+      httpsClient.stop();
+      json_small_window = false;
+      LOG_WARN("Inflate window of %lu too small for the feed; fetching it plain", (unsigned long)window);
+      Get_Weather(); // Once more; plain, or with the full window, which cannot fail this way
+      return;
+    }
+    if (rc != INFLATE_OK) {
+      httpsClient.stop();
+      WTH_countFail++;
+      LOG_WARN("Inflate failed; error code: %d", rc);
+      return;
+    }
+  } else {
+    int c;
+    while ((c = Body_Read()) >= 0) Feed_Char(c);
   }
   httpsClient.stop();
-  Serial.print("Received weather message with length ");
-  Serial.println(payload.length());
+  Heap_Report(json_host);
 
-  // Find sunrise and sunset
-  payload = payload.substring(payload.indexOf("\"actual\":"));
-  WTH_sunrise = grep("sunrise",payload.substring(0,200));
-  WTH_sunrise = WTH_sunrise.substring(11,16);
+  LOG_INFO("Received weather message with length %lu; %s %lu bytes in %lu ms",
+           feed_bytes, gzip ? "gzip" : "plain", body_bytes, (unsigned long)(uint32_t)(millis() - body_start));
+
+  if (feed_state < FEED_STATION || body_timeout) {
+    WTH_countFail++;
+    LOG_WARN("Weather station not found in message");
+    return;
+  }
 
-  WTH_sunset = grep("sunset",payload.substring(0,300));
-  WTH_sunset = WTH_sunset.substring(11,16);
+  // Fill the snapshot that is not on screen
+  WeatherSnapshot *next = (weather_now == &weather_buffer[0]) ? &weather_buffer[1] : &weather_buffer[0];
+  memset(next, 0, sizeof(WeatherSnapshot));
 
-  // Grep one station and find station vars
-  payload = payload.substring(payload.indexOf(stationid));
-  payload = payload.substring(0,payload.indexOf("}"));
+  // Find sunrise and sunset
+  String payload = feed_actual;
+  next->sunrise = Parse_Time(grep("sunrise",payload.substring(0,200)).substring(11,16).c_str());
+  next->sunset  = Parse_Time(grep("sunset",payload.substring(0,300)).substring(11,16).c_str());
+
+  // Our station's vars
+  payload = feed_station;
 
   yield(); // give me a break
   // Find station vars
-  WTH_timestamp          = grep("timestamp",payload);
-  WTH_timestamp          = WTH_timestamp.substring(11,16);
-  WTH_description        = grep("weatherdescription",payload);
-        
-  WTH_icon               = grep("iconurl",payload);
-  WTH_icon               = WTH_icon.substring(WTH_icon.indexOf("30x30")+6);
-  WTH_icon               = WTH_icon.substring(0,WTH_icon.indexOf(".png"));
-
-  WTH_winddirection      = grep("winddirection",payload);
-  WTH_airpressure        = grep("airpressure",payload);
-  WTH_temperature        = grep("temperature",payload);
-  WTH_windspeed          = grep("windspeed",payload);
-  WTH_windspeed          = WTH_windspeed.substring(0,WTH_windspeed.indexOf("."));
-  WTH_humidity           = grep("humidity",payload);
-  WTH_precipitation      = grep("precipitation",payload);
+  String timestamp = grep("timestamp",payload);
+  if (timestamp.length() < 16) {
+    WTH_countFail++; // Not kept, so do not keep its validators either
+    LOG_WARN("Weather station record incomplete");
+    return;
+  }
+  WTH_count200++;
+  WTH_etag         = etag;
+  WTH_lastModified = lastModified;
+  next->timestamp          = Parse_Time(timestamp.substring(11,16).c_str());
+  grep("weatherdescription",payload).toCharArray(next->description, WEATHER_DESCRIPTION_LENGTH);
+
+  String icon = grep("iconurl",payload);
+  icon = icon.substring(icon.indexOf("30x30")+6);
+  next->icon               = Icon_Code(icon.substring(0,icon.indexOf(".png")));
+
+  grep("winddirection",payload).toCharArray(next->winddirection, WEATHER_WINDDIR_LENGTH);
+  next->airpressure        = Parse_Fixed(grep("airpressure",payload), 1);
+  next->temperature        = Parse_Fixed(grep("temperature",payload), 1);
+  next->windspeed          = Parse_Fixed(grep("windspeed",payload), 0);
+  next->humidity           = Parse_Fixed(grep("humidity",payload), 0);
+  next->precipitation      = Parse_Fixed(grep("precipitation",payload), 0);
+  next->sunpower           = Parse_Fixed(grep("sunpower",payload), 0);
+  next->rainFallLast24Hour = Parse_Fixed(grep("rainFallLast24Hour",payload), 1);
+  next->rainFallLastHour   = Parse_Fixed(grep("rainFallLastHour",payload), 1);
+
+  next->valid = true;
+  weather_now = next; // Complete; from now on the screens use the new data
+  Persist_Save(WEATHER_FILE, next, sizeof(WeatherSnapshot));
+
+  LOG_DEBUG("Completed Get_Weather");
+}
 
-  WTH_sunpower           = grep("sunpower",payload);
-  WTH_sunpower           = WTH_sunpower.substring(0,WTH_sunpower.indexOf("."));
+bool Rain_Line(const char* line, uint32_t &rain, uint16_t &minutes) {
+/* *************************************************************************************************
+   Rain_Line
 
-  WTH_rainFallLast24Hour = grep("rainFallLast24Hour",payload);
-  WTH_rainFallLastHour   = grep("rainFallLastHour",payload);
+   Parse one line of the rain forecast like "077|20:10". Since end 2020 the radar value can contain
+   decimals, which we keep up to hundredths. Returns false, and leaves rain and minutes alone, when
+   the line is not a radar value, a vertical bar and a time
+ * *************************************************************************************************/
+  int value = 0, hundredths = 0, scale = 10;
+  const char* p = line;
+
+  while (*p == ' ') p++;
+  if (!isdigit(*p)) return false;
+  while (isdigit(*p)) value = value * 10 + (*p++ - '0');
+  if (*p == '.' || *p == ',') {
+    p++;
+    while (isdigit(*p)) {
+      hundredths += (*p++ - '0') * scale;
+      scale /= 10;
+    }
+  }
+  while (*p == ' ') p++;
+  if (*p != '|' || !isdigit(p[1])) return false;
+  rain = mmHour(value, hundredths);
 
-  Serial.println("Completed Get_Weather");
+  minutes = Parse_Time(p + 1); // Time of the forecast, HH:MM
+  return true;
 }
 
 void Get_Rain() {
@@ -784,194 +1310,783 @@ void Get_Rain() {
 
    Time to retrieve the rain forecast
  * *************************************************************************************************/
-  Serial.println(F("Executing Get_Rain"));
-
-  int vertical_bar_position = 0; // Where to find the vertical bar in the answer from Buienradar
-  int lines_read = 0;
-  String line = ""; // one text line from https
-
-  httpsClient.setInsecure(); // do not bother about certificate
-  httpsClient.setTimeout(HTTPS_TIMEOUT_SEC * 1000);
-  delay(ESTABLISH_DELAY);
-
-  Serial.print(F("HTTPS Connecting to "));
-  Serial.print(rain_host);
-  Serial.print(F("."));
-
-  int r = 0; //retry counter
-  while (( !httpsClient.connect(rain_host, 443)) && (r < HTTPS_TIMEOUT_SEC)) {
-    delay(1000);
-    Serial.print(F("."));
-    r++;
-  }
-  if (r == HTTPS_TIMEOUT_SEC) {
-    Serial.println(F(" Connection failed"));
-    Serial.print(F(" BearSSL Last error "));
-    Serial.println(httpsClient.getLastSSLError());
+  PROFILE("Get_Rain");
+  LOG_DEBUG("Executing Get_Rain");
+
+  int lines_read = 0,
+      lines_skipped = 0;           // Not understood
+  char line[RAIN_LINE_LENGTH + 1]; // one text line from https
+  int line_len = 0;
+  String etag = "";
+  String lastModified = "";
+
+  if (!Https_Connect(rain_host, rain_mfln)) {
+    RAIN_countFail++;
     return;
   }
 
-  Serial.println(F(" Connected successfull"));
-
   // Get info
-  httpsClient.print(String("GET ") + rain_link1 + rain_link2 + " HTTP/1.1\r\n" +
-                    "Host: " + rain_host + "\r\n" +
-                    "Connection: close\r\n\r\n");
+  Https_Get(rain_host, String(rain_link1) + rain_link2, RAIN_etag, RAIN_lastModified, false);
 
   // Receive headers
+  body_chunked = false;
+  RAIN_error = 0;
   while (httpsClient.connected()) {
     yield(); // give me a break
     String line = httpsClient.readStringUntil('\n');
     if (line == "\r") break;
 
     if (line.substring(0, line.indexOf('/')) == "HTTP") {
-      RAIN_error = line.substring(line.indexOf(' ') + 1, line.indexOf(' ') + 4);
+      RAIN_error = line.substring(line.indexOf(' ') + 1, line.indexOf(' ') + 4).toInt();
     }
+    if (etag.length() == 0)         etag         = Header_Value(line, "ETag");
+    if (lastModified.length() == 0) lastModified = Header_Value(line, "Last-Modified");
+    if (Header_Value(line, "Transfer-Encoding").equalsIgnoreCase("chunked")) body_chunked = true;
   }
   
-  if (RAIN_error != "200") { 
-    Serial.print(F("HTTP status "));
-    Serial.println(RAIN_error);
+  if (RAIN_error == 304) { // Nothing changed, keep the current forecast
+    httpsClient.stop();
+    RAIN_count304++;
+    LOG_INFO("Rain not modified; 200/304 count %lu/%lu", RAIN_count200, RAIN_count304);
     return;
   }
 
-  // Receive body
-  Rain_max = 0; // global
+  if (RAIN_error != 200) { 
+    httpsClient.stop();
+    RAIN_countFail++;
+    LOG_WARN("HTTP status %d from %s", RAIN_error, rain_host);
+    return;
+  }
 
-  while (httpsClient.available()) {
-    yield(); // give me a break
-    line = httpsClient.readStringUntil('\n');  //Read Line by Line
-    Rain[lines_read] = 0;
-    //Serial.println("Rain read ==" + line + "==");
-
-    // Find vertical bar in line "077|20:10". Note; since end 2020 rain amount can contain decimals
-    vertical_bar_position = line.indexOf('|');
-    if (vertical_bar_position  > -1) {
-      float radarvalue = line.substring(0, vertical_bar_position).toFloat();
-      // Calculate the rain fall in mm/hour by using the values from buienradar and their 
-      // logaritmic type of scale like this 10^((value -109)/32) (example: 77 = 0.1 mm/hour)
-      Rain[lines_read] =  (pow(10, (radarvalue - 109) / 32.0) * 10.0) / 10.0;
-
-      Rain_max = max(Rain[lines_read],Rain_max); // Set new max level
+  // Receive body, line by line into a fixed buffer. Lines like "077|20:10"
+  // The forecast goes into the snapshot that is not on screen
+  RainSnapshot *next = (rain_now == &rain_buffer[0]) ? &rain_buffer[1] : &rain_buffer[0];
+  memset(next, 0, sizeof(RainSnapshot));
+  body_chunk_left = 0;
+  body_bytes      = 0;
+  body_timeout    = false;
+
+  int c;
+  do {
+    c = Body_Read();
+    if (c >= 0 && c != '\n') { 
+      if (c != '\r' && line_len < RAIN_LINE_LENGTH) line[line_len++] = c;
+      continue;
     }
+    // End of line, or end of the body with maybe a last line without newline
+    if (line_len == 0) continue;
+    line[line_len] = 0;
+    line_len = 0;
+    //Serial.println("Rain read ==" + String(line) + "==");
+
+    if (lines_read == RAIN_READINGS) continue; // More lines than we can show; ignore the rest
+    if (!Rain_Line(line, next->rain[lines_read], next->time[lines_read])) {
+      lines_skipped++; // Not a forecast, and not a dry one at 00:00 either
+      continue;
+    }
+    next->max = max(next->rain[lines_read],next->max); // Set new max level
 
     lines_read++;
-  }
+    Heap_Sample();
+  } while (c >= 0);
   httpsClient.stop();
+  Heap_Report(rain_host);
+  if (lines_skipped > 0) LOG_WARN("Rain forecast had %d lines that are not a forecast", lines_skipped);
+  if (lines_read == 0 || body_timeout) {
+    RAIN_countFail++;
+    LOG_WARN("Rain forecast incomplete");
+    return;
+  }
+  RAIN_count200++;
+  RAIN_etag         = etag;
+  RAIN_lastModified = lastModified;
  /*
-  Rain[0] = 0.1;
-  Rain[1] = 0.2;
-  Rain[2] = 0.3;
-  Rain[3] = 0.4;
-  Rain[4] = 0.5;
-  Rain[5] = 0.6;
-  Rain[6] = 0.7;
-  Rain[7] = 0.8;
-  Rain[8] = 0.9;
-  Rain[9] = 0.7;
-  Rain[10] = 0.6;
-  Rain[11] = 0.4;
-  Rain[12] = 0.2;
-  Rain[13] = 0.3;
-  Rain[14] = 0.7;
-  Rain[15] = 1;
-  Rain[16] = 1.1;
-  Rain[17] = 1.2;
-  Rain[18] = 1.3;
-  Rain[19] = 1.4;
-  Rain[20] = 1.5;
-  Rain[21] = 1.6;
-  Rain[22] = 1.7;
-  Rain[23] = 1.8;
+  next->rain[0] = 100;
+  next->rain[1] = 200;
+  next->rain[2] = 300;
+  next->rain[3] = 400;
+  next->rain[4] = 500;
+  next->rain[5] = 600;
+  next->rain[6] = 700;
+  next->rain[7] = 800;
+  next->rain[8] = 900;
+  next->rain[9] = 700;
+  next->rain[10] = 600;
+  next->rain[11] = 400;
+  next->rain[12] = 200;
+  next->rain[13] = 300;
+  next->rain[14] = 700;
+  next->rain[15] = 1000;
+  next->rain[16] = 1100;
+  next->rain[17] = 1200;
+  next->rain[18] = 1300;
+  next->rain[19] = 1400;
+  next->rain[20] = 1500;
+  next->rain[21] = 1600;
+  next->rain[22] = 1700;
+  next->rain[23] = 1800;
   */
-  Serial.print(F("Completed Get_Rain; Retrieved "));
-  Serial.print(String(lines_read));
-  Serial.print(F(" lines from "));
-  Serial.println(rain_host);
+  next->readings = lines_read;
+  next->valid = true;
+  rain_now = next; // Complete; from now on the screens use the new forecast
+  Persist_Save(RAIN_FILE, next, sizeof(RainSnapshot));
+
+  LOG_INFO("Completed Get_Rain; Retrieved %d lines from %s", lines_read, rain_host);
 }
 
-void setup() {
+void Task_Weather() {
 /* *****************************************************************************
-   Setup
+   Task_Weather
 
-   We will run this code only once, when powered on
- * *****************************************************************************/ 
- 
-  // Use serial port for debugging and program logic info
-  Serial.begin(DEBUG_OUTPUT_BAUDRATE);
-  Serial.println(); Serial.println();
-  Serial.println(F("Starting..."));
+   Scheduled every JSON_INTERVAL_SEC
+ * *****************************************************************************/
+  ALLOC_EXEMPT("Task_Weather"); // TLS and the response
+  Sim_Task(SIM_TASK_WEATHER);
+  unsigned long good = WTH_count200 + WTH_count304;
+  body_bytes = 0;
+  Fetch_Start(json_host);
+  Get_Weather();
+  Fetch_End(WTH_error, body_bytes, WTH_count200 + WTH_count304 != good);
+#if REPLAY_MODE == REPLAY_PLAY
+  Replay_Check(json_host, WTH_count200 + WTH_count304 != good);
+#endif
+}
 
-  delay(ESTABLISH_DELAY); // Wait a bit to give the system time to polish the bits
+void Task_Rain() {
+/* *****************************************************************************
+   Task_Rain
 
-  tft.init();
-  tft.setRotation(0);
+   Scheduled every RAIN_INTERVAL_SEC
+ * *****************************************************************************/
+  ALLOC_EXEMPT("Task_Rain");
+  Sim_Task(SIM_TASK_RAIN);
+  unsigned long good = RAIN_count200 + RAIN_count304;
+  body_bytes = 0;
+  Fetch_Start(rain_host);
+  Get_Rain();
+  Fetch_End(RAIN_error, body_bytes, RAIN_count200 + RAIN_count304 != good);
+#if REPLAY_MODE == REPLAY_PLAY
+  Replay_Check(rain_host, RAIN_count200 + RAIN_count304 != good);
+#endif
+}
+
+void Task_CO2() {
+/* *****************************************************************************
+   Task_CO2
+
+   Scheduled every CO2_INTERVAL_SEC
+ * *****************************************************************************/
+  ALLOC_SCOPE("Task_CO2");
+  Sim_Task(SIM_TASK_CO2);
+  Get_CO2();
+}
+
+void Task_WiFi_Renew() {
+/* *****************************************************************************
+   Task_WiFi_Renew
+
+   Scheduled every WIFI_RENEW_MS, sooner while DHCP has not answered yet
+ * *****************************************************************************/
+  if (WiFi_Renew()) Task_Delay(wifi_renew_task, WIFI_RENEW_WAIT_MS, millis());
+}
+
+void First_Frame() {
+/* *****************************************************************************
+   First_Frame
+
+   Note when the first screen with weather data was drawn after the start
+ * *****************************************************************************/
+  if (boot_first_frame != 0) return;
+  boot_first_frame = millis();
+  LOG_INFO("First weather screen %lu ms after start (%s start)", boot_first_frame, warm_start ? "warm" : "cold");
+  Boot_Mark(BOOT_FIRST_FRAME);
+}
+
+void Progress_Draw() {
+/* *****************************************************************************
+   Progress_Draw
+
+   Progress bar at the bottom of the screen, which shows when the next screen
+   will come. One dot per PROGRESS_STEP_MS the screen has been showing
+ * *****************************************************************************/
+  int due = min((int)(screen_elapsed / PROGRESS_STEP_MS), PROGRESS_STEPS);
+  for (; progress_step < due; progress_step++) {
+    tft.drawPixel(105+(progress_step*3),230,TFT_SKYBLUE);
+    tft.drawPixel(105+1+(progress_step*3),230,TFT_SKYBLUE);
+  }
+}
+
+/* *****************************************************************************
+   Screen hooks for the render loop, see Screen.h. The weather and rain screens
+   are drawn once, and again when a fetch brings new data. The CO2 screen only
+   redraws its meter when the value changed
+ * *****************************************************************************/
+void Weather_Enter() {
+}
+
+bool Weather_Update(uint32_t dt) {
+  return weather_drawn != weather_now; // New weather arrived
+}
+
+void Weather_Draw(bool dirty) {
+  if (!dirty) return;
+  Show_Weather();
+  weather_drawn = weather_now;
+  if (weather_now->valid) First_Frame();
+}
+
+void CO2_Enter() {
+}
+
+bool CO2_Update(uint32_t dt) {
+  return false;
+}
+
+void CO2_Draw(bool dirty) {
+  if (dirty) {
+    Show_CO2();
+    return;
+  }
+  if (MHZ_CO2 == co2_drawn) return;
+  tft.startWrite(); // Only the meter changed
+  ringMeter(MHZ_CO2, METER_MINVALUE, METER_MAXVALUE,
+            METER_XPOS, METER_YPOS, METER_RADIUS,"CO2",THREECOLOR); // Draw analogue meter 
+  co2_drawn = MHZ_CO2;
+  tft.endWrite();
+}
+
+void Rain_Enter() {
+}
+
+bool Rain_Update(uint32_t dt) {
+  return rain_drawn != rain_now; // New forecast arrived
+}
+
+void Rain_Draw(bool dirty) {
+  if (!dirty) return;
+  Show_Rain();
+  rain_drawn = rain_now;
+  if (rain_now->valid) First_Frame();
+}
+
+// In order of SCREEN_WEATHER, SCREEN_CO2, SCREEN_RAIN. Budgets: bytes full, bytes update, overdraw, heap
+Screen screens[SCREEN_COUNT] = {
+  { "Weather", Weather_Enter, Weather_Update, Weather_Draw, 255000, 0,      220, 512 },
+  { "CO2",     CO2_Enter,     CO2_Update,     CO2_Draw,     280000, 107000, 215, 512 },
+  { "Rain",    Rain_Enter,    Rain_Update,    Rain_Draw,    205000, 0,      175, 512 }
+};
+
+void Frame_Report() {
+/* *****************************************************************************
+   Frame_Report
+
+   Print how the frames of the last screen did against the budget
+ * *****************************************************************************/
+  if (frame_count == 0) return;
+  LOG_INFO("Frames %lu; avg %lu us, max %lu us, over budget of %d us: %lu",
+           frame_count, frame_time_total / frame_count, frame_time_max, FRAME_BUDGET_US, frame_overruns);
+  frame_count = frame_overruns = frame_time_total = frame_time_max = 0;
+}
+
+void Task_Render() {
+/* *****************************************************************************
+   Task_Render
+
+   Scheduled every FRAME_INTERVAL_MS. Moves to the next screen every
+   SCREEN_CHANGE_TIMEOUT, and lets the current screen update and draw itself
+ * *****************************************************************************/
+  PROFILE("Task_Render");
+  ALLOC_SCOPE("Task_Render");
+  Sim_Task(SIM_TASK_RENDER);
+  unsigned long frame_start = micros();
+  unsigned long now = millis();
+  uint32_t dt = now - frame_last;
+  frame_last = now;
+  screen_elapsed += dt;
+
+  bool dirty = false;
+  if (screen_to_show == 0 || screen_elapsed >= SCREEN_CHANGE_TIMEOUT) {
+    Frame_Report();
+    screen_to_show++;
+    if (screen_to_show > SCREEN_COUNT) screen_to_show = 1;
+    screen_elapsed = 0;
+    screens[screen_to_show - 1].enter();
+    dirty = true;
+  }
+
+  Screen &screen = screens[screen_to_show - 1];
+  if (screen.update(dt)) dirty = true;
+#if SCREEN_STATS_ENABLED
+  ScreenStats_Begin();
+#endif
+  screen.draw(dirty);
+#if SCREEN_STATS_ENABLED
+  if (!ScreenStats_End(screen, dirty)) frame_over_budget_total++;
+  if (ScreenStats_Get().bytes > 0) frame_bytes_last = ScreenStats_Get().bytes; // Most frames draw nothing
+  frame_bytes_total += ScreenStats_Get().bytes;
+#endif
+#if SIM_ENABLED
+  const Screen_Stats &stats = ScreenStats_Get();
+  if (stats.pixels > 0) Sim_Frame(screen.name, stats.hash, stats.bytes);
+#endif
+  if (dirty) progress_step = 0; // Screen was cleared, draw all dots again
+  Progress_Draw();
+
+  uint32_t frame_time = micros() - frame_start;
+  frame_count++;
+  frame_time_total += frame_time;
+  if (frame_time > frame_time_max)  frame_time_max = frame_time;
+  if (frame_time > FRAME_BUDGET_US) frame_overruns++;
+
+  frame_time_last = frame_time;
+  frame_time_sum += frame_time;
+  frame_count_total++;
+  if (frame_time > FRAME_BUDGET_US) frame_overruns_total++;
+}
+
+void Metrics_Fetch(const char* host) {
+/* *****************************************************************************
+   Metrics_Fetch
+
+   Phases of the last fetch from host, see Fetch.h
+ * *****************************************************************************/
+  char labels[64];
+  const Fetch_Record *record = Fetch_Last(host);
+  if (record == NULL) return;
+  for (uint8_t i = 0; i < FETCH_PHASES; i++) {
+    snprintf_P(labels, sizeof(labels), PSTR("host=\"%s\",phase=\"%s\""), host, Fetch_Phase_Name(i));
+    Metrics_Micros("roundmeter_fetch_seconds", labels, record->phase[i] * 1000ULL);
+  }
+  snprintf_P(labels, sizeof(labels), PSTR("host=\"%s\",phase=\"total\""), host);
+  Metrics_Micros("roundmeter_fetch_seconds", labels, record->total * 1000ULL);
+}
+
+void Fetches_Handle() {
+/* *****************************************************************************
+   Fetches_Handle
+
+   Answer GET /fetches with the recent fetches, newest first
+ * *****************************************************************************/
+  Metrics_Start(server);
+  Metrics_Line(PSTR("%-24s %8s %6s %5s %8s %6s %6s %6s %7s %7s\n"),
+               "host", "age (s)", "status", "retry", "bytes", "dns", "conn", "ttfb", "body", "total");
+  for (uint8_t age = 0; age < FETCH_RECORDS; age++) {
+    const Fetch_Record *record = Fetch_Get(age);
+    if (record == NULL) break;
+    Metrics_Line(PSTR("%-24s %8lu %6d %5d %8lu %6lu %6lu %6lu %7lu %7lu\n"),
+                 record->host, (unsigned long)(uint32_t)(millis() - record->start) / 1000, record->status, record->retries, record->bytes,
+                 record->phase[FETCH_DNS], record->phase[FETCH_CONNECT], record->phase[FETCH_TTFB],
+                 record->phase[FETCH_BODY], record->total);
+  }
+  Metrics_End();
+}
+
+#if SCREEN_HEATMAP_ENABLED
+void Heatmap_Handle() {
+/* *****************************************************************************
+   Heatmap_Handle
+
+   Answer GET /heatmap with the overdraw of every screen as text, and
+   GET /heatmap.svg?screen=Weather with that of one screen as an image
+ * *****************************************************************************/
+  if (server.uri().endsWith(".svg")) {
+    Metrics_Start(server, "image/svg+xml");
+    ScreenStats_Heatmap_SVG(server.arg("screen").c_str());
+  } else {
+    Metrics_Start(server, "text/plain");
+    ScreenStats_Heatmap();
+  }
+  Metrics_End();
+}
+#endif
+
+void Metrics_Handle() {
+/* *****************************************************************************
+   Metrics_Handle
+
+   Answer GET /metrics in Prometheus text format. Written in chunks, see Metrics.h
+ * *****************************************************************************/
+  char labels[24];
+
+  Metrics_Start(server);
+  Metrics_Header("roundmeter_uptime_seconds", METRIC_COUNTER, "Seconds since the start");
+  Metrics_Unsigned("roundmeter_uptime_seconds", NULL, millis() / 1000);
+
+  Metrics_Header("roundmeter_boot_first_frame_seconds", METRIC_GAUGE, "Start until the first screen with weather data");
+  Metrics_Micros("roundmeter_boot_first_frame_seconds", NULL, boot_first_frame * 1000ULL);
+
+  Metrics_Header("roundmeter_boot_wifi_seconds", METRIC_GAUGE, "Time to get on the network at the start");
+  Metrics_Micros("roundmeter_boot_wifi_seconds", NULL, wifi_connect_ms * 1000ULL);
+
+  // Memory
+  Metrics_Header("roundmeter_heap_free_bytes", METRIC_GAUGE, "Free heap");
+  Metrics_Unsigned("roundmeter_heap_free_bytes", NULL, ESP.getFreeHeap());
+  Metrics_Header("roundmeter_heap_max_block_bytes", METRIC_GAUGE, "Largest free block of the heap");
+  Metrics_Unsigned("roundmeter_heap_max_block_bytes", NULL, ESP.getMaxFreeBlockSize());
+  Metrics_Header("roundmeter_heap_fragmentation_percent", METRIC_GAUGE, "Heap fragmentation");
+  Metrics_Unsigned("roundmeter_heap_fragmentation_percent", NULL, ESP.getHeapFragmentation());
+  Metrics_Header("roundmeter_heap_fetch_min_bytes", METRIC_GAUGE, "Lowest free heap during the last fetch");
+  Metrics_Unsigned("roundmeter_heap_fetch_min_bytes", NULL, heap_fetch_min);
+  Metrics_Header("roundmeter_stack_free_bytes", METRIC_GAUGE, "Free continuation stack");
+  Metrics_Unsigned("roundmeter_stack_free_bytes", NULL, ESP.getFreeContStack());
+
+  // Fetching
+  Metrics_Header("roundmeter_fetch_seconds", METRIC_GAUGE, "Duration of the last fetch per host and phase");
+  Metrics_Fetch(json_host);
+  Metrics_Fetch(rain_host);
+  Metrics_Header("roundmeter_http_status", METRIC_GAUGE, "HTTP status of the last fetch");
+  Metrics_Value("roundmeter_http_status", "feed=\"weather\"", WTH_error);
+  Metrics_Value("roundmeter_http_status", "feed=\"rain\"",    RAIN_error);
+  Metrics_Header("roundmeter_fetches_total", METRIC_COUNTER, "Fetches by result");
+  Metrics_Unsigned("roundmeter_fetches_total", "feed=\"weather\",result=\"200\"",  WTH_count200);
+  Metrics_Unsigned("roundmeter_fetches_total", "feed=\"weather\",result=\"304\"",  WTH_count304);
+  Metrics_Unsigned("roundmeter_fetches_total", "feed=\"weather\",result=\"fail\"", WTH_countFail);
+  Metrics_Unsigned("roundmeter_fetches_total", "feed=\"rain\",result=\"200\"",     RAIN_count200);
+  Metrics_Unsigned("roundmeter_fetches_total", "feed=\"rain\",result=\"304\"",     RAIN_count304);
+  Metrics_Unsigned("roundmeter_fetches_total", "feed=\"rain\",result=\"fail\"",    RAIN_countFail);
+
+  // CO2 sensor
+  Metrics_Header("roundmeter_co2_ppm", METRIC_GAUGE, "CO2 of the last good read");
+  Metrics_Value("roundmeter_co2_ppm", NULL, MHZ_CO2);
+  Metrics_Header("roundmeter_co2_temperature_celsius", METRIC_GAUGE, "Temperature of the MH-Z19B");
+  Metrics_Value("roundmeter_co2_temperature_celsius", NULL, MHZ_Temp);
+  Metrics_Header("roundmeter_co2_result", METRIC_GAUGE, "MHZ19_RESULT of the last read");
+  Metrics_Value("roundmeter_co2_result", NULL, MHZ_Error);
+  Metrics_Header("roundmeter_co2_reads_total", METRIC_COUNTER, "Sensor reads per MHZ19_RESULT");
+  for (int i = 0; i < MHZ_RESULT_CODES; i++) {
+    snprintf_P(labels, sizeof(labels), PSTR("result=\"%d\""), i);
+    Metrics_Unsigned("roundmeter_co2_reads_total", labels, MHZ_results[i]);
+  }
+
+  // Rendering
+  Metrics_Header("roundmeter_frame_seconds", "summary", "Time to update and draw a frame");
+  Metrics_Micros("roundmeter_frame_seconds_sum", NULL, frame_time_sum);
+  Metrics_Unsigned("roundmeter_frame_seconds_count", NULL, frame_count_total);
+  Metrics_Header("roundmeter_frame_last_seconds", METRIC_GAUGE, "Time of the last frame");
+  Metrics_Micros("roundmeter_frame_last_seconds", NULL, frame_time_last);
+  Metrics_Header("roundmeter_frame_overruns_total", METRIC_COUNTER, "Frames over FRAME_BUDGET_US");
+  Metrics_Unsigned("roundmeter_frame_overruns_total", NULL, frame_overruns_total);
+#if SCREEN_STATS_ENABLED
+  Metrics_Header("roundmeter_frame_spi_bytes", METRIC_GAUGE, "Estimated SPI bytes of the last frame that drew");
+  Metrics_Unsigned("roundmeter_frame_spi_bytes", NULL, frame_bytes_last);
+  Metrics_Header("roundmeter_frame_spi_bytes_total", METRIC_COUNTER, "Estimated SPI bytes of all frames");
+  Metrics_Unsigned("roundmeter_frame_spi_bytes_total", NULL, frame_bytes_total);
+  Metrics_Header("roundmeter_frame_over_budget_total", METRIC_COUNTER, "Draws over a budget of their screen");
+  Metrics_Unsigned("roundmeter_frame_over_budget_total", NULL, frame_over_budget_total);
+#endif
+  Metrics_End();
+}
+
+void Show_Splash() {
+/* *****************************************************************************
+   Show_Splash
+
+   Start up screen, the status lines follow with Splash_Line
+ * *****************************************************************************/
   tft.fillScreen(TFT_BLACK);
-  
+
   tft.setTextColor(TFT_RED);
   tft.setTextSize(TEXT_SIZE_MEDIUM);
   tft.drawCentreString("CO2 meter " + String(VERSION),METER_RADIUS,40,TEXT_SIZE_MEDIUM);
   tft.setTextColor(TFT_SKYBLUE);
   tft.setTextSize(TEXT_SIZE_SMALL);
   tft.drawCentreString("github.com/idurz/RoundMeter",METER_RADIUS,74,TEXT_SIZE_SMALL);
-  
-  int left=35;
 
-  tft.setCursor(left,90);
   tft.setTextSize(TEXT_SIZE_SMALL);
   tft.setTextColor(TFT_YELLOW);
+}
 
-  tft.print("Starting...");
+void Splash_Line(int y, String text) {
+/* *****************************************************************************
+   Splash_Line
 
-  WiFiManager wifiManager; /* Local intialization in the setup routine instead of global
-                              Once its business is done, there is no need to keep it around */
+   Status line on the start up screen. Left out on a warm start, when the
+   screen shows the weather instead
+ * *****************************************************************************/
+  if (warm_start) return;
+  tft.setCursor(SPLASH_LEFT, y);
+  tft.print(text);
+}
+
+#if BENCH_ENABLED
+void Bench_FillScreen()  { tft.fillScreen(TFT_BLACK); }
+void Bench_Icon()        { tft.pushImage(95, 10, 50, 50, bewolkt); }
+void Bench_Band()        { tft.fillRect(0, 68, 240, 32, TFT_DARKGREY); }
+void Bench_Text_Small()  { tft.drawCentreString("Zwaar bewolkt met later", 120, 82, TEXT_SIZE_SMALL); }
+void Bench_Text_Large()  { tft.drawCentreString("1013 hPa", 120, 150, TEXT_SIZE_LARGE); }
+void Bench_Text_XLarge() { tft.drawCentreString(" 812 ", 115, 100, TEXT_SIZE_XLARGE); }
+void Bench_Print()       { tft.setCursor(5, 120); tft.print("Geen regen voorzien"); }
+void Bench_Rain_Bar()    { tft.drawLine(120, 200, 120, 120, TFT_BLUE); }
+void Bench_Segment()     { tft.fillTriangle(120, 0, 120, 30, 131, 1, TFT_GREEN);
+                           tft.fillTriangle(120, 30, 131, 1, 128, 31, TFT_GREEN); }
+void Bench_Ring()        { ringMeter(812, METER_MINVALUE, METER_MAXVALUE, METER_XPOS, METER_YPOS, METER_RADIUS, "CO2", THREECOLOR); }
+void Bench_Show_CO2()    { Show_CO2(); }
+
+// The TFT_eSPI calls the screens make, as they make them, with the bytes and
+// calls of ScreenStats as their baseline; see Bench.h
+const Bench_Case bench_screen_cases[] = {
+  { "fillScreen",           Bench_FillScreen,   115211,    1 },
+  { "pushImage icon",       Bench_Icon,           5011,    1 },
+  { "fillRect band",        Bench_Band,          15371,    1 },
+  { "drawCentreString 1",   Bench_Text_Small,     2461,   23 },
+  { "drawCentreString 4",   Bench_Text_Large,     7160,    8 },
+  { "drawCentreString 6",   Bench_Text_XLarge,   16375,    5 },
+  { "print",                Bench_Print,          2033,   19 },
+  { "drawLine rain bar",    Bench_Rain_Bar,        173,    1 },
+  { "fillTriangle segment", Bench_Segment,        1406,   62 },
+  { "ringMeter",            Bench_Ring,          68172, 2008 },
+  { "Show_CO2",             Bench_Show_CO2,     183456, 2010 }
+};
+
+int Bench_Screens() {
+/* *****************************************************************************
+   Bench_Screens
 
+   Time the drawing calls of the screens, and put back what the cases changed.
+   Returns the number of cases that failed
+ * *****************************************************************************/
+  int co2 = MHZ_CO2;
+  MHZ_CO2 = 812;
+  tft.setTextColor(TFT_WHITE, TFT_BLACK);
+  tft.setTextSize(TEXT_SIZE_SMALL);
+  int failed = Bench_Screen(bench_screen_cases, sizeof(bench_screen_cases) / sizeof(bench_screen_cases[0]));
+  MHZ_CO2 = co2;
+  tft.fillScreen(TFT_BLACK);
+  return failed;
+}
+#endif
+
+#if GOLDEN_ENABLED
+WeatherSnapshot      golden_weather;
+RainSnapshot         golden_rain;
+
+void Golden_Splash(int arg) {
+  Show_Splash();
+  Splash_Line(90, "Starting...");
+}
+
+void Golden_Weather(int icon) {
+  golden_weather = { true, false, 12 * 60 + 30, 8 * 60 + 15, 17 * 60 + 45, 123, 10132, 4, 250, 35, 5, 78, 40,
+                     (WeatherIcon)icon, "ZZW", "Zwaar bewolkt met later op de dag kans op regen" };
+  weather_now = &golden_weather;
+  Show_Weather();
+}
+
+void Golden_CO2(int value) {
+  MHZ_CO2 = value;
+  Show_CO2();
+}
+
+void Golden_Rain(int peak) {
+/* *****************************************************************************
+   Golden_Rain
+
+   Two hours of forecasts from 12:00, a shower that peaks at the given rain
+   (1/1000 mm/hour) after an hour
+ * *****************************************************************************/
+  golden_rain = {};
+  golden_rain.valid    = true;
+  golden_rain.readings = RAIN_READINGS;
+  for (uint8_t i = 0; i < RAIN_READINGS; i++) {
+    golden_rain.time[i] = 12 * 60 + 5 * i;
+    golden_rain.rain[i] = peak * (12 - min(abs(i - 12), 12)) / 12;
+    golden_rain.max     = max(golden_rain.max, golden_rain.rain[i]);
+  }
+  golden_weather.rainFallLast24Hour = 35;
+  weather_now = &golden_weather;
+  rain_now = &golden_rain;
+  Show_Rain();
+}
+
+// Every screen with fixed data and the hash it should draw; see Golden.h
+const Golden_Case golden_cases[] = {
+  { "Splash",              Golden_Splash,  0,                 0x2be29fbd },
+  { "Weather no icon",     Golden_Weather, ICON_NONE,         0xeda8ee56 },
+  { "Weather zonnig",      Golden_Weather, ICON_ZONNIG,       0x1c8e571e },
+  { "Weather halfbewolkt", Golden_Weather, ICON_HALFBEWOLKT,  0x6be15d46 },
+  { "Weather bewolkt",     Golden_Weather, ICON_BEWOLKT,      0xcb268b11 },
+  { "Weather zwaarbewolkt",Golden_Weather, ICON_ZWAARBEWOLKT, 0x84a8466c },
+  { "Weather wolkennacht", Golden_Weather, ICON_WOLKENNACHT,  0xc2bd6fea },
+  { "Weather bliksem",     Golden_Weather, ICON_BLIKSEM,      0xe94e0971 },
+  { "Weather sneeuw",      Golden_Weather, ICON_SNEEUW,       0x11f1dc16 },
+  { "Weather buien",       Golden_Weather, ICON_BUIEN,        0x4ad07e7f },
+  { "Weather mist",        Golden_Weather, ICON_MIST,         0x50c7b721 },
+  { "Weather regen",       Golden_Weather, ICON_REGEN,        0x6b711f11 },
+  { "Weather hagel",       Golden_Weather, ICON_HAGEL,        0x163d5074 },
+  { "CO2 400",             Golden_CO2,     400,               0x5326ef21 }, // Green
+  { "CO2 790",             Golden_CO2,     790,               0x12947e4b }, // Just below yellow
+  { "CO2 1000",            Golden_CO2,     1000,              0x5cee2830 }, // Yellow
+  { "CO2 1300",            Golden_CO2,     1300,              0xe1cbf043 }, // Red
+  { "CO2 2400",            Golden_CO2,     METER_MAXVALUE,    0x0ecce51f }, // Full scale
+  { "Rain dry",            Golden_Rain,    0,                 0xc14d96e1 },
+  { "Rain light",          Golden_Rain,    800,               0xe3a01770 },
+  { "Rain heavy",          Golden_Rain,    25000,             0x333599aa }
+};
+const uint8_t golden_case_count = sizeof(golden_cases) / sizeof(golden_cases[0]);
+
+int Golden_Screens() {
+/* *****************************************************************************
+   Golden_Screens
+
+   Run the golden image checks, and put back what the cases changed. Returns
+   the number of cases that failed
+ * *****************************************************************************/
+  WeatherSnapshot *weather = weather_now;
+  RainSnapshot    *rain    = rain_now;
+  int              co2     = MHZ_CO2;
+  int failed = Golden_Run(golden_cases, golden_case_count);
+  weather_now = weather;
+  rain_now    = rain;
+  MHZ_CO2     = co2;
+  return failed;
+}
+#endif
+
+void setup() {
+/* *****************************************************************************
+   Setup
+
+   We will run this code only once, when powered on
+ * *****************************************************************************/ 
+ 
+  // Use serial port for debugging and program logic info
+  Serial.begin(DEBUG_OUTPUT_BAUDRATE);
+  Serial.println(); Serial.println();
+  LOG_INFO("Starting...");
+  Boot_Begin();
+
+  delay(ESTABLISH_DELAY); // Wait a bit to give the system time to polish the bits
+  Boot_Mark(BOOT_SERIAL);
+
+#if BENCH_ENABLED
+  bench_failed = Bench_Run(); // Before tft.init, which takes the display back afterwards
+#endif
+
+  tft.init();
+  tft.setRotation(0);
+  Boot_Mark(BOOT_TFT);
+
+#if BENCH_ENABLED
+  bench_failed += Bench_Screens(); // The calls of the firmware, now that tft has the display
+  if (bench_failed > 0) LOG_ERROR("Bench; %d cases over the baseline", bench_failed);
+#endif
+#if GOLDEN_ENABLED
+  Golden_Screens(); // With the display, before any real data
+#endif
+
+  // Show what we had before the restart straight away, the fetches will replace it
+  if (Persist_Begin()) {
+    if (Persist_Load(WEATHER_FILE, &weather_buffer[0], sizeof(WeatherSnapshot)) && weather_buffer[0].valid) {
+      weather_buffer[0].stale = true;
+      warm_start = true;
+    }
+    if (Persist_Load(RAIN_FILE, &rain_buffer[0], sizeof(RainSnapshot)) && rain_buffer[0].valid) {
+      rain_buffer[0].stale = true;
+    }
+  }
+  if (warm_start) {
+    LOG_INFO("Warm start; showing the weather of %02d:%02d until the first fetch",
+             weather_now->timestamp / 60, weather_now->timestamp % 60);
+    Show_Weather();
+    First_Frame();
+  } else {
+    Show_Splash();
+  }
+  Splash_Line(90, "Starting...");
+  Boot_Mark(BOOT_SCREEN);
+
+#if SIM_ENABLED
+  LOG_INFO("Simulation; not using WiFi, the network is replayed");
+#else
   WiFi.hostname(DEVICE_NAME); // Set DHCP name
-  wifiManager.setAPCallback(configModeCallback); // set callback that gets called when connecting
-  wifiManager.setDebugOutput(false);             // to previous WiFi fails, and enters Access Point mode
-
-  // Fetches ssid and pass and tries to connect. If it does not connect it starts an access point
-  // with the specified name and goes into a blocking loop awaiting configuration
-  tft.setCursor(left,105);
-  if (!wifiManager.autoConnect(DEVICE_NAME)) {
-    tft.print(F("Verbinding mislukt...Herstart"));
-    Serial.println(F("Connection to accesspoint did not work. Will reset myself soon"));
-    delay(RESET_DELAY_ON_ERROR);  // wait a bit so user can read the message
-    ESP.reset();  //reset and try again
-  }
-  // If we arrive here we have a network connection
-  delay(ESTABLISH_DELAY); // wait a bit to get eveything finished   
-  Serial.print(F("Connected to  ")); Serial.println(String(WiFi.SSID()));
-  Serial.print(F("My IP address ")); Serial.println(WiFi.localIP().toString());
-  Serial.print(F("My hostname   ")); Serial.println(WiFi.hostname());
-
-  tft.print("Connected to  " + String(WiFi.SSID()));
-  tft.setCursor(left,120);
-  tft.print("My IP address " + WiFi.localIP().toString());
-  tft.setCursor(left,135);
-  tft.print("My hostname   " +WiFi.hostname());
+  unsigned long wifi_start = millis();
+
+  // First try the access point of last time directly, that takes a fraction of a full connect
+  if (!WiFi_Fast_Connect(WIFI_FAST_TIMEOUT_MS)) {
+    WiFiManager wifiManager; /* Local intialization in the setup routine instead of global
+                                Once its business is done, there is no need to keep it around */
+
+    wifiManager.setAPCallback(configModeCallback); // set callback that gets called when connecting
+    wifiManager.setDebugOutput(false);             // to previous WiFi fails, and enters Access Point mode
+
+    // Fetches ssid and pass and tries to connect. If it does not connect it starts an access point
+    // with the specified name and goes into a blocking loop awaiting configuration
+    if (!wifiManager.autoConnect(DEVICE_NAME)) {
+      tft.setCursor(SPLASH_LEFT,105);
+      tft.print(F("Verbinding mislukt...Herstart"));
+      LOG_ERROR("Connection to accesspoint did not work. Will reset myself soon");
+      Log_Flush();
+      delay(RESET_DELAY_ON_ERROR);  // wait a bit so user can read the message
+      ESP.reset();  //reset and try again
+    }
+    // If we arrive here we have a network connection
+    delay(ESTABLISH_DELAY); // wait a bit to get eveything finished   
+    WiFi_Remember(); // For a fast connect next time
+  }
+  wifi_connect_ms = (uint32_t)(millis() - wifi_start);
+  LOG_INFO("WiFi associated in %lu ms", wifi_connect_ms);
+#endif
+  Boot_Mark(BOOT_WIFI);
+  String ssid     = WiFi.SSID();
+  String ip       = WiFi.localIP().toString();
+  String hostname = WiFi.hostname();
+  LOG_INFO("Connected to  %s", ssid.c_str());
+  LOG_INFO("My IP address %s", ip.c_str());
+  LOG_INFO("My hostname   %s", hostname.c_str());
+  Log_Flush(); // Before the Strings go out of scope
+
+  Splash_Line(105, "Connected to  " + String(WiFi.SSID()));
+  Splash_Line(120, "My IP address " + WiFi.localIP().toString());
+  Splash_Line(135, "My hostname   " +WiFi.hostname());
 
   // start comm with MHZ-19B sensor
   sensor.begin(SENSOR_OUTPUT_BAUDRATE); 
-  MHZ19_RESULT MHZ_Error = mhz.setRange(MHZ19_RANGE_3000);
+  MHZ_Error = mhz.setRange(MHZ19_RANGE_3000);
   if (MHZ_Error == MHZ19_RESULT_OK) {
-    Serial.println("Sensor range  0..3000");
-    tft.setCursor(left,150);
-    tft.print("Sensor range  0..3000");
+    LOG_INFO("Sensor range  0..3000");
+    Splash_Line(150, "Sensor range  0..3000");
   } else {
-    Serial.print("Could not set sensor range; Error, code: ");
-    Serial.println(MHZ_Error);
-    tft.setCursor(left,150);
-    tft.print("Sensor range  FAILED");
+    LOG_WARN("Could not set sensor range; Error, code: %d", MHZ_Error);
+    Splash_Line(150, "Sensor range  FAILED");
   }
-
-  tft.setCursor(left,165);
-  tft.print("Weerstation   " +stationid);
-
-  tft.setCursor(left,180);
-  tft.print("Regen @ " + String(rain_link2));
-
-  delay(2500);
+  CO2_Begin(&sensor);
+  CO2_Request(); // First reading is ready by the time we show it
+  Boot_Mark(BOOT_SENSOR);
+
+  Splash_Line(165, "Weerstation   " +stationid);
+  Splash_Line(180, "Regen @ " + String(rain_link2));
+
+  if (!warm_start) delay(2500); // Time to read the start up screen
+  Boot_Mark(BOOT_SPLASH_WAIT);
+
+  // Fetch first, so the first screen has data to show
+  uint32_t now = millis();
+  Task_Add(Task_Weather,  0, JSON_INTERVAL_SEC * 1000UL, PRIO_GET_WEATHER, now);
+  Task_Add(Task_Rain,     0, RAIN_INTERVAL_SEC * 1000UL, PRIO_GET_RAIN, now);
+  Task_Add(Task_Render,   0, FRAME_INTERVAL_MS,          PRIO_RENDER, now);
+  Task_Add(Task_CO2,      0, CO2_INTERVAL_SEC * 1000UL,  PRIO_CO2, now);
+  server.on("/metrics", HTTP_GET, Metrics_Handle);
+  server.on("/fetches", HTTP_GET, Fetches_Handle);
+#if SCREEN_HEATMAP_ENABLED
+  server.on("/heatmap",     HTTP_GET, Heatmap_Handle);
+  server.on("/heatmap.svg", HTTP_GET, Heatmap_Handle);
+#endif
+  server.begin();
+#if PROFILE_ENABLED
+  Task_Add(Profile_Report, PROFILE_REPORT_SEC * 1000UL, PROFILE_REPORT_SEC * 1000UL, PRIO_PROFILE, now);
+#endif
+#if SIM_ENABLED
+  Task_Add(Sim_Report, SIM_REPORT_SEC * 1000UL, SIM_REPORT_SEC * 1000UL, PRIO_SIM, now);
+#endif
+#if ALLOC_ENABLED
+  Task_Add(Alloc_Report, ALLOC_REPORT_SEC * 1000UL, ALLOC_REPORT_SEC * 1000UL, PRIO_ALLOC, now);
+  Task_Add(Alloc_Steady, ALLOC_SETTLE_SEC * 1000UL, TASK_ONCE,                  PRIO_ALLOC, now);
+#endif
+#if !SIM_ENABLED
+  wifi_renew_task = Task_Add(Task_WiFi_Renew, WIFI_RENEW_MS, WIFI_RENEW_MS, PRIO_WIFI, now);
+#endif
+  frame_last = millis();
+  Boot_Mark(BOOT_TASKS);
 }
 
 void loop() {
@@ -981,23 +2096,18 @@ void loop() {
    Keep doing this until we loose power
  * *****************************************************************************/
 
-  // Do we need to fetch new info?
-  if (json_next_get < millis()) {
-    Get_Weather(); 
-    json_next_get = millis() + (JSON_INTERVAL_SEC * 1000);
-  } 
-  if (rain_next_get < millis()) {
-    Get_Rain(); 
-    rain_next_get = millis() + (RAIN_INTERVAL_SEC * 1000);
-  } 
-
-  // Decide which screen to show
-  screen_to_show++;
-  if (screen_to_show > SCREEN_COUNT) screen_to_show = 1;
-
-  if (screen_to_show == SCREEN_WEATHER) Show_Weather();
-  if (screen_to_show == SCREEN_RAIN)    Show_Rain();
-  if (screen_to_show == SCREEN_CO2)     Show_CO2();
+  // Run whatever task is due; fetching, sensor and the render loop
+  Task_Run(millis());
+  {
+    ALLOC_EXEMPT("handleClient"); // The web server parses into Strings
+    server.handleClient(); // Metrics scrapes
+  }
+  Log_Drain();
+  Alloc_Loop();
+#if SIM_ENABLED
+  Sim_Idle(Task_Next(millis())); // Straight on to the next deadline
+#endif
+  yield(); // give me a break
 }
 
 /* *****************************************************************************
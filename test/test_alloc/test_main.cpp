@@ -0,0 +1,68 @@
+/* *****************************************************************************
+
+   Copyright (C) 2022 P.A.G.M. Zengers
+
+   No allocations in the steady state, on the native env: after every screen
+   has been shown once, loop() runs through every screen and fetch again and
+   only the exempt scopes may allocate. Needs the malloc wrap and operator
+   new of lib/Native/New.cpp, see Alloc.h and the native_alloc env
+
+   This program is free software: you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation, either version 3 of the License, or
+   (at your option) any later version.
+
+ * ****************************************************************************/
+
+#include <Arduino.h>
+#include <unity.h>
+#include "Alloc.h"
+#include "Native.h"
+
+#define SCREENS_MS                 40000 // Every screen shown once, at 10 s each
+#define FETCHES_MS                 (600000 + SCREENS_MS) // Both fetches again, every screen after them
+
+void setup();
+void loop();
+
+static void Run(uint32_t ms) {
+  uint32_t start = millis();
+  while ((uint32_t)(millis() - start) < ms) {
+    loop();
+    delay(10);
+  }
+}
+
+void setUp() {
+}
+
+void tearDown() {
+}
+
+void test_steady_state() {
+  Alloc_Steady();
+  Run(FETCHES_MS);
+  Alloc_Report();
+  TEST_ASSERT_EQUAL(0, Alloc_Failures());
+}
+
+void test_string_is_counted() {
+/* *****************************************************************************
+   test_string_is_counted
+
+   A String too long for the buffer inside std::string allocates through
+   operator new in libstdc++; that has to count as well
+ * *****************************************************************************/
+  uint32_t before = Alloc_Failures();
+  String text("longer than the small string buffer of std::string");
+  TEST_ASSERT_EQUAL(before + 1, Alloc_Failures());
+}
+
+int main(int argc, char **argv) {
+  setup();
+  Run(SCREENS_MS);
+  UNITY_BEGIN();
+  RUN_TEST(test_steady_state);
+  RUN_TEST(test_string_is_counted); // Last, it is a failure on purpose
+  return UNITY_END();
+}
@@ -0,0 +1,57 @@
+/* *****************************************************************************
+
+   Copyright (C) 2022 P.A.G.M. Zengers
+
+   The benchmarks on the native env: the bytes and commands of every case
+   against the baseline checked in with the cases. The times of the host are
+   no baseline; they are taken afresh on every run. See Bench.h and the
+   native_bench env
+
+   This program is free software: you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation, either version 3 of the License, or
+   (at your option) any later version.
+
+ * ****************************************************************************/
+
+#include <Arduino.h>
+#include <unity.h>
+#include <LittleFS.h>
+#include "Bench.h"
+#include "Persist.h"
+
+void setup();
+int  Bench_Screens();
+
+extern int bench_failed;
+
+static void Forget_Times() {
+  LittleFS.remove(BENCH_FILE);
+  LittleFS.remove(BENCH_SCREEN_FILE);
+}
+
+void setUp() {
+}
+
+void tearDown() {
+}
+
+void test_at_the_start() {
+  TEST_ASSERT_EQUAL(0, bench_failed); // What setup() ran
+}
+
+void test_again() {
+  Forget_Times();
+  TEST_ASSERT_EQUAL(0, Bench_Run());
+  TEST_ASSERT_EQUAL(0, Bench_Screens()); // Nothing left behind by the first run changes the counts
+}
+
+int main(int argc, char **argv) {
+  Persist_Begin();
+  Forget_Times();
+  setup();
+  UNITY_BEGIN();
+  RUN_TEST(test_at_the_start);
+  RUN_TEST(test_again);
+  return UNITY_END();
+}
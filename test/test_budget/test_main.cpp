@@ -0,0 +1,119 @@
+/* *****************************************************************************
+
+   Copyright (C) 2022 P.A.G.M. Zengers
+
+   The screens against their budgets on the native env: the recordings of
+   data/replay through Get_Weather and Get_Rain, a series of CO2 values
+   through the emulated sensor and Get_CO2, each drawn as the render loop
+   does and checked with ScreenStats_End. The heap a draw takes is counted
+   as the bytes it allocates. See Screen.h, ScreenStats.h and the
+   native_budget env
+
+   This program is free software: you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation, either version 3 of the License, or
+   (at your option) any later version.
+
+ * ****************************************************************************/
+
+#include <Arduino.h>
+#include <unity.h>
+#include "Screen.h"
+#include "ScreenStats.h"
+#include "Scheduler.h"
+#include "Native.h"
+
+#define WEATHER                    0     // In screens[], as SCREEN_WEATHER - 1 in main.cpp
+#define CO2                        1
+#define RAIN                       2
+#define RECORDINGS                 2     // Per host in data/replay, played in turn
+
+void setup();
+void loop();
+void Get_Weather();
+void Get_Rain();
+void Get_CO2();
+
+extern Screen        screens[];
+extern String        WTH_etag, WTH_lastModified, RAIN_etag, RAIN_lastModified;
+extern int           MHZ_CO2, MHZ_Error;
+extern unsigned long WTH_count200, RAIN_count200, frame_over_budget_total;
+
+static const int co2_series[] = { 420, 812, 813, 1250, 1999, 2600, 4999, 5000, 380, 812 };
+
+static bool Draw(uint8_t id, bool full) {
+  Screen &screen = screens[id];
+  ScreenStats_Begin();
+  screen.draw(full);
+  bool ok = ScreenStats_End(screen, full);
+  TEST_ASSERT_GREATER_THAN_MESSAGE(0, ScreenStats_Get().pixels, screen.name); // It drew
+  return ok;
+}
+
+void setUp() {
+  native_server = Native_Server();
+  native_server.latency_ms = 0;
+}
+
+void tearDown() {
+}
+
+void test_weather() {
+  for (int i = 0; i < RECORDINGS; i++) {
+    unsigned long count200 = WTH_count200;
+    WTH_etag = WTH_lastModified = ""; // The whole feed every time
+    Get_Weather();
+    TEST_ASSERT_EQUAL(count200 + 1, WTH_count200);
+    TEST_ASSERT_TRUE(Draw(WEATHER, true));
+  }
+}
+
+void test_rain() {
+  for (int i = 0; i < RECORDINGS; i++) {
+    unsigned long count200 = RAIN_count200;
+    RAIN_etag = RAIN_lastModified = "";
+    Get_Rain();
+    TEST_ASSERT_EQUAL(count200 + 1, RAIN_count200);
+    TEST_ASSERT_TRUE(Draw(RAIN, true));
+  }
+}
+
+void test_co2() {
+/* *****************************************************************************
+   test_co2
+
+   The meter from scratch, then only what changed as the values come in,
+   from a change of one ppm to one across the whole scale
+ * *****************************************************************************/
+  for (size_t i = 0; i < sizeof(co2_series) / sizeof(co2_series[0]); i++) {
+    native_sensor.ppm = co2_series[i];
+    delay(50);     // The reply to the request before is in
+    Get_CO2();     // Picks it up, asks for this value
+    delay(50);
+    Get_CO2();
+    TEST_ASSERT_EQUAL(co2_series[i], MHZ_CO2);
+    TEST_ASSERT_TRUE(Draw(CO2, i == 0));
+  }
+}
+
+void test_render_loop() {
+  unsigned long over = frame_over_budget_total;
+  uint32_t start = millis();
+  while ((uint32_t)(millis() - start) < 40000) { // Every screen, from scratch and updated
+    native_sensor.ppm = 400 + (millis() / 1000) % 50 * 60;
+    loop();
+    delay(10);
+  }
+  TEST_ASSERT_EQUAL(over, frame_over_budget_total);
+}
+
+int main(int argc, char **argv) {
+  setup();
+  while (Task_Next(millis()) == 0) loop(); // The fetches of the start
+  UNITY_BEGIN();
+  RUN_TEST(test_weather);
+  RUN_TEST(test_rain);
+  RUN_TEST(test_co2);
+  RUN_TEST(test_render_loop);
+  return UNITY_END();
+}
@@ -0,0 +1,174 @@
+/* *****************************************************************************
+
+   Copyright (C) 2022 P.A.G.M. Zengers
+
+   The non blocking MH-Z19B driver against the emulated sensor of the native
+   env, and Get_CO2 every CO2_INTERVAL_SEC. See CO2Sensor.h and
+   lib/Native/SoftwareSerial.h
+
+   This program is free software: you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation, either version 3 of the License, or
+   (at your option) any later version.
+
+ * ****************************************************************************/
+
+#include <Arduino.h>
+#include <unity.h>
+#include <SoftwareSerial.h>
+#include <MHZ19.h>
+#include "CO2Sensor.h"
+#include "Scheduler.h"
+#include "Native.h"
+
+void setup();
+void loop();
+
+extern SoftwareSerial sensor;
+extern int            MHZ_CO2, MHZ_Temp, MHZ_Error;
+
+static int Read(uint32_t *took_ms = NULL) {
+  uint32_t start = millis();
+  CO2_Request();
+  int result;
+  while ((result = CO2_Poll()) == CO2_PENDING) delay(1);
+  if (took_ms) *took_ms = millis() - start;
+  return result;
+}
+
+void setUp() {
+/* *****************************************************************************
+   setUp
+
+   Start each test from a quiet sensor and a driver without a request, whatever
+   setup() or the test before left on the line
+ * *****************************************************************************/
+  delay(CO2_RESPONSE_TIMEOUT); // Any reply still on its way is in by now
+  while (sensor.available()) sensor.read();
+  native_sensor = Native_Sensor();
+  CO2_Begin(&sensor);
+}
+
+void tearDown() {
+}
+
+void test_read() {
+  native_sensor.ppm = 812;
+  native_sensor.temperature = 23;
+  uint32_t took;
+  TEST_ASSERT_EQUAL(MHZ19_RESULT_OK, Read(&took));
+  TEST_ASSERT_EQUAL(812, CO2_Value());
+  TEST_ASSERT_EQUAL(23, CO2_Temperature());
+  TEST_ASSERT_GREATER_OR_EQUAL(11, took); // 2 ms and 9 bytes at 9600 baud; not at once
+  TEST_ASSERT_EQUAL(0, native_sensor.bad_commands);
+}
+
+void test_returns_at_once() {
+  CO2_Request();
+  TEST_ASSERT_EQUAL(CO2_PENDING, CO2_Poll());
+  TEST_ASSERT_EQUAL(1, native_sensor.commands);
+  delay(20);
+  TEST_ASSERT_EQUAL(MHZ19_RESULT_OK, CO2_Poll());
+  TEST_ASSERT_EQUAL(CO2_IDLE, CO2_Poll());
+}
+
+void test_noise_before_reply() {
+  native_sensor.noise = 5;
+  native_sensor.ppm = 1500;
+  TEST_ASSERT_EQUAL(MHZ19_RESULT_OK, Read());
+  TEST_ASSERT_EQUAL(1500, CO2_Value());
+}
+
+void test_bad_checksum() {
+  native_sensor.bad_checksums = 1;
+  TEST_ASSERT_EQUAL(MHZ19_RESULT_ERR_CRC, Read());
+  TEST_ASSERT_EQUAL(MHZ19_RESULT_OK, Read());
+}
+
+void test_no_sensor() {
+  native_sensor.present = false;
+  uint32_t took;
+  TEST_ASSERT_EQUAL(MHZ19_RESULT_ERR_TIMEOUT, Read(&took));
+  TEST_ASSERT_GREATER_OR_EQUAL(CO2_RESPONSE_TIMEOUT, took);
+  TEST_ASSERT_EQUAL(1, native_sensor.commands);
+}
+
+void test_old_reply_thrown_away() {
+  native_sensor.ppm = 600;
+  CO2_Request();
+  delay(20); // Reply arrived, never picked up
+  CO2_Begin(&sensor);
+  native_sensor.ppm = 700;
+  TEST_ASSERT_EQUAL(MHZ19_RESULT_OK, Read());
+  TEST_ASSERT_EQUAL(700, CO2_Value());
+}
+
+void test_request_while_waiting() {
+  native_sensor.ppm = 600;
+  CO2_Request();
+  delay(5); // Part of the reply is in
+  native_sensor.ppm = 700;
+  CO2_Request();
+  TEST_ASSERT_EQUAL(1, native_sensor.commands); // Not sent, the reply is on its way
+  int result;
+  while ((result = CO2_Poll()) == CO2_PENDING) delay(1);
+  TEST_ASSERT_EQUAL(MHZ19_RESULT_OK, result);
+  TEST_ASSERT_EQUAL(600, CO2_Value());
+  TEST_ASSERT_EQUAL(MHZ19_RESULT_OK, Read());
+  TEST_ASSERT_EQUAL(700, CO2_Value());
+  TEST_ASSERT_EQUAL(2, native_sensor.commands);
+}
+
+void test_request_after_timeout() {
+  native_sensor.present = false;
+  CO2_Request();
+  delay(CO2_RESPONSE_TIMEOUT + 1);
+  native_sensor.present = true;
+  native_sensor.ppm = 800;
+  TEST_ASSERT_EQUAL(MHZ19_RESULT_OK, Read()); // The request before timed out, a new one is sent
+  TEST_ASSERT_EQUAL(800, CO2_Value());
+  TEST_ASSERT_EQUAL(2, native_sensor.commands);
+}
+
+void test_set_range() {
+  MHZ19 mhz(&sensor);
+  TEST_ASSERT_EQUAL(MHZ19_RESULT_OK, mhz.setRange(MHZ19_RANGE_3000));
+  native_sensor.present = false;
+  TEST_ASSERT_EQUAL(MHZ19_RESULT_ERR_TIMEOUT, mhz.setRange(MHZ19_RANGE_3000));
+}
+
+void test_interval() {
+/* *****************************************************************************
+   test_interval
+
+   Half a period past 30 s of loop() on the clock: Get_CO2 every 5 s, each
+   picking up the reply to the request of the one before
+ * *****************************************************************************/
+  native_sensor.ppm = 950;
+  while (Task_Next(millis()) == 0) loop(); // What got due during the tests before
+  native_sensor.commands = 0;
+  uint32_t start = millis();
+  while ((uint32_t)(millis() - start) < 32500) {
+    loop();
+    delay(10);
+  }
+  TEST_ASSERT_EQUAL(30 / 5, native_sensor.commands);
+  TEST_ASSERT_EQUAL(MHZ19_RESULT_OK, MHZ_Error);
+  TEST_ASSERT_EQUAL(950, MHZ_CO2);
+}
+
+int main(int argc, char **argv) {
+  setup();
+  UNITY_BEGIN();
+  RUN_TEST(test_read);
+  RUN_TEST(test_returns_at_once);
+  RUN_TEST(test_noise_before_reply);
+  RUN_TEST(test_bad_checksum);
+  RUN_TEST(test_no_sensor);
+  RUN_TEST(test_old_reply_thrown_away);
+  RUN_TEST(test_request_while_waiting);
+  RUN_TEST(test_request_after_timeout);
+  RUN_TEST(test_set_range);
+  RUN_TEST(test_interval);
+  return UNITY_END();
+}
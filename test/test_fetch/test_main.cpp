@@ -0,0 +1,284 @@
+/* *****************************************************************************
+
+   Copyright (C) 2022 P.A.G.M. Zengers
+
+   The fetches of main.cpp against the stand-in server of the native env:
+   MFLN and the fallback of Https_Connect, 304, chunked and cut off bodies,
+   resets and refused connections; what the recordings of data/replay parse
+   to, gzip or plain; and the time a fetch takes at a latency and bandwidth.
+   See lib/Native/WiFiClientSecure.h
+
+   This program is free software: you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation, either version 3 of the License, or
+   (at your option) any later version.
+
+ * ****************************************************************************/
+
+#include <Arduino.h>
+#include <unity.h>
+#include "Replay.h"
+#include "Weather.h"
+#include "Fetch.h"
+#include "Native.h"
+
+#define MFLN_UNKNOWN               -1    // As in main.cpp
+#define RAIN_RECORDINGS            2     // Of the rain host in data/replay, played in turn
+
+void setup();
+void Get_Weather();
+void Get_Rain();
+void Task_Weather();
+void Task_Rain();
+uint32_t mmHour(int radarvalue, int hundredths);
+
+extern Https_Client     httpsClient;
+extern int              json_mfln;
+extern const char      *json_host;
+extern String           WTH_etag, WTH_lastModified, RAIN_etag, RAIN_lastModified;
+extern unsigned long    WTH_count200, WTH_count304, WTH_countFail, RAIN_count200, RAIN_countFail;
+extern WeatherSnapshot *weather_now;
+extern RainSnapshot    *rain_now;
+
+// The wet forecast of data/replay/gpsgadget.buienradar.nl.*, from 20:10 every 5 minutes
+static const int rain_wet[RAIN_READINGS] = {   0,   0,  45,  77,  92, 110, 121,  97,  77,  60,  45,   0,
+                                               0,   0,  45,  77,  92, 110, 121,  97,  77,  60,  45,   0 };
+
+static unsigned long count200, count304, countFail;
+
+void setUp() {
+  native_server = Native_Server();
+  native_server.latency_ms = 0;
+  json_mfln = MFLN_UNKNOWN;
+  WTH_etag = WTH_lastModified = RAIN_etag = RAIN_lastModified = "";
+  count200  = WTH_count200;
+  count304  = WTH_count304;
+  countFail = WTH_countFail;
+}
+
+void tearDown() {
+}
+
+void test_mfln_small_buffers() {
+  Get_Weather();
+  TEST_ASSERT_EQUAL(1, native_server.probes);
+  TEST_ASSERT_EQUAL(1, native_server.connects);
+  TEST_ASSERT_TRUE(httpsClient.getMFLNStatus());
+  TEST_ASSERT_EQUAL(count200 + 1, WTH_count200);
+}
+
+void test_mfln_not_supported() {
+  native_server.mfln = false;
+  Get_Weather();
+  TEST_ASSERT_EQUAL(1, native_server.probes);
+  TEST_ASSERT_EQUAL(1, native_server.connects);
+  TEST_ASSERT_FALSE(httpsClient.getMFLNStatus());
+  TEST_ASSERT_EQUAL(count200 + 1, WTH_count200);
+}
+
+void test_mfln_dropped_falls_back() {
+  native_server.mfln_dropped = true; // Says yes to the probe, then sends full records
+  Get_Weather();
+  TEST_ASSERT_EQUAL(2, native_server.connects);
+  TEST_ASSERT_FALSE(httpsClient.getMFLNStatus());
+  TEST_ASSERT_EQUAL(0, httpsClient.getLastSSLError());
+  TEST_ASSERT_EQUAL(MFLN_UNKNOWN, json_mfln); // Probe again next time
+  TEST_ASSERT_EQUAL(count200 + 1, WTH_count200);
+
+  WTH_etag = "";
+  Get_Weather();
+  TEST_ASSERT_EQUAL(2, native_server.probes);
+}
+
+void test_mfln_error_without_fallback() {
+  native_server.mfln_dropped = true;
+  native_server.probes = 0;
+  WiFiClientSecure client;
+  client.setBufferSizes(512, 512);
+  TEST_ASSERT_FALSE(client.connect("data.buienradar.nl", 443));
+  TEST_ASSERT_EQUAL(NATIVE_BR_ERR_TOO_LARGE, client.getLastSSLError());
+}
+
+void test_not_modified() {
+  Get_Weather();
+  Get_Weather(); // With the ETag of the first
+  TEST_ASSERT_EQUAL(1, native_server.answered_304);
+  TEST_ASSERT_EQUAL(count200 + 1, WTH_count200);
+  TEST_ASSERT_EQUAL(count304 + 1, WTH_count304);
+}
+
+void test_chunked() {
+  native_server.chunked = true;
+  Get_Weather();
+  TEST_ASSERT_EQUAL(count200 + 1, WTH_count200);
+  unsigned long rain200 = RAIN_count200;
+  Get_Rain();
+  TEST_ASSERT_EQUAL(rain200 + 1, RAIN_count200);
+}
+
+void test_truncated() {
+  native_server.truncate = true;
+  Get_Weather();
+  TEST_ASSERT_EQUAL(count200, WTH_count200);
+  TEST_ASSERT_EQUAL(countFail + 1, WTH_countFail);
+  TEST_ASSERT_EQUAL(0, WTH_etag.length()); // Validators of a bad response are not kept
+}
+
+void test_reset() {
+/* *****************************************************************************
+   test_reset
+
+   A reset in the headers and one in the gzip body both fail the fetch,
+   keep nothing, and the next fetch gets through
+ * *****************************************************************************/
+  native_server.reset = 20; // In the Date header
+  Get_Weather();
+  TEST_ASSERT_EQUAL(1, native_server.resets);
+  TEST_ASSERT_EQUAL(countFail + 1, WTH_countFail);
+  TEST_ASSERT_EQUAL(0, WTH_etag.length());
+
+  native_server.reset = 1000; // Halfway the 2987 bytes of gzip
+  Get_Weather();
+  TEST_ASSERT_EQUAL(2, native_server.resets);
+  TEST_ASSERT_EQUAL(countFail + 2, WTH_countFail);
+  TEST_ASSERT_EQUAL(count200, WTH_count200);
+
+  native_server.reset = 0;
+  Get_Weather();
+  TEST_ASSERT_EQUAL(count200 + 1, WTH_count200);
+}
+
+void test_weather_parsed() {
+/* *****************************************************************************
+   test_weather_parsed
+
+   The first record of station 6260 in the recording, De Bilt at 12:50
+ * *****************************************************************************/
+  native_server.gzip = false;
+  Task_Weather();
+  TEST_ASSERT_EQUAL(count200 + 1, WTH_count200);
+  const WeatherSnapshot &weather = *weather_now;
+  TEST_ASSERT_TRUE(weather.valid);
+  TEST_ASSERT_FALSE(weather.stale);
+  TEST_ASSERT_EQUAL(12 * 60 + 50, weather.timestamp);
+  TEST_ASSERT_EQUAL(8 * 60 + 38, weather.sunrise);
+  TEST_ASSERT_EQUAL(17 * 60 + 4, weather.sunset);
+  TEST_ASSERT_EQUAL(71, weather.temperature);
+  TEST_ASSERT_EQUAL(10116, weather.airpressure);
+  TEST_ASSERT_EQUAL(8, weather.windspeed);
+  TEST_ASSERT_EQUAL(132, weather.sunpower);
+  TEST_ASSERT_EQUAL(30, weather.rainFallLast24Hour);
+  TEST_ASSERT_EQUAL(2, weather.rainFallLastHour);
+  TEST_ASSERT_EQUAL(82, weather.humidity);
+  TEST_ASSERT_EQUAL(0, weather.precipitation);
+  TEST_ASSERT_EQUAL(ICON_ZWAARBEWOLKT, weather.icon);
+  TEST_ASSERT_EQUAL_STRING("WZW", weather.winddirection);
+  TEST_ASSERT_EQUAL_STRING("Zwaar bewolkt", weather.description);
+}
+
+void test_gzip_and_plain() {
+/* *****************************************************************************
+   test_gzip_and_plain
+
+   The same feed plain and gzip parses to the same snapshot, with a tenth
+   of the bytes on the wire
+ * *****************************************************************************/
+  native_server.gzip = false;
+  Task_Weather();
+  uint32_t        plain_sent = native_server.sent;
+  WeatherSnapshot plain      = *weather_now;
+  TEST_ASSERT_EQUAL(28355, Fetch_Last(json_host)->bytes);
+
+  native_server.gzip = true;
+  WTH_etag = WTH_lastModified = "";
+  Task_Weather();
+  uint32_t gzip_sent = native_server.sent - plain_sent;
+  TEST_ASSERT_EQUAL(count200 + 2, WTH_count200);
+  TEST_ASSERT_EQUAL(2987, Fetch_Last(json_host)->bytes);
+  TEST_ASSERT_LESS_THAN(plain_sent / 8, gzip_sent);
+  TEST_ASSERT_EQUAL(0, memcmp(&plain, weather_now, sizeof(WeatherSnapshot)));
+}
+
+void test_rain_parsed() {
+/* *****************************************************************************
+   test_rain_parsed
+
+   Both recordings of the rain host: one dry, one with two showers
+ * *****************************************************************************/
+  int wet = 0, dry = 0;
+  for (int i = 0; i < RAIN_RECORDINGS; i++) {
+    RAIN_etag = RAIN_lastModified = "";
+    Task_Rain();
+    const RainSnapshot &rain = *rain_now;
+    bool                showers = rain.max > mmHour(0, 0); // The lowest in the table is not 0
+    TEST_ASSERT_TRUE(rain.valid);
+    TEST_ASSERT_EQUAL(RAIN_READINGS, rain.readings);
+    uint32_t highest = 0;
+    for (uint8_t r = 0; r < RAIN_READINGS; r++) {
+      TEST_ASSERT_EQUAL(20 * 60 + 10 + 5 * r, rain.time[r]);
+      TEST_ASSERT_EQUAL(mmHour(showers ? rain_wet[r] : 0, 0), rain.rain[r]);
+      highest = max(highest, rain.rain[r]);
+    }
+    TEST_ASSERT_EQUAL(highest, rain.max);
+    if (showers) wet++;
+    else         dry++;
+  }
+  TEST_ASSERT_EQUAL(1, wet);
+  TEST_ASSERT_EQUAL(1, dry);
+  TEST_ASSERT_UINT32_WITHIN(10, 100, mmHour(77, 0)); // 0.1 mm/hour, see mmHour
+  TEST_ASSERT_EQUAL(mmHour(121, 0), mmHour(rain_wet[6], 0));
+}
+
+void test_latency_bandwidth() {
+/* *****************************************************************************
+   test_latency_bandwidth
+
+   The first byte comes after the latency, the body at the bandwidth: the
+   fetch record has both, and the throughput it shows is that of the server
+ * *****************************************************************************/
+  native_server.gzip       = false;
+  native_server.latency_ms = 300;
+  native_server.bandwidth  = 50000;
+  Task_Weather();
+  const Fetch_Record *record = Fetch_Last(json_host);
+  TEST_ASSERT_NOT_NULL(record);
+  TEST_ASSERT_TRUE(record->ok);
+  TEST_ASSERT_UINT32_WITHIN(30, 300, record->phase[FETCH_TTFB]);
+  uint32_t expected = native_server.sent * 1000 / native_server.bandwidth;
+  TEST_ASSERT_UINT32_WITHIN(expected / 10 + 20, expected, record->phase[FETCH_BODY]);
+  uint32_t throughput = record->bytes * 1000 / max(record->phase[FETCH_BODY], 1UL);
+  TEST_ASSERT_UINT32_WITHIN(native_server.bandwidth / 10, native_server.bandwidth, throughput);
+
+  char message[128];
+  snprintf(message, sizeof(message), "%lu bytes; ttfb %lu ms, body %lu ms, total %lu ms, %lu bytes/s",
+           record->bytes, record->phase[FETCH_TTFB], record->phase[FETCH_BODY], record->total,
+           (unsigned long)throughput);
+  TEST_MESSAGE(message);
+}
+
+void test_refused() {
+  native_server.refuse = 2;
+  Get_Weather();
+  TEST_ASSERT_EQUAL(3, native_server.connects);
+  TEST_ASSERT_EQUAL(2, native_server.refused);
+  TEST_ASSERT_EQUAL(count200 + 1, WTH_count200);
+}
+
+int main(int argc, char **argv) {
+  setup();
+  UNITY_BEGIN();
+  RUN_TEST(test_mfln_small_buffers);
+  RUN_TEST(test_mfln_not_supported);
+  RUN_TEST(test_mfln_dropped_falls_back);
+  RUN_TEST(test_mfln_error_without_fallback);
+  RUN_TEST(test_not_modified);
+  RUN_TEST(test_chunked);
+  RUN_TEST(test_truncated);
+  RUN_TEST(test_reset);
+  RUN_TEST(test_refused);
+  RUN_TEST(test_weather_parsed);
+  RUN_TEST(test_gzip_and_plain);
+  RUN_TEST(test_rain_parsed);
+  RUN_TEST(test_latency_bandwidth);
+  return UNITY_END();
+}
@@ -0,0 +1,168 @@
+/* *****************************************************************************
+
+   Copyright (C) 2022 P.A.G.M. Zengers
+
+   The golden image checks of the screens on the native env: every case of
+   main.cpp drawn on the emulated panel and compared with its PPM image in
+   this directory, within a tolerance. A case that differs leaves what it
+   drew in <name>.actual.ppm and the pixels that differ in <name>.diff.ppm.
+   Run with GOLDEN_UPDATE=1 in the environment to write the images afresh,
+   and check them by eye before checking them in. See Golden.h
+
+   This program is free software: you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation, either version 3 of the License, or
+   (at your option) any later version.
+
+ * ****************************************************************************/
+
+#include <Arduino.h>
+#include <unity.h>
+#include <stdlib.h>
+#include "Golden.h"
+#include "Native.h"
+
+#define GOLDEN_DIR                 "test/test_golden/" // From the project directory, where pio test runs
+#define GOLDEN_CHANNEL_TOLERANCE   16    // Of 255, per red, green and blue
+#define GOLDEN_PIXEL_TOLERANCE     60    // Pixels beyond it, about 0.1% of the panel
+#define GOLDEN_PIXELS              (NATIVE_PANEL_WIDTH * NATIVE_PANEL_HEIGHT)
+
+void setup();
+
+static uint8_t golden_image[GOLDEN_PIXELS][3];
+
+static void Golden_Path(const char *name, const char *suffix, char *path, size_t size) {
+  int length = snprintf(path, size, "%s", GOLDEN_DIR);
+  for (const char *c = name; *c && length < (int)size - 1; c++) {
+    path[length++] = *c == ' ' ? '_' : tolower(*c);
+  }
+  snprintf(path + length, size - length, "%s", suffix);
+}
+
+static void Golden_RGB(uint16_t pixel, uint8_t *rgb) {
+  uint8_t red = pixel >> 11, green = (pixel >> 5) & 0x3F, blue = pixel & 0x1F;
+  rgb[0] = red << 3 | red >> 2; // As Native_Panel_Save
+  rgb[1] = green << 2 | green >> 4;
+  rgb[2] = blue << 3 | blue >> 2;
+}
+
+static bool Golden_Load(const char *path) {
+  FILE *file = fopen(path, "rb");
+  if (!file) return false;
+  int  width, height, depth;
+  bool ok = fscanf(file, "P6 %d %d %d", &width, &height, &depth) == 3 && fgetc(file) != EOF &&
+            width == NATIVE_PANEL_WIDTH && height == NATIVE_PANEL_HEIGHT && depth == 255 &&
+            fread(golden_image, sizeof(golden_image), 1, file) == 1;
+  fclose(file);
+  return ok;
+}
+
+static uint32_t Golden_Compare(const char *name) {
+/* *****************************************************************************
+   Golden_Compare
+
+   Compare the panel with the image of the case and return the pixels that
+   differ beyond GOLDEN_CHANNEL_TOLERANCE. When there are more than
+   GOLDEN_PIXEL_TOLERANCE, save the panel and an image of the differences:
+   the expected image dimmed, the pixels that differ in red
+ * *****************************************************************************/
+  char path[128];
+  Golden_Path(name, ".ppm", path, sizeof(path));
+  if (getenv("GOLDEN_UPDATE")) {
+    TEST_ASSERT_TRUE_MESSAGE(Native_Panel_Save(path), path);
+    return 0;
+  }
+  if (!Golden_Load(path)) {
+    Golden_Path(name, ".actual.ppm", path, sizeof(path));
+    Native_Panel_Save(path);
+    return GOLDEN_PIXELS;
+  }
+
+  static uint8_t diff[GOLDEN_PIXELS][3];
+  uint32_t       differ = 0;
+  for (uint32_t i = 0; i < GOLDEN_PIXELS; i++) {
+    uint8_t rgb[3];
+    Golden_RGB(Native_Panel_Pixel(i % NATIVE_PANEL_WIDTH, i / NATIVE_PANEL_WIDTH), rgb);
+    bool    same = true;
+    for (uint8_t c = 0; c < 3; c++) {
+      if (abs(rgb[c] - golden_image[i][c]) > GOLDEN_CHANNEL_TOLERANCE) same = false;
+    }
+    uint8_t grey = (golden_image[i][0] + golden_image[i][1] + golden_image[i][2]) / 12;
+    diff[i][0] = same ? grey : 255;
+    diff[i][1] = diff[i][2] = same ? grey : 0;
+    if (!same) differ++;
+  }
+  if (differ > GOLDEN_PIXEL_TOLERANCE) {
+    Golden_Path(name, ".actual.ppm", path, sizeof(path));
+    Native_Panel_Save(path);
+    Golden_Path(name, ".diff.ppm", path, sizeof(path));
+    FILE *file = fopen(path, "wb");
+    if (file) {
+      fprintf(file, "P6\n%d %d\n255\n", NATIVE_PANEL_WIDTH, NATIVE_PANEL_HEIGHT);
+      fwrite(diff, sizeof(diff), 1, file);
+      fclose(file);
+    }
+  }
+  return differ;
+}
+
+static int Golden_Pixels() {
+  int failed = 0;
+  for (uint8_t i = 0; i < golden_case_count; i++) {
+    golden_cases[i].draw(golden_cases[i].arg);
+    uint32_t differ = Golden_Compare(golden_cases[i].name);
+    if (differ > GOLDEN_PIXEL_TOLERANCE) {
+      char message[80];
+      snprintf(message, sizeof(message), "%s; %lu pixels differ", golden_cases[i].name, (unsigned long)differ);
+      TEST_MESSAGE(message);
+      failed++;
+    }
+  }
+  return failed;
+}
+
+void setUp() {
+}
+
+void tearDown() {
+}
+
+void test_screens() {
+  TEST_ASSERT_EQUAL(0, Golden_Pixels());
+}
+
+void test_screens_again() {
+  TEST_ASSERT_EQUAL(0, Golden_Pixels()); // Nothing left behind by the first run changes a screen
+}
+
+void test_tolerance() {
+/* *****************************************************************************
+   test_tolerance
+
+   A pixel a little off passes, a block of other pixels fails; the diff
+   image stays behind for the case that failed
+ * *****************************************************************************/
+  golden_cases[0].draw(golden_cases[0].arg);
+  Native_Panel_Window(0, 0, 0, 0);
+  Native_Panel_Pixels(Native_Panel_Pixel(0, 0) ^ 0x0001, 1); // Blue off by one step of 8
+  TEST_ASSERT_EQUAL(0, Golden_Compare(golden_cases[0].name));
+  if (getenv("GOLDEN_UPDATE")) return;
+
+  Native_Panel_Window(0, 0, 9, 9);
+  for (uint8_t i = 0; i < 100; i++) Native_Panel_Pixels(Native_Panel_Pixel(i % 10, i / 10) ^ 0xFFFF, 1);
+  TEST_ASSERT_EQUAL(100, Golden_Compare(golden_cases[0].name));
+  char path[128];
+  Golden_Path(golden_cases[0].name, ".diff.ppm", path, sizeof(path));
+  TEST_ASSERT_EQUAL(0, remove(path));
+  Golden_Path(golden_cases[0].name, ".actual.ppm", path, sizeof(path));
+  TEST_ASSERT_EQUAL(0, remove(path));
+}
+
+int main(int argc, char **argv) {
+  setup(); // Runs the hash checks of Golden.h as well, the device side
+  UNITY_BEGIN();
+  RUN_TEST(test_screens);
+  RUN_TEST(test_screens_again);
+  RUN_TEST(test_tolerance);
+  return UNITY_END();
+}
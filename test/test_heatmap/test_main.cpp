@@ -0,0 +1,146 @@
+/* *****************************************************************************
+
+   Copyright (C) 2022 P.A.G.M. Zengers
+
+   The overdraw of every screen on the native env, counted per pixel by the
+   emulated panel: each screen drawn from scratch with the replayed data,
+   its heatmap saved as heatmap/<screen>.ppm in LittleFS (data/ or
+   NATIVE_FS), with the summary of every screen in heatmap/summary.txt and
+   the heatmap of 8x8 tiles of the firmware next to it. See ScreenStats.h,
+   Native.h and the native_heatmap env
+
+   This program is free software: you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation, either version 3 of the License, or
+   (at your option) any later version.
+
+ * ****************************************************************************/
+
+#include <Arduino.h>
+#include <unity.h>
+#include <LittleFS.h>
+#include <ESP8266WebServer.h>
+#include "Screen.h"
+#include "ScreenStats.h"
+#include "Scheduler.h"
+#include "Native.h"
+
+#define HEATMAP_DIR                "/heatmap"
+#define HEATMAP_HOT                4     // Pixels written this often or more are hot
+#define SCREENS                    3     // In screens[], Weather, CO2 and Rain
+
+void setup();
+void loop();
+
+extern Screen           screens[];
+extern ESP8266WebServer server;
+
+struct Panel_Heatmap {
+  uint32_t writes;                       // Pixels written, overdraw included
+  uint32_t unique;                       // Different pixels written
+  uint32_t hot;                          // Pixels written HEATMAP_HOT times or more
+  uint16_t most;                         // Writes of the pixel written most
+  int32_t  most_x, most_y;
+};
+
+static FILE *summary;
+
+static Panel_Heatmap Heatmap_Count() {
+  Panel_Heatmap heatmap = {};
+  for (int32_t y = 0; y < NATIVE_PANEL_HEIGHT; y++) {
+    for (int32_t x = 0; x < NATIVE_PANEL_WIDTH; x++) {
+      uint16_t writes = Native_Panel_Writes(x, y);
+      if (writes == 0) continue;
+      heatmap.writes += writes;
+      heatmap.unique++;
+      if (writes >= HEATMAP_HOT) heatmap.hot++;
+      if (writes > heatmap.most) {
+        heatmap.most   = writes;
+        heatmap.most_x = x;
+        heatmap.most_y = y;
+      }
+    }
+  }
+  return heatmap;
+}
+
+static void Heatmap_Screen(uint8_t id) {
+/* *****************************************************************************
+   Heatmap_Screen
+
+   Draw the screen from scratch, save its heatmap and summary, and check the
+   overdraw the panel saw against the budget of the screen
+ * *****************************************************************************/
+  Screen &screen = screens[id];
+  Native_Panel_Writes_Clear();
+  ScreenStats_Begin();
+  screen.draw(true);
+  ScreenStats_End(screen, true);
+  Panel_Heatmap heatmap = Heatmap_Count();
+  TEST_ASSERT_GREATER_THAN_MESSAGE(0, heatmap.unique, screen.name);
+
+  char name[64], path[256];
+  snprintf(name, sizeof(name), HEATMAP_DIR "/%s.ppm", screen.name);
+  TEST_ASSERT_TRUE_MESSAGE(Native_Panel_Save_Heatmap(Native_Path(name, path, sizeof(path))), path);
+
+  uint32_t overdraw = heatmap.writes * 100 / heatmap.unique;
+  char     line[160];
+  snprintf(line, sizeof(line), "%s: %lu pixels written, %lu unique, overdraw %lu%%, %lu hot, most %u times at %ld,%ld",
+           screen.name, (unsigned long)heatmap.writes, (unsigned long)heatmap.unique, (unsigned long)overdraw,
+           (unsigned long)heatmap.hot, heatmap.most, (long)heatmap.most_x, (long)heatmap.most_y);
+  fprintf(summary, "%s\n", line);
+  TEST_MESSAGE(line);
+  TEST_ASSERT_LESS_OR_EQUAL_MESSAGE(screen.budget_overdraw, overdraw, line);
+
+  int    code;
+  String svg = server.Native_Get((String("/heatmap.svg?screen=") + screen.name).c_str(), &code);
+  TEST_ASSERT_EQUAL(200, code);
+  TEST_ASSERT_TRUE(svg.indexOf("<rect x=") > 0); // The tiles of this screen
+  snprintf(name, sizeof(name), HEATMAP_DIR "/%s.svg", screen.name);
+  File file = LittleFS.open(name, "w");
+  file.write((const uint8_t *)svg.c_str(), svg.length());
+  file.close();
+}
+
+void setUp() {
+}
+
+void tearDown() {
+}
+
+void test_screens() {
+  LittleFS.mkdir(HEATMAP_DIR);
+  char path[256];
+  summary = fopen(Native_Path(HEATMAP_DIR "/summary.txt", path, sizeof(path)), "w");
+  TEST_ASSERT_NOT_NULL(summary);
+  for (uint8_t id = 0; id < SCREENS; id++) Heatmap_Screen(id);
+  fprintf(summary, "\n%s", server.Native_Get("/heatmap").c_str()); // The tiles of the firmware
+  fclose(summary);
+}
+
+void test_counts() {
+/* *****************************************************************************
+   test_counts
+
+   A pixel written three times counts three, the clear starts again
+ * *****************************************************************************/
+  Native_Panel_Writes_Clear();
+  for (int i = 0; i < 3; i++) {
+    Native_Panel_Window(10, 20, 11, 20);
+    Native_Panel_Pixels(0xF800, 2);
+  }
+  TEST_ASSERT_EQUAL(3, Native_Panel_Writes(10, 20));
+  TEST_ASSERT_EQUAL(3, Native_Panel_Writes(11, 20));
+  TEST_ASSERT_EQUAL(0, Native_Panel_Writes(12, 20));
+  Native_Panel_Writes_Clear();
+  TEST_ASSERT_EQUAL(0, Native_Panel_Writes(10, 20));
+}
+
+int main(int argc, char **argv) {
+  setup();
+  while (Task_Next(millis()) == 0) loop(); // The fetches of the start
+  UNITY_BEGIN();
+  RUN_TEST(test_screens);
+  RUN_TEST(test_counts);
+  return UNITY_END();
+}
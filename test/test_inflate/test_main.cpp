@@ -0,0 +1,228 @@
+/* *****************************************************************************
+
+   Copyright (C) 2022 P.A.G.M. Zengers
+
+   Plain against gzip for the weather feed, on the recordings in data/replay:
+   the bytes on the wire, the time to inflate on the host, and the fetch of
+   main.cpp either way through the stand-in server. See Inflate.h
+
+   This program is free software: you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation, either version 3 of the License, or
+   (at your option) any later version.
+
+ * ****************************************************************************/
+
+#include <Arduino.h>
+#include <unity.h>
+#include <string>
+#include "Inflate.h"
+#include "Native.h"
+
+#define BENCH_RUNS                 50
+#define BENCH_BANDWIDTH            20000 // Bytes per second, a weak link; as REPLAY_BANDWIDTH
+#define INFLATE_HEAP_RESERVE       8192  // As in main.cpp
+
+void setup();
+void Get_Weather();
+
+extern String        WTH_etag, WTH_lastModified;
+extern unsigned long WTH_count200;
+extern bool          json_small_window;
+
+// 24 bytes, 9000 bytes of a pattern without them, and the 24 bytes again.
+// Compressed with the full window, with a back reference of 9024 beyond the
+// small window, and with the small window, without one
+static const uint8_t far[] = {
+  0x1f, 0x8b, 0x08, 0x00, 0x00, 0x00, 0x00, 0x00, 0x02, 0x03, 0xed, 0xda, 0x3b, 0x11, 0x40, 0x00,
+  0x00, 0x00, 0x50, 0xbf, 0x06, 0x16, 0x06, 0x0c, 0xce, 0xe6, 0x9c, 0x06, 0x12, 0x88, 0x62, 0x60,
+  0x95, 0x47, 0x0a, 0x0d, 0xd8, 0xdd, 0x59, 0x64, 0x91, 0x40, 0x01, 0xf7, 0x96, 0x97, 0xe2, 0x6d,
+  0xe3, 0x91, 0x35, 0xfd, 0x5e, 0x4c, 0x69, 0xfb, 0x5c, 0xf5, 0xda, 0xdd, 0xe5, 0xb0, 0x54, 0x67,
+  0x3e, 0x07, 0x51, 0x12, 0xc6, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+  0x00, 0xc0, 0xcf, 0xd9, 0x3e, 0xfe, 0xcc, 0x0b, 0x8e, 0x44, 0xfc, 0xf7, 0x58, 0x23, 0x00, 0x00 };
+static const uint8_t near[] = {
+  0x1f, 0x8b, 0x08, 0x00, 0x00, 0x00, 0x00, 0x00, 0x02, 0x03, 0xed, 0xc4, 0xbb, 0x0d, 0x40, 0x50,
+  0x00, 0x00, 0x40, 0xbf, 0x0d, 0x34, 0x14, 0x28, 0x44, 0x27, 0xf2, 0x36, 0x30, 0x81, 0x51, 0x14,
+  0xb4, 0xe6, 0x31, 0x85, 0x0d, 0xe8, 0x25, 0x1a, 0xb3, 0xd8, 0x43, 0xee, 0x8a, 0xdb, 0xa7, 0xb3,
+  0xe8, 0xc2, 0x51, 0xcd, 0x79, 0xff, 0xde, 0xed, 0x36, 0x3c, 0xf5, 0xb8, 0x36, 0x57, 0xb9, 0x44,
+  0x49, 0x16, 0xa7, 0x92, 0x24, 0x49, 0x92, 0x24, 0x49, 0x92, 0x24, 0x49, 0x92, 0x24, 0x49, 0xd2,
+  0xcf, 0xdb, 0xa7, 0xb3, 0xe8, 0xc2, 0x51, 0xcd, 0x79, 0xff, 0xde, 0xed, 0x36, 0x3c, 0xf5, 0xb8,
+  0x36, 0x57, 0xb9, 0x7c, 0x8e, 0x44, 0xfc, 0xf7, 0x58, 0x23, 0x00, 0x00 };
+
+static std::string plain, packed;        // Bodies of the recordings
+static size_t      plain_wire, packed_wire; // Whole responses
+static const char *input;
+static size_t      input_left, output_count;
+static std::string output;
+
+static size_t Body(const char *name, std::string &body) {
+  char path[256];
+  FILE *file = fopen(Native_Path(name, path, sizeof(path)), "rb");
+  if (!file) return 0;
+  std::string recording;
+  char buffer[4096];
+  size_t length;
+  while ((length = fread(buffer, 1, sizeof(buffer), file)) > 0) recording.append(buffer, length);
+  fclose(file);
+  size_t start = recording.find("\r\n\r\n");
+  body = recording.substr(start + 4);
+  return recording.size() - 20; // Without the Replay_Header
+}
+
+static int  Input()        { if (input_left == 0) return -1; input_left--; return (uint8_t)*input++; }
+static void Keep(char c)   { output += c; }
+static void Count(char c)  { output_count++; }
+
+void setUp() {
+  WTH_etag = WTH_lastModified = "";
+  native_server = Native_Server();
+}
+
+void tearDown() {
+}
+
+void test_recordings() {
+  plain_wire  = Body("/replay/data.buienradar.nl.0", plain);
+  packed_wire = Body("/replay/data.buienradar.nl.1", packed);
+  TEST_ASSERT_GREATER_THAN(0, plain.size());
+  TEST_ASSERT_GREATER_THAN(0, packed.size());
+}
+
+void test_inflate_matches_plain() {
+  output.clear();
+  input = packed.data();
+  input_left = packed.size();
+  TEST_ASSERT_EQUAL(INFLATE_OK, Gzip_Inflate(Input, Keep));
+  TEST_ASSERT_TRUE(output == plain);
+}
+
+void test_inflate_cut_off() {
+  input = packed.data();
+  input_left = packed.size() / 2;
+  TEST_ASSERT_EQUAL(INFLATE_ERR_INPUT, Gzip_Inflate(Input, Count));
+}
+
+static int Inflate(const uint8_t *data, size_t size, uint32_t window) {
+  input = (const char *)data;
+  input_left = size;
+  output_count = 0;
+  return Gzip_Inflate(Input, Count, window);
+}
+
+void test_small_window() {
+  TEST_ASSERT_EQUAL(INFLATE_OK, Inflate(near, sizeof(near), INFLATE_SMALL_WINDOW));
+  TEST_ASSERT_EQUAL(24 + 9000 + 24, output_count);
+  TEST_ASSERT_EQUAL(INFLATE_ERR_WINDOW, Inflate(far, sizeof(far), INFLATE_SMALL_WINDOW));
+  TEST_ASSERT_EQUAL(INFLATE_OK, Inflate(far, sizeof(far), INFLATE_WINDOW_SIZE));
+  TEST_ASSERT_EQUAL(24 + 9000 + 24, output_count);
+
+  // The recorded feed reaches back further than the small window as well
+  TEST_ASSERT_EQUAL(INFLATE_ERR_WINDOW, Inflate((const uint8_t *)packed.data(), packed.size(), INFLATE_SMALL_WINDOW));
+}
+
+void test_bench() {
+/* *****************************************************************************
+   test_bench
+
+   Time to hand out the plain body against the time to inflate the gzip one,
+   best of BENCH_RUNS on the host, and the wire time at BENCH_BANDWIDTH
+ * *****************************************************************************/
+  uint32_t plain_us = UINT32_MAX, packed_us = UINT32_MAX;
+  for (int run = 0; run < BENCH_RUNS; run++) {
+    output_count = 0;
+    input = plain.data();
+    input_left = plain.size();
+    uint32_t start = micros();
+    int c;
+    while ((c = Input()) >= 0) Count(c);
+    plain_us = min(plain_us, (uint32_t)(micros() - start));
+
+    output_count = 0;
+    input = packed.data();
+    input_left = packed.size();
+    start = micros();
+    TEST_ASSERT_EQUAL(INFLATE_OK, Gzip_Inflate(Input, Count));
+    packed_us = min(packed_us, (uint32_t)(micros() - start));
+    TEST_ASSERT_EQUAL(plain.size(), output_count);
+  }
+
+  char line[160];
+  snprintf(line, sizeof(line), "plain: %zu bytes on the wire, %lu ms at %d B/s, %lu us to read on the host",
+           plain_wire, (unsigned long)(plain_wire * 1000 / BENCH_BANDWIDTH), BENCH_BANDWIDTH, (unsigned long)plain_us);
+  TEST_MESSAGE(line);
+  snprintf(line, sizeof(line), "gzip:  %zu bytes on the wire, %lu ms at %d B/s, %lu us to inflate on the host",
+           packed_wire, (unsigned long)(packed_wire * 1000 / BENCH_BANDWIDTH), BENCH_BANDWIDTH, (unsigned long)packed_us);
+  TEST_MESSAGE(line);
+  TEST_ASSERT_LESS_THAN(plain_wire, packed_wire);
+}
+
+void test_fetch_plain_and_gzip() {
+/* *****************************************************************************
+   test_fetch_plain_and_gzip
+
+   Get_Weather either way, at BENCH_BANDWIDTH. Too little heap for either
+   window makes it ask for the plain feed
+ * *****************************************************************************/
+  uint32_t heap = ESP.heap_max_block, sent[2], took[2];
+  native_server.bandwidth = BENCH_BANDWIDTH;
+  for (int gzip = 0; gzip < 2; gzip++) {
+    ESP.heap_max_block = gzip ? heap : INFLATE_SMALL_WINDOW;
+    WTH_etag = "";
+    unsigned long count = WTH_count200;
+    uint32_t before = native_server.sent, start = millis();
+    Get_Weather();
+    took[gzip] = millis() - start;
+    sent[gzip] = native_server.sent - before;
+    TEST_ASSERT_EQUAL(count + 1, WTH_count200);
+  }
+  ESP.heap_max_block = heap;
+
+  char line[160];
+  snprintf(line, sizeof(line), "Get_Weather at %d B/s: plain %lu bytes in %lu ms, gzip %lu bytes in %lu ms",
+           BENCH_BANDWIDTH, (unsigned long)sent[0], (unsigned long)took[0], (unsigned long)sent[1], (unsigned long)took[1]);
+  TEST_MESSAGE(line);
+  TEST_ASSERT_EQUAL(plain_wire, sent[0]);
+  TEST_ASSERT_EQUAL(packed_wire, sent[1]);
+  TEST_ASSERT_LESS_THAN(took[0], took[1]);
+}
+
+void test_fetch_small_window() {
+/* *****************************************************************************
+   test_fetch_small_window
+
+   With room for the small window only, as on the device next to TLS,
+   Get_Weather asks for gzip. The recorded feed reaches back too far, so it
+   fetches the plain feed straight after, and from then on at once
+ * *****************************************************************************/
+  uint32_t heap = ESP.heap_max_block;
+  ESP.heap_max_block = INFLATE_SMALL_WINDOW + INFLATE_HEAP_RESERVE + 1;
+  unsigned long count = WTH_count200;
+  uint32_t requests = native_server.requests, before = native_server.sent;
+  Get_Weather();
+  TEST_ASSERT_EQUAL(count + 1, WTH_count200);
+  TEST_ASSERT_EQUAL(requests + 2, native_server.requests);
+  TEST_ASSERT_GREATER_THAN(plain_wire, native_server.sent - before); // Part of the gzip feed as well
+  TEST_ASSERT_FALSE(json_small_window);
+
+  WTH_etag = "";
+  before = native_server.sent;
+  Get_Weather();
+  TEST_ASSERT_EQUAL(count + 2, WTH_count200);
+  TEST_ASSERT_EQUAL(requests + 3, native_server.requests);
+  TEST_ASSERT_EQUAL(plain_wire, native_server.sent - before);
+  ESP.heap_max_block = heap;
+  json_small_window = true;
+}
+
+int main(int argc, char **argv) {
+  setup();
+  UNITY_BEGIN();
+  RUN_TEST(test_recordings);
+  RUN_TEST(test_inflate_matches_plain);
+  RUN_TEST(test_inflate_cut_off);
+  RUN_TEST(test_small_window);
+  RUN_TEST(test_bench);
+  RUN_TEST(test_fetch_plain_and_gzip);
+  RUN_TEST(test_fetch_small_window);
+  return UNITY_END();
+}
@@ -0,0 +1,212 @@
+/* *****************************************************************************
+
+   Copyright (C) 2022 P.A.G.M. Zengers
+
+   GET /metrics and GET /fetches of the firmware in the native env, scraped
+   with Native_Get after the first fetches, and lines of Metrics_Line that do
+   not fit the chunk. See Metrics.h and lib/Native/ESP8266WebServer.h
+
+   This program is free software: you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation, either version 3 of the License, or
+   (at your option) any later version.
+
+ * ****************************************************************************/
+
+#include <Arduino.h>
+#include <unity.h>
+#include <string>
+#include <vector>
+#include "Metrics.h"
+#include "Scheduler.h"
+#include "Native.h"
+
+void setup();
+void loop();
+
+extern ESP8266WebServer server;
+extern const char      *json_host, *rain_host;
+
+static std::vector<std::string> Lines(const String &body) {
+  std::vector<std::string> lines;
+  std::string text = body.c_str();
+  for (size_t start = 0; start < text.size();) {
+    size_t end = text.find('\n', start);
+    if (end == std::string::npos) end = text.size();
+    lines.push_back(text.substr(start, end - start));
+    start = end + 1;
+  }
+  return lines;
+}
+
+static bool Value(const std::vector<std::string> &lines, const std::string &series, double *value) {
+/* *****************************************************************************
+   Value
+
+   Find the line of series (name with its labels) and read the value after it
+ * *****************************************************************************/
+  for (const std::string &line : lines) {
+    if (line.compare(0, series.size(), series) == 0 && line.size() > series.size() && line[series.size()] == ' ') {
+      char *end;
+      *value = strtod(line.c_str() + series.size() + 1, &end);
+      return *end == 0;
+    }
+  }
+  return false;
+}
+
+void setUp() {
+}
+
+void tearDown() {
+}
+
+void test_metrics_format() {
+/* *****************************************************************************
+   test_metrics_format
+
+   Every metric has its HELP line, then its TYPE line, then its values, each
+   a name that was declared, labels in braces and a number
+ * *****************************************************************************/
+  int code;
+  String body = server.Native_Get("/metrics", &code);
+  TEST_ASSERT_EQUAL(200, code);
+  TEST_ASSERT_EQUAL('\n', body[body.length() - 1]);
+
+  std::vector<std::string> lines = Lines(body);
+  std::string declared, help;
+  int metrics = 0, values = 0;
+  for (const std::string &line : lines) {
+    char name[80], kind[16];
+    if (line.compare(0, 7, "# HELP ") == 0) {
+      TEST_ASSERT_EQUAL_MESSAGE(1, sscanf(line.c_str(), "# HELP %79s", name), line.c_str());
+      TEST_ASSERT_TRUE_MESSAGE(line.size() > 8 + strlen(name), line.c_str()); // A text after the name
+      help = name;
+    } else if (line.compare(0, 7, "# TYPE ") == 0) {
+      TEST_ASSERT_EQUAL_MESSAGE(2, sscanf(line.c_str(), "# TYPE %79s %15s", name, kind), line.c_str());
+      TEST_ASSERT_EQUAL_STRING_MESSAGE(help.c_str(), name, line.c_str());
+      TEST_ASSERT_TRUE_MESSAGE(strcmp(kind, METRIC_GAUGE) == 0 || strcmp(kind, METRIC_COUNTER) == 0 ||
+                               strcmp(kind, "summary") == 0, line.c_str());
+      declared = name;
+      help.clear();
+      metrics++;
+    } else {
+      TEST_ASSERT_TRUE_MESSAGE(help.empty(), line.c_str()); // No HELP without TYPE
+      size_t      space  = line.rfind(' ');
+      std::string series = line.substr(0, space),
+                  metric = series.substr(0, series.find('{'));
+      TEST_ASSERT_TRUE_MESSAGE(space != std::string::npos && !declared.empty(), line.c_str());
+      TEST_ASSERT_TRUE_MESSAGE(metric == declared || metric == declared + "_sum" || metric == declared + "_count",
+                               line.c_str());
+      if (metric != series) TEST_ASSERT_EQUAL_MESSAGE('}', series[series.size() - 1], line.c_str());
+      char *end;
+      strtod(line.c_str() + space + 1, &end);
+      TEST_ASSERT_TRUE_MESSAGE(space + 1 < line.size() && *end == 0, line.c_str());
+      values++;
+    }
+  }
+  TEST_ASSERT_GREATER_OR_EQUAL(18, metrics); // Three more with SCREEN_STATS_ENABLED
+  TEST_ASSERT_GREATER_THAN(metrics, values);
+}
+
+void test_metrics_values() {
+  std::vector<std::string> lines = Lines(server.Native_Get("/metrics"));
+  double value;
+  TEST_ASSERT_TRUE(Value(lines, "roundmeter_uptime_seconds", &value));
+  TEST_ASSERT_UINT32_WITHIN(1, millis() / 1000, (uint32_t)value);
+  TEST_ASSERT_TRUE(Value(lines, "roundmeter_co2_ppm", &value));
+  TEST_ASSERT_EQUAL(native_sensor.ppm, (int)value);
+  TEST_ASSERT_TRUE(Value(lines, "roundmeter_http_status{feed=\"weather\"}", &value));
+  TEST_ASSERT_EQUAL(200, (int)value);
+  TEST_ASSERT_TRUE(Value(lines, "roundmeter_http_status{feed=\"rain\"}", &value));
+  TEST_ASSERT_EQUAL(200, (int)value);
+  TEST_ASSERT_TRUE(Value(lines, "roundmeter_fetches_total{feed=\"weather\",result=\"200\"}", &value));
+  TEST_ASSERT_GREATER_OR_EQUAL(1, (int)value);
+  TEST_ASSERT_TRUE(Value(lines, "roundmeter_fetches_total{feed=\"rain\",result=\"200\"}", &value));
+  TEST_ASSERT_GREATER_OR_EQUAL(1, (int)value);
+  TEST_ASSERT_TRUE(Value(lines, "roundmeter_co2_reads_total{result=\"1\"}", &value)); // MHZ19_RESULT_OK
+  TEST_ASSERT_GREATER_OR_EQUAL(1, (int)value);
+
+  std::string total = std::string("roundmeter_fetch_seconds{host=\"") + json_host + "\",phase=\"total\"}";
+  TEST_ASSERT_TRUE(Value(lines, total, &value));
+  TEST_ASSERT_GREATER_THAN(0, (int)(value * 1000)); // The server takes latency_ms to answer
+  total = std::string("roundmeter_fetch_seconds{host=\"") + rain_host + "\",phase=\"total\"}";
+  TEST_ASSERT_TRUE(Value(lines, total, &value));
+}
+
+void test_fetches() {
+  int code;
+  std::vector<std::string> lines = Lines(server.Native_Get("/fetches", &code));
+  TEST_ASSERT_EQUAL(200, code);
+  TEST_ASSERT_GREATER_OR_EQUAL(3, lines.size()); // Header, weather and rain
+  char columns[10][16];
+  TEST_ASSERT_EQUAL(10, sscanf(lines[0].c_str(), "%15s %15s %15s %15s %15s %15s %15s %15s %15s %15s",
+                               columns[0], columns[1], columns[2], columns[3], columns[4], columns[5],
+                               columns[6], columns[7], columns[8], columns[9]));
+  TEST_ASSERT_EQUAL_STRING("host", columns[0]);
+
+  bool weather = false, rain = false;
+  for (size_t i = 1; i < lines.size(); i++) {
+    char          host[32];
+    unsigned long age, bytes, dns, connect, ttfb, body, total;
+    int           status, retries;
+    TEST_ASSERT_EQUAL_MESSAGE(10, sscanf(lines[i].c_str(), "%31s %lu %d %d %lu %lu %lu %lu %lu %lu", host, &age,
+                                         &status, &retries, &bytes, &dns, &connect, &ttfb, &body, &total),
+                              lines[i].c_str());
+    TEST_ASSERT_LESS_OR_EQUAL_MESSAGE(total, dns + connect + ttfb + body, lines[i].c_str());
+    if (status != 200) continue;
+    TEST_ASSERT_GREATER_THAN_MESSAGE(0, bytes, lines[i].c_str());
+    if (strcmp(host, json_host) == 0) weather = true;
+    if (strcmp(host, rain_host) == 0) rain = true;
+  }
+  TEST_ASSERT_TRUE(weather);
+  TEST_ASSERT_TRUE(rain);
+}
+
+static char long_line[2 * METRICS_CHUNK_SIZE];
+
+static void Long_Lines() {
+  Metrics_Start(server);
+  for (int i = 0; i < 20; i++) Metrics_Line(PSTR("short %d\n"), i); // Partly fills the chunk
+  Metrics_Line(PSTR("%s\n"), long_line);
+  Metrics_End();
+}
+
+void test_long_lines() {
+/* *****************************************************************************
+   test_long_lines
+
+   A line longer than the old line buffer arrives whole, behind the lines
+   before it; only one longer than the chunk is cut, to the chunk
+ * *****************************************************************************/
+  server.on("/long", HTTP_GET, Long_Lines);
+  memset(long_line, 'x', 300);
+  long_line[300] = 0;
+  std::vector<std::string> lines = Lines(server.Native_Get("/long"));
+  TEST_ASSERT_EQUAL(21, lines.size());
+  TEST_ASSERT_EQUAL_STRING("short 19", lines[19].c_str());
+  TEST_ASSERT_EQUAL(300, lines[20].size());
+
+  memset(long_line, 'x', sizeof(long_line) - 1);
+  long_line[sizeof(long_line) - 1] = 0;
+  lines = Lines(server.Native_Get("/long"));
+  TEST_ASSERT_EQUAL(21, lines.size());
+  TEST_ASSERT_EQUAL(METRICS_CHUNK_SIZE - 1, lines[20].size()); // Without its newline
+}
+
+int main(int argc, char **argv) {
+  native_server.latency_ms = 20;
+  setup();
+  while (Task_Next(millis()) == 0) loop(); // The first fetches, sensor read and frame
+  uint32_t start = millis();
+  while ((uint32_t)(millis() - start) < 6000) { // A sensor read that picked up its reply
+    loop();
+    delay(10);
+  }
+  UNITY_BEGIN();
+  RUN_TEST(test_metrics_format);
+  RUN_TEST(test_metrics_values);
+  RUN_TEST(test_fetches);
+  RUN_TEST(test_long_lines);
+  return UNITY_END();
+}
@@ -0,0 +1,187 @@
+/* *****************************************************************************
+
+   Copyright (C) 2022 P.A.G.M. Zengers
+
+   The rain forecast: rain_table with the interpolation of mmHour against
+   the formula it replaced, 10^((value - 109) / 32) mm/hour, on the recorded
+   lines and on radar values with decimals; and Get_Rain skipping the lines
+   that are not a forecast. See include/RainTable.h and
+   tools/make_rain_table.py
+
+   This program is free software: you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation, either version 3 of the License, or
+   (at your option) any later version.
+
+ * ****************************************************************************/
+
+#include <Arduino.h>
+#include <unity.h>
+#include <math.h>
+#include <string>
+#include <sys/stat.h>
+#include <unistd.h>
+#include "RainTable.h"
+#include "Weather.h"
+#include "Native.h"
+
+#define REPLAY_MAGIC               0x524D5250 // As in Replay.h
+#define TEST_FS                    "/tmp/test_rain_XXXXXX"
+
+void setup();
+void Get_Rain();
+uint32_t mmHour(int radarvalue, int hundredths);
+bool Rain_Line(const char* line, uint32_t &rain, uint16_t &minutes);
+
+extern RainSnapshot  *rain_now;
+extern String         RAIN_etag, RAIN_lastModified;
+extern unsigned long  RAIN_count200;
+
+static uint32_t Formula(double value) {
+  return lround(pow(10, (value - 109) / 32.0) * RAIN_MILLI); // As the float version, in 1/1000 mm/hour
+}
+
+static void Check(const char *line, double value, uint16_t minutes) {
+/* *****************************************************************************
+   Check
+
+   Rain_Line against the formula: at most 1 off for the rounding and the
+   minimum of 1 in the table, and 0.1% for the interpolation between entries
+ * *****************************************************************************/
+  uint32_t rain = UINT32_MAX;
+  uint16_t time = UINT16_MAX;
+  char message[64];
+  snprintf(message, sizeof(message), "line \"%s\"", line);
+  TEST_ASSERT_TRUE_MESSAGE(Rain_Line(line, rain, time), message);
+  TEST_ASSERT_UINT32_WITHIN_MESSAGE(1 + Formula(value) / 1000, Formula(value), rain, message);
+  TEST_ASSERT_EQUAL_MESSAGE(minutes, time, message);
+}
+
+static std::string Body(const char *name) {
+  char path[256];
+  FILE *file = fopen(Native_Path(name, path, sizeof(path)), "rb");
+  if (!file) return "";
+  std::string recording;
+  char buffer[1024];
+  size_t length;
+  while ((length = fread(buffer, 1, sizeof(buffer), file)) > 0) recording.append(buffer, length);
+  fclose(file);
+  size_t start = recording.find("\r\n\r\n");
+  return start == std::string::npos ? "" : recording.substr(start + 4);
+}
+
+void setUp() {
+  native_server = Native_Server();
+  native_server.latency_ms = 0;
+  RAIN_etag = RAIN_lastModified = "";
+}
+
+void tearDown() {
+}
+
+void test_table() {
+  for (int value = 0; value < RAIN_TABLE_SIZE; value++) {
+    TEST_ASSERT_UINT32_WITHIN(1, Formula(value), mmHour(value, 0));
+  }
+  for (int value = 0; value < RAIN_TABLE_SIZE - 1; value++) {
+    for (int hundredths = 1; hundredths < 100; hundredths++) {
+      uint32_t expected = Formula(value + hundredths / 100.0);
+      TEST_ASSERT_UINT32_WITHIN(1 + expected / 1000, expected, mmHour(value, hundredths));
+    }
+  }
+}
+
+void test_recorded_lines() {
+  const char *recordings[] = { "/replay/gpsgadget.buienradar.nl.0", "/replay/gpsgadget.buienradar.nl.1" };
+  int lines = 0;
+  for (const char *name : recordings) {
+    std::string body = Body(name);
+    TEST_ASSERT_GREATER_THAN(0, body.size());
+    for (size_t start = 0; start < body.size();) {
+      size_t end = body.find('\n', start);
+      if (end == std::string::npos) end = body.size();
+      std::string line = body.substr(start, end - start);
+      start = end + 1;
+      if (!line.empty() && line.back() == '\r') line.pop_back();
+      if (line.empty()) continue;
+      int hours = 0, minutes = 0;
+      sscanf(line.c_str() + line.find('|') + 1, "%d:%d", &hours, &minutes);
+      Check(line.c_str(), atof(line.c_str()), hours * 60 + minutes);
+      lines++;
+    }
+  }
+  TEST_ASSERT_EQUAL(2 * RAIN_READINGS, lines);
+}
+
+void test_decimals() {
+  Check("077.5|20:10",  77.5,   20 * 60 + 10);
+  Check("110,25|20:15", 110.25, 20 * 60 + 15); // A comma as well
+  Check(" 45.01|20:20", 45.01,  20 * 60 + 20);
+  Check("121.99|21:00", 121.99, 21 * 60);
+  Check("254.99|21:05", 254.99, 21 * 60 + 5);
+  Check("0.5|00:05",    0.5,    5);
+  Check("092.123|08:30",92.12,  8 * 60 + 30);  // Hundredths only
+}
+
+void test_not_a_forecast() {
+  const char *lines[] = { "", "|20:10", "abc|20:10", "077", "077|", "077 20:10", "077x|20:10", "<html>" };
+  for (const char *line : lines) {
+    uint32_t rain = 12345;
+    uint16_t time = 678;
+    TEST_ASSERT_FALSE_MESSAGE(Rain_Line(line, rain, time), line);
+    TEST_ASSERT_EQUAL(12345, rain);
+    TEST_ASSERT_EQUAL(678, time);
+  }
+}
+
+void test_get_rain_skips_lines() {
+/* *****************************************************************************
+   test_get_rain_skips_lines
+
+   A forecast with lines in between that are not one, served from a LittleFS
+   of its own: only the forecasts count, none as dry at 00:00
+ * *****************************************************************************/
+  const char *response = "HTTP/1.1 200 OK\r\nContent-Type: text/plain\r\nConnection: close\r\n\r\n"
+                         "077|20:10\r\n<!-- cached -->\r\n092|20:15\r\n\r\n|20:20\r\n110|20:25\r\n";
+  char root[] = TEST_FS, path[256];
+  TEST_ASSERT_NOT_NULL(mkdtemp(root));
+  const char *fs = getenv("NATIVE_FS");
+  std::string previous = fs ? fs : "";
+  setenv("NATIVE_FS", root, 1);
+  snprintf(path, sizeof(path), "%s/replay", root);
+  mkdir(path, 0777);
+  snprintf(path, sizeof(path), "%s/replay/gpsgadget.buienradar.nl.0", root);
+  FILE *file = fopen(path, "wb");
+  uint32_t header[5] = { REPLAY_MAGIC, (uint32_t)strlen(response), 0, 0, 0 };
+  fwrite(header, 1, sizeof(header), file);
+  fwrite(response, 1, strlen(response), file);
+  fclose(file);
+
+  unsigned long count = RAIN_count200;
+  Get_Rain();
+  if (previous.empty()) unsetenv("NATIVE_FS");
+  else                  setenv("NATIVE_FS", previous.c_str(), 1);
+  remove(path);
+  snprintf(path, sizeof(path), "%s/replay", root);
+  rmdir(path);
+  rmdir(root);
+
+  TEST_ASSERT_EQUAL(count + 1, RAIN_count200);
+  TEST_ASSERT_EQUAL(3, rain_now->readings);
+  TEST_ASSERT_EQUAL(mmHour(77, 0),  rain_now->rain[0]);
+  TEST_ASSERT_EQUAL(mmHour(92, 0),  rain_now->rain[1]);
+  TEST_ASSERT_EQUAL(mmHour(110, 0), rain_now->rain[2]);
+  TEST_ASSERT_EQUAL(20 * 60 + 25,   rain_now->time[2]);
+  TEST_ASSERT_EQUAL(mmHour(110, 0), rain_now->max);
+}
+
+int main(int argc, char **argv) {
+  setup();
+  UNITY_BEGIN();
+  RUN_TEST(test_table);
+  RUN_TEST(test_recorded_lines);
+  RUN_TEST(test_decimals);
+  RUN_TEST(test_not_a_forecast);
+  RUN_TEST(test_get_rain_skips_lines);
+  return UNITY_END();
+}
@@ -0,0 +1,148 @@
+/* *****************************************************************************
+
+   Copyright (C) 2022 P.A.G.M. Zengers
+
+   The scheduler on a virtual clock across the wrap around of millis(), on
+   its own and with the firmware running in the native env. See Scheduler.h
+
+   This program is free software: you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation, either version 3 of the License, or
+   (at your option) any later version.
+
+ * ****************************************************************************/
+
+#include <Arduino.h>
+#include <unity.h>
+#include "Scheduler.h"
+#include "Native.h"
+
+#define WRAP                       0xFFFFFFFFUL // Last millis() before the wrap around
+
+void setup();
+void loop();
+
+extern int MHZ_Error;
+
+static uint32_t clock_now;               // The virtual clock of the scheduler tests
+static uint32_t runs, last_run, shortest, longest;
+static char     order[8];
+static uint8_t  order_length;
+
+static void Count() {
+  if (runs > 0) {
+    shortest = min(shortest, clock_now - last_run);
+    longest  = max(longest, clock_now - last_run);
+  }
+  last_run = clock_now;
+  runs++;
+}
+
+static void First()  { order[order_length++] = 'F'; }
+static void Second() { order[order_length++] = 'S'; }
+
+static void Run_Until(uint32_t end) {
+  for (; clock_now != end; clock_now++) {
+    while (Task_Run(clock_now)) {}
+  }
+}
+
+void setUp() {
+  runs = 0;
+  shortest = UINT32_MAX;
+  longest = 0;
+  order_length = 0;
+}
+
+void tearDown() {
+  for (int id = 0; id < TASK_MAX; id++) Task_Remove(id);
+}
+
+void test_periodic_across_wrap() {
+  clock_now = WRAP - 2500;
+  Task_Add(Count, 0, 1000, 0, clock_now);
+  Run_Until(clock_now + 10000); // Wraps on the way
+  TEST_ASSERT_EQUAL(10, runs);
+  TEST_ASSERT_EQUAL(1000, shortest);
+  TEST_ASSERT_EQUAL(1000, longest);
+}
+
+void test_once_across_wrap() {
+  clock_now = WRAP - 1000;
+  Task_Add(Count, 3000, TASK_ONCE, 0, clock_now);
+  Run_Until(WRAP);
+  TEST_ASSERT_EQUAL(0, runs); // Not early, as an unsigned compare would have it
+  Run_Until(1999);
+  TEST_ASSERT_EQUAL(0, runs);
+  Run_Until(2000);
+  TEST_ASSERT_EQUAL(1, runs);
+  TEST_ASSERT_EQUAL(1999, last_run);
+  Run_Until(10000);
+  TEST_ASSERT_EQUAL(1, runs);
+}
+
+void test_next_across_wrap() {
+  clock_now = WRAP - 100;
+  Task_Add(Count, 500, 500, 0, clock_now);
+  TEST_ASSERT_EQUAL(500, Task_Next(clock_now));
+  TEST_ASSERT_EQUAL(300, Task_Next(clock_now + 200)); // Past the wrap
+  TEST_ASSERT_EQUAL(0, Task_Next(clock_now + 500));
+  TEST_ASSERT_EQUAL(0, Task_Next(clock_now + 900));
+}
+
+void test_priority_then_overdue() {
+  clock_now = WRAP - 10;
+  Task_Add(Second, 0,  TASK_ONCE, 2, clock_now);
+  Task_Add(First,  5,  TASK_ONCE, 1, clock_now);
+  Task_Add(Second, 15, TASK_ONCE, 2, clock_now - 20); // Due before the first Second
+  Run_Until(clock_now + 5);
+  TEST_ASSERT_EQUAL(2, order_length);              // Both Seconds were due first
+  Run_Until(clock_now + 10);
+  TEST_ASSERT_EQUAL(3, order_length);
+  TEST_ASSERT_EQUAL('F', order[2]);
+}
+
+void test_no_catch_up() {
+  clock_now = WRAP - 3000;
+  Task_Add(Count, 0, 1000, 0, clock_now);
+  while (Task_Run(clock_now)) {}
+  clock_now += 5500; // Busy elsewhere for five periods, across the wrap
+  Run_Until(clock_now + 2000);
+  TEST_ASSERT_EQUAL(3, runs); // Once late, then in step again; no burst
+  TEST_ASSERT_EQUAL(1000, shortest);
+}
+
+void test_firmware_across_wrap() {
+/* *****************************************************************************
+   test_firmware_across_wrap
+
+   The firmware started a minute before the wrap: loop() keeps reading the
+   sensor every 5 s after it, and the fetches of setup() are not repeated
+   before their 5 and 10 minute periods
+ * *****************************************************************************/
+  Native_Clock_Set(WRAP - 60000);
+  setup();
+  while (Task_Next(millis()) == 0) loop(); // The first fetches, sensor and frame
+  uint32_t requests = native_server.requests;
+  native_sensor.commands = 0;
+  uint32_t start = millis();
+  while ((uint32_t)(millis() - start) < 90000 + 2500) {
+    loop();
+    delay(10);
+  }
+  TEST_ASSERT_TRUE(millis() < start); // Wrapped
+  TEST_ASSERT_EQUAL(90 / 5, native_sensor.commands);
+  TEST_ASSERT_EQUAL(requests, native_server.requests);
+  TEST_ASSERT_EQUAL(1, MHZ_Error); // MHZ19_RESULT_OK
+}
+
+int main(int argc, char **argv) {
+  UNITY_BEGIN();
+  RUN_TEST(test_periodic_across_wrap);
+  RUN_TEST(test_once_across_wrap);
+  RUN_TEST(test_next_across_wrap);
+  RUN_TEST(test_priority_then_overdue);
+  RUN_TEST(test_no_catch_up);
+  RUN_TEST(test_firmware_across_wrap); // Last, it leaves the tasks of setup()
+  return UNITY_END();
+}
@@ -0,0 +1,121 @@
+/* *****************************************************************************
+
+   Copyright (C) 2022 P.A.G.M. Zengers
+
+   Fast reconnect with the saved access point and addresses against the WiFi
+   of the native env: no password in the file, DHCP again after
+   WIFI_CACHE_MAX_STARTS and with WiFi_Renew. See WiFiCache.h and
+   lib/Native/user_interface.h
+
+   This program is free software: you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation, either version 3 of the License, or
+   (at your option) any later version.
+
+ * ****************************************************************************/
+
+#include <Arduino.h>
+#include <unity.h>
+#include <LittleFS.h>
+#include <ESP8266WiFi.h>
+#include <user_interface.h>
+#include <string>
+#include "WiFiCache.h"
+#include "Persist.h"
+#include "Native.h"
+
+#define PSK                        "not-in-the-cache"
+
+static void Connect_Normal() {
+  WiFi.begin(native_wifi.ssid, PSK); // As WiFiManager does; the SDK keeps both
+  while (WiFi.status() != WL_CONNECTED) delay(10);
+  WiFi_Remember();
+}
+
+void setUp() {
+  char path[256];
+  remove(Native_Path(NATIVE_SDK_FILE, path, sizeof(path)));
+  LittleFS.remove(WIFI_CACHE_FILE);
+  WiFi.disconnect();
+  WiFi.config(IPAddress(0u), IPAddress(0u), IPAddress(0u));
+}
+
+void tearDown() {
+}
+
+void test_nothing_saved() {
+  TEST_ASSERT_FALSE(WiFi_Fast_Connect(WIFI_FAST_TIMEOUT_MS));
+}
+
+void test_fast_connect() {
+  Connect_Normal();
+  WiFi.disconnect();
+  uint32_t start = millis();
+  TEST_ASSERT_TRUE(WiFi_Fast_Connect(WIFI_FAST_TIMEOUT_MS));
+  TEST_ASSERT_UINT32_WITHIN(20, native_wifi.fast_ms, millis() - start);
+  TEST_ASSERT_EQUAL_STRING(native_wifi.ssid, WiFi.SSID().c_str());
+  TEST_ASSERT_EQUAL_STRING(PSK, WiFi.psk().c_str()); // From the SDK
+  TEST_ASSERT_EQUAL_UINT32(IPAddress(192, 168, 1, 50), WiFi.localIP());
+}
+
+void test_no_password_in_file() {
+  Connect_Normal();
+  char path[256];
+  FILE *file = fopen(Native_Path(WIFI_CACHE_FILE, path, sizeof(path)), "rb");
+  TEST_ASSERT_NOT_NULL(file);
+  std::string saved;
+  for (int c; (c = fgetc(file)) != EOF;) saved += (char)c;
+  fclose(file);
+  TEST_ASSERT_TRUE(saved.find(PSK) == std::string::npos);
+  TEST_ASSERT_TRUE(saved.find(native_wifi.ssid) == std::string::npos);
+}
+
+void test_without_sdk_config() {
+  Connect_Normal();
+  WiFi.disconnect();
+  char path[256];
+  remove(Native_Path(NATIVE_SDK_FILE, path, sizeof(path)));
+  TEST_ASSERT_FALSE(WiFi_Fast_Connect(WIFI_FAST_TIMEOUT_MS));
+}
+
+void test_dhcp_again_after_max_starts() {
+  Connect_Normal();
+  for (int i = 0; i < WIFI_CACHE_MAX_STARTS; i++) {
+    WiFi.disconnect();
+    TEST_ASSERT_TRUE(WiFi_Fast_Connect(WIFI_FAST_TIMEOUT_MS));
+  }
+  WiFi.disconnect();
+  TEST_ASSERT_FALSE(WiFi_Fast_Connect(WIFI_FAST_TIMEOUT_MS));
+  Connect_Normal(); // The caller falls back to this, and saves afresh
+  WiFi.disconnect();
+  TEST_ASSERT_TRUE(WiFi_Fast_Connect(WIFI_FAST_TIMEOUT_MS));
+}
+
+void test_renew() {
+  Connect_Normal();
+  TEST_ASSERT_FALSE(WiFi_Renew()); // On DHCP already
+  for (int i = 0; i < WIFI_CACHE_MAX_STARTS - 1; i++) {
+    WiFi.disconnect();
+    TEST_ASSERT_TRUE(WiFi_Fast_Connect(WIFI_FAST_TIMEOUT_MS));
+  }
+  TEST_ASSERT_TRUE(WiFi_Renew());  // Back to DHCP, connected still
+  TEST_ASSERT_EQUAL(WL_CONNECTED, WiFi.status());
+  TEST_ASSERT_FALSE(WiFi_Renew()); // DHCP answered, saved
+  TEST_ASSERT_FALSE(WiFi_Renew()); // Nothing left to do
+  for (int i = 0; i < WIFI_CACHE_MAX_STARTS; i++) { // The count started again
+    WiFi.disconnect();
+    TEST_ASSERT_TRUE(WiFi_Fast_Connect(WIFI_FAST_TIMEOUT_MS));
+  }
+}
+
+int main(int argc, char **argv) {
+  Persist_Begin();
+  UNITY_BEGIN();
+  RUN_TEST(test_nothing_saved);
+  RUN_TEST(test_fast_connect);
+  RUN_TEST(test_no_password_in_file);
+  RUN_TEST(test_without_sdk_config);
+  RUN_TEST(test_dhcp_again_after_max_starts);
+  RUN_TEST(test_renew);
+  return UNITY_END();
+}
@@ -0,0 +1,89 @@
+#!/usr/bin/env python3
+"""
+Decodes a trace of the display bus written by LCDTrace.cpp, see LCDTrace.h,
+and reports what LCD_Trace_Report logs: redundant address windows, windows
+of a single pixel, pixels equal to the one before and idle gaps, then the
+commands by their data bytes. With --dump it lists every entry as well.
+
+    tools/lcd_trace.py data/trace/00.bin [--mhz 80] [--gap 20] [--dump]
+"""
+import argparse
+import struct
+
+ENTRY = struct.Struct("<IHBx")           # LCD_Trace_Entry
+COMMAND, BYTE, WORD = 0, 1, 2
+CASET, RASET, RAMWR = 0x2A, 0x2B, 0x2C
+KINDS = {COMMAND: "cmd", BYTE: "byte", WORD: "word"}
+
+
+def main():
+    parser = argparse.ArgumentParser(description="Decode a trace of the display bus")
+    parser.add_argument("file")
+    parser.add_argument("--mhz", type=int, default=80, help="CPU clock, the cycles per us")
+    parser.add_argument("--gap", type=int, default=20, help="us without a write that is an idle gap")
+    parser.add_argument("--dump", action="store_true", help="list every entry")
+    args = parser.parse_args()
+
+    with open(args.file, "rb") as f:
+        data = f.read()
+    entries = [ENTRY.unpack_from(data, offset) for offset in range(0, len(data) - ENTRY.size + 1, ENTRY.size)]
+    if not entries:
+        print("%s: empty" % args.file)
+        return
+
+    window = {CASET: None, RASET: None}
+    command, params = RAMWR, []
+    pixel = None
+    windows = redundant = single = pixels = repeated = 0
+    gaps, gap_total, gap_max = 0, 0, 0
+    opcodes = {}                         # Command: [count, data bytes]
+    previous = entries[0][0]
+
+    for cycles, value, kind in entries:
+        us = ((cycles - previous) & 0xFFFFFFFF) // args.mhz
+        previous = cycles
+        if us > args.gap:
+            gaps += 1
+            gap_total += us
+            gap_max = max(gap_max, us)
+        if args.dump:
+            print("%10d %-4s %04X%s" % (cycles, KINDS.get(kind, "?"), value, "  gap %d us" % us if us > args.gap else ""))
+
+        if kind == COMMAND:
+            command, params = value, []
+            opcodes.setdefault(value, [0, 0])[0] += 1
+            if command == RAMWR and window[CASET] and window[RASET] and \
+               window[CASET][0] == window[CASET][1] and window[RASET][0] == window[RASET][1]:
+                single += 1
+            continue
+        if command in opcodes:
+            opcodes[command][1] += 2 if kind == WORD else 1
+
+        if command in (CASET, RASET):
+            if len(params) >= 4:
+                continue
+            params += [value >> 8, value & 0xFF] if kind == WORD else [value & 0xFF]
+            if len(params) >= 4:
+                new = (params[0] << 8 | params[1], params[2] << 8 | params[3])
+                if command == CASET:
+                    windows += 1
+                if window[command] == new:
+                    redundant += 1
+                window[command] = new
+        elif command == RAMWR and kind == WORD:
+            pixels += 1
+            if value == pixel:
+                repeated += 1
+            pixel = value
+
+    span = ((entries[-1][0] - entries[0][0]) & 0xFFFFFFFF) // args.mhz
+    print("%s: %d writes in %d us" % (args.file, len(entries), span))
+    print("%d windows, %d address sets redundant, %d single pixel" % (windows, redundant, single))
+    print("%d pixels, %d same as the one before" % (pixels, repeated))
+    print("%d idle gaps over %d us, %d us in total, longest %d us" % (gaps, args.gap, gap_total, gap_max))
+    for opcode, (count, data_bytes) in sorted(opcodes.items(), key=lambda item: -item[1][1]):
+        print("command %02X %d times, %d data bytes" % (opcode, count, data_bytes))
+
+
+if __name__ == "__main__":
+    main()
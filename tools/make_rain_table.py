@@ -0,0 +1,53 @@
+#!/usr/bin/env python3
+"""
+Makes include/RainTable.h, the rain intensity per Buienradar radar value in
+1/1000 mm/hour: 10^((value - 109) / 32) mm/hour, rounded, at least 1 so the
+lowest radar values still show as a one pixel bar. test/test_rain checks the
+table, with the interpolation of mmHour in main.cpp, against the formula.
+"""
+import os
+
+SIZE = 256
+MILLI = 1000
+PER_LINE = 8
+PATH = os.path.join(os.path.dirname(os.path.abspath(__file__)), "..", "include", "RainTable.h")
+
+HEADER = """/*
+ * Rain intensity per Buienradar radar value, in 1/1000 mm/hour.
+ * Buienradar uses a logarithmic scale: mm/hour = 10^((value - 109) / 32)
+ * (example: 77 = 0.1 mm/hour). Generated once, so we need no float math
+ * at runtime. Values are rounded, with a minimum of 1 so that even the lowest
+ * radar values still show as a one pixel bar, like the float version did.
+ */
+#ifndef RAINTABLE_H
+#define RAINTABLE_H
+
+#ifdef ESP8266
+  #include <pgmspace.h>
+#else
+  #include <avr/pgmspace.h>
+#endif
+
+#define RAIN_TABLE_SIZE            %d
+#define RAIN_MILLI                 %d  // Table unit is 1/1000 mm/hour
+
+const uint32_t rain_table[RAIN_TABLE_SIZE] PROGMEM={
+"""
+
+
+def rain(value):
+    return max(1, round(10 ** ((value - 109) / 32) * MILLI))
+
+
+def main():
+    lines = [HEADER % (SIZE, MILLI)]
+    for start in range(0, SIZE, PER_LINE):
+        values = ",".join("%10d" % rain(value) for value in range(start, start + PER_LINE))
+        lines.append(" %s,   // %3d..%3d\n" % (values, start, start + PER_LINE - 1))
+    lines.append("};\n\n#endif\n")
+    with open(PATH, "w") as file:
+        file.write("".join(lines))
+
+
+if __name__ == "__main__":
+    main()
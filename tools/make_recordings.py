@@ -0,0 +1,95 @@
+#!/usr/bin/env python3
+"""
+Makes the recordings in data/replay, for the replay (see Replay.h) and the
+stand-in server of the native env (see lib/Native/Native.h).
+
+They are synthetic: the responses have the shape of those of Buienradar,
+the weather feed with the fields the firmware reads for 40 stations and a
+forecast text, the rain forecast with 24 lines of five minutes. Values and
+times are made up, and so are the timings in the headers of the files.
+
+data.buienradar.nl.0 is the feed as is, .1 the same with gzip;
+gpsgadget.buienradar.nl.0 and .1 are a dry and a wet forecast.
+"""
+import gzip
+import os
+import struct
+
+MAGIC = 0x524D5250                      # Replay_Header.magic
+DIR = os.path.join(os.path.dirname(os.path.abspath(__file__)), "..", "data", "replay")
+DATE = "Thu, 20 Jan 2022 12:58:03 GMT"
+
+
+def station(number, id, name, description, icon, temperature):
+    return ('{"stationid":%d,"stationname":"Meetstation %s","lat":%.2f,"lon":%.2f,"regio":"%s",'
+            '"timestamp":"2022-01-20T12:50:00","weatherdescription":"%s",'
+            '"iconurl":"https://www.buienradar.nl/resources/images/icons/weather/30x30/%s.png",'
+            '"graphUrl":"https://www.buienradar.nl/nederland/weerbericht/weergrafieken/%s",'
+            '"winddirection":"%s","temperature":%.1f,"groundtemperature":%.1f,"feeltemperature":%.1f,'
+            '"windgusts":%.1f,"windspeed":%.1f,"windspeedBft":%d,"humidity":%.1f,"precipitation":%.1f,'
+            '"sunpower":%.1f,"rainFallLast24Hour":%.1f,"rainFallLastHour":%.1f,"winddirectiondegrees":%d,'
+            '"airpressure":%.1f,"visibility":%.1f}'
+            % (id, name, 50.8 + number * 0.06, 3.4 + number * 0.07, name, description, icon, icon,
+               "WZW" if number % 3 else "ZW", temperature, temperature - 1.2, temperature - 2.5,
+               8.0 + number % 7, 4.2 + number % 5, 3 + number % 3, 78.0 + number % 15, 0.0 if number % 4 else 0.4,
+               120.0 + number * 3, 1.8 + number % 6 * 0.3, 0.0 if number % 4 else 0.2, 230 + number % 40,
+               1013.2 - number % 5 * 0.4, 21000.0 + number * 500))
+
+
+def weather():
+    names = ["Arcen", "Arnhem", "Berkhout", "Cadzand", "De Bilt", "Den Helder", "Eindhoven", "Ell",
+             "Euro platform", "Gilze Rijen", "Goes", "Groningen", "Hansweert", "Heino", "Herwijnen",
+             "Hoek van Holland", "Hoogeveen", "Hoorn Terschelling", "Houtribdijk", "Huibertgat", "IJmond",
+             "IJmuiden", "Lauwersoog", "Leeuwarden", "Lelystad", "Lichteiland Goeree", "Maastricht",
+             "Marknesse", "Nieuw Beerta", "Oosterschelde", "Rotterdam", "Schiphol", "Stavenisse",
+             "Stavoren", "Texelhors", "Twente", "Vlieland", "Vlissingen", "Volkel", "Wijdenes"]
+    stations = []
+    for number, name in enumerate(names):
+        id = 6260 if name == "De Bilt" else 6200 + number * 3
+        icon, description = ("c", "Zwaar bewolkt") if number % 3 else ("b", "Mix van opklaringen en hoge bewolking")
+        stations.append(station(number, id, name, description, icon, 5.5 + number % 9 * 0.4))
+    forecast = ("Vandaag is het grotendeels bewolkt en droog. Later op de dag breekt de zon soms door. "
+                "Het wordt 5 tot 8 graden. De wind is matig uit zuidwest. Morgen eerst zon, daarna meer wolken "
+                "en in de loop van de middag in het noorden een paar buien. Zaterdag kouder met kans op hagel.")
+    days = ",".join('{"day":"2022-01-%02dT00:00:00","mintemperature":"%d","maxtemperature":"%d",'
+                    '"mintemperatureMax":%d,"mintemperatureMin":%d,"maxtemperatureMax":%d,"maxtemperatureMin":%d,'
+                    '"rainChance":%d,"sunChance":%d,"windDirection":"zw","wind":%d,"mmRainMin":0.0,"mmRainMax":%.1f,'
+                    '"weatherdescription":"Half bewolkt","iconurl":"https://www.buienradar.nl/resources/images/icons/weather/96x96/b.png"}'
+                    % (21 + i, 1 + i, 6 + i, 2 + i, i, 7 + i, 5 + i, 20 + i * 10, 40 - i * 5, 3 + i % 2, i * 1.5)
+                    for i in range(5))
+    return ('{"$id":"1","buienradar":{"copyright":"(C)opyright Buienradar / RTL. Alle rechten voorbehouden",'
+            '"terms":"Deze feed mag vrij worden gebruikt onder voorwaarde van bronvermelding buienradar.nl"},'
+            '"actual":{"actualradarurl":"https://api.buienradar.nl/image/1.0/RadarMapNL?w=500&h=512",'
+            '"sunrise":"2022-01-20T08:38:00","sunset":"2022-01-20T17:04:00",'
+            '"stationmeasurements":[' + ",".join(stations) + ']},'
+            '"forecast":{"weatherreport":{"published":"2022-01-20T11:45:00","title":"Grijs en droog",'
+            '"author":"Buienradar","text":"' + forecast + '"},"fivedayforecast":[' + days + ']}}')
+
+
+def rain(wet):
+    lines = []
+    for i in range(24):
+        minutes = 20 * 60 + 10 + i * 5
+        value = 0 if not wet else [0, 0, 45, 77, 92, 110, 121, 97, 77, 60, 45, 0][i % 12]
+        lines.append("%03d|%02d:%02d" % (value, minutes // 60 % 24, minutes % 60))
+    return "\r\n".join(lines) + "\r\n"
+
+
+def save(name, headers, body, ttfb, duration, received):
+    response = ("HTTP/1.1 200 OK\r\n" + "".join("%s: %s\r\n" % header for header in headers) +
+                "Content-Length: %d\r\nConnection: close\r\n\r\n" % len(body)).encode() + body
+    with open(os.path.join(DIR, name), "wb") as file:
+        file.write(struct.pack("<5I", MAGIC, len(response), received, ttfb, duration))
+        file.write(response)
+
+
+os.makedirs(DIR, exist_ok=True)
+feed = weather().encode()
+common = [("Date", DATE), ("Content-Type", "application/json; charset=utf-8"),
+          ("Last-Modified", "Thu, 20 Jan 2022 12:55:00 GMT"), ("Vary", "Accept-Encoding")]
+save("data.buienradar.nl.0", common + [("ETag", '"feed-1255"')], feed, 160, 2400, 7700)
+save("data.buienradar.nl.1", common + [("ETag", '"feed-1255-gzip"'), ("Content-Encoding", "gzip")],
+     gzip.compress(feed, 9, mtime=0), 160, 420, 8300)
+common = [("Date", DATE), ("Content-Type", "text/plain"), ("Last-Modified", "Thu, 20 Jan 2022 12:55:00 GMT")]
+save("gpsgadget.buienradar.nl.0", common + [("ETag", '"rain-dry"')], rain(False).encode(), 120, 140, 9100)
+save("gpsgadget.buienradar.nl.1", common + [("ETag", '"rain-wet"')], rain(True).encode(), 120, 140, 9900)